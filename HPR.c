@@ -2,9 +2,19 @@
 // Autor: Paulo Ricardo Oliveira dos Santos Junior
 // DescriÃ§Ã£o:
 //   - Emula um dispositivo USB HID (mouse) utilizando o joystick para movimentar o cursor.
-//   - O botÃ£o do joystick executa cliques: curto (<1s) = clique esquerdo; longo (>=1s) = clique direito.
+//   - O botÃ£o do joystick executa cliques: curto (<1s) = clique esquerdo; dois curtos = duplo clique; longo (>=1s) = clique direito.
 //   - BotÃ£o A (GPIO 5): Exibe "Transcrevendo tela" e toca som (tom de voz simulado) no buzzer (GPIO 12) por 5s.
-//   - BotÃ£o B (GPIO 6): LÃª o microfone (ADC canal 2 â€“ GP28); se o nÃ­vel for maior que 2048 exibe "Ouvindo", senÃ£o "Pronto pra ouvir".
+//   - BotÃ£o B (GPIO 6): LÃª o microfone (ADC canal 2 â€“ GP28); exibe "Ouvindo" enquanto o VAD detectar voz, senÃ£o "Pronto pra ouvir".
+//   - Botoes A+B juntos: o joystick passa a rolar a tela (roda vertical e horizontal).
+//   - USB composto: mouse, teclado (atalhos dos botoes A e B no computador) e porta serial de controle.
+//   - O microfone tambem aparece no computador como dispositivo de audio USB, a 16 kHz (microfone_usb.c).
+//   - Zona morta, curva do joystick, toque longo e VAD ajustaveis pela porta serial e guardados na flash (config.c).
+//   - Sem uso, o display escurece e depois desliga, e a amostragem e o relogio baixam (energia.c).
+//   - LED RGB (vermelho GPIO 13, verde GPIO 11): estado do USB/joystick, microfone e erros, piscados pelo PIO (led.c).
+//   - O I2C do display passa por uma fila por DMA com prazo e recuperacao do barramento (i2c_fila.c).
+//   - Variantes de build: caminho quente na SRAM (HPR_RAM_QUENTE, quente.h) e falhas do cache XIP nas sondas (HPR_PERFIL_XIP, perfil.h).
+//   - Sessoes de uso gravadas num traco na RAM, reproduzidas pelo mesmo processamento e despejadas pela serial (traco.c).
+//   - Entrada do nucleo 1 e eventos no display montados igual no firmware e no build de host (entrada.c, painel.c).
 //   - O display OLED (SSD1306 via I2C, pinos 14/15) exibe "Em uso" quando o joystick estiver ativo e "Aguardando" caso contrÃ¡rio.
 
 #include <stdio.h>
@@ -12,12 +22,30 @@
 #include <string.h>
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
-#include "hardware/adc.h"
 #include "hardware/i2c.h"
 #include "hardware/pwm.h"
 #include "hardware/timer.h"
 #include "pico/time.h"
+#include "pico/multicore.h"
+#include "pico/flash.h"
 #include "tusb.h"  // TinyUSB para USB HID
+#include "scheduler.h"
+#include "i2c_fila.h"
+#include "ssd1306.h"
+#include "hid_mouse.h"
+#include "hid_teclado.h"
+#include "cdc_controle.h"
+#include "audio.h"
+#include "ui.h"
+#include "perfil.h"
+#include "config.h"
+#include "protocolo.h"
+#include "energia.h"
+#include "led.h"
+#include "traco.h"
+#include "microfone_usb.h"
+#include "entrada.h"
+#include "painel.h"
 
 // =====================
 // DefiniÃ§Ãµes de Pinos e ParÃ¢metros
@@ -36,327 +64,426 @@
 // BotÃ£o do joystick
 #define JOY_BUTTON_PIN      22
 
-// Joystick ADC (movimento)
-#define JOY_X_ADC_CHANNEL   0   // GP26
-#define JOY_Y_ADC_CHANNEL   1   // GP27
-
-// Microfone ADC (para leitura de Ã¡udio)
-#define MIC_ADC_CHANNEL     2   // GP28
-
 // Buzzer (usando PWM)
 #define BUZZER_PIN          12
 
-// Display OLED: dimensÃµes
-#define SSD1306_WIDTH       128
-#define SSD1306_HEIGHT      64
-#define SSD1306_BUFFER_SIZE (SSD1306_WIDTH * SSD1306_HEIGHT / 8)
+// LED RGB da BitDogLab; o azul (GPIO 12) divide o pino com o buzzer e fica
+// sem uso
+#define LED_VERMELHO_PIN    13
+#define LED_VERDE_PIN       11
+
+// Relatorio de perfil pela UART: periodo da tarefa (us) e do texto
+// periodico (ms; 0 = so sob demanda)
+#define PERIODO_RELATORIO_US 10000
+#define RELATORIO_PERIODO_MS 10000
 
 // =====================
-// FunÃ§Ãµes para o Display OLED (ImplementaÃ§Ã£o bÃ¡sica do SSD1306 via I2C)
+// Buzzer via PWM
 // =====================
-
-uint8_t ssd1306_buffer[SSD1306_BUFFER_SIZE];
-
-#define FONT_WIDTH  5
-#define FONT_HEIGHT 7
-#define CHAR_SPACING 1
-
-// Para simplificaÃ§Ã£o, uma tabela mÃ­nima de fonte (apenas espaÃ§o e "!" definidos; expanda conforme necessÃ¡rio)
-const uint8_t font5x7[][5] = {
-    {0x00,0x00,0x00,0x00,0x00}, // ' ' (32)
-    {0x00,0x00,0x5F,0x00,0x00}, // '!' (33)
-    // ... adicione mais caracteres conforme necessÃ¡rio
-};
-
-void ssd1306_command(uint8_t cmd) {
-    uint8_t buf[2] = {0x00, cmd};
-    i2c_write_blocking(I2C_PORT, SSD1306_ADDR, buf, 2, false);
-}
-
-void ssd1306_init(void) {
-    sleep_ms(100);
-    ssd1306_command(0xAE); // Display off
-    ssd1306_command(0x20); // Set Memory Addressing Mode
-    ssd1306_command(0x00); // Horizontal addressing
-    ssd1306_command(0xB0); // Page start address
-    ssd1306_command(0xC8); // COM output scan direction remapped
-    ssd1306_command(0x00); // Low column address
-    ssd1306_command(0x10); // High column address
-    ssd1306_command(0x40); // Start line address
-    ssd1306_command(0x81); // Set contrast
-    ssd1306_command(0xFF);
-    ssd1306_command(0xA1); // Segment re-map
-    ssd1306_command(0xA6); // Normal display
-    ssd1306_command(0xA8); // Multiplex ratio
-    ssd1306_command(0x3F);
-    ssd1306_command(0xA4); // Output follows RAM content
-    ssd1306_command(0xD3); // Display offset
-    ssd1306_command(0x00);
-    ssd1306_command(0xD5); // Display clock divide ratio/oscillator frequency
-    ssd1306_command(0xF0);
-    ssd1306_command(0xD9); // Pre-charge period
-    ssd1306_command(0x22);
-    ssd1306_command(0xDA); // COM pins hardware configuration
-    ssd1306_command(0x12);
-    ssd1306_command(0xDB); // VCOMH deselect level
-    ssd1306_command(0x20);
-    ssd1306_command(0x8D); // Charge pump
-    ssd1306_command(0x14);
-    ssd1306_command(0xAF); // Display ON
-
-    memset(ssd1306_buffer, 0, SSD1306_BUFFER_SIZE);
-    // Atualiza display para mostrar tela limpa
-    ssd1306_command(0x21); // Column address
-    ssd1306_command(0); 
-    ssd1306_command(SSD1306_WIDTH - 1);
-    ssd1306_command(0x22); // Page address
-    ssd1306_command(0);
-    ssd1306_command((SSD1306_HEIGHT/8) - 1);
+// Executa som "tom de voz" â€“ varia a frequÃªncia levemente â€“ por 5 segundos
+// 100 ms ligado / 50 ms desligado. O som toca em segundo plano pelo motor de
+// audio (audio.c); aqui so se monta a sequencia de notas.
+#define BUZZER_VOZ_DURACAO_US  5000000UL
+#define BUZZER_VOZ_LIGADO_MS   100
+#define BUZZER_VOZ_DESLIGADO_MS 50
+#define BUZZER_VOZ_VOLUME      AUDIO_VOLUME_MAX
+#define BUZZER_VOZ_PULSOS      ((BUZZER_VOZ_DURACAO_US / 1000 + BUZZER_VOZ_LIGADO_MS + BUZZER_VOZ_DESLIGADO_MS - 1) / \
+                                (BUZZER_VOZ_LIGADO_MS + BUZZER_VOZ_DESLIGADO_MS))
+
+_Static_assert(2 * BUZZER_VOZ_PULSOS <= AUDIO_MAX_NOTAS, "som de voz maior que um som do motor de audio");
+_Static_assert(BUZZER_VOZ_DURACAO_US / 1000 == PAINEL_TRANSCREVER_MS, "mensagem do botao A dura o som");
+
+#define BUZZER_VOZ_FREQ_MIN    680
+#define BUZZER_VOZ_FREQ_FAIXA  41     // 680 a 720 Hz
+
+static audio_nota_t buzzer_voz_notas[2 * BUZZER_VOZ_PULSOS];
+static audio_som_t buzzer_voz = { .notas = buzzer_voz_notas };
+static afinacao_pwm_t buzzer_voz_tons[BUZZER_VOZ_FREQ_FAIXA];
+
+// Afina as frequencias do som de voz uma vez, no boot
+void preparar_som_buzzer(void) {
+    for (int i = 0; i < BUZZER_VOZ_FREQ_FAIXA; i++)
+        buzzer_voz_tons[i] = afinacao_hz(BUZZER_VOZ_FREQ_MIN + i);
 }
 
-void ssd1306_update(void) {
-    ssd1306_command(0x21);
-    ssd1306_command(0); 
-    ssd1306_command(SSD1306_WIDTH - 1);
-    ssd1306_command(0x22);
-    ssd1306_command(0);
-    ssd1306_command((SSD1306_HEIGHT/8) - 1);
-
-    const int CHUNK_SIZE = 16;
-    for (int i = 0; i < SSD1306_BUFFER_SIZE; i += CHUNK_SIZE) {
-        uint8_t data[CHUNK_SIZE + 1];
-        data[0] = 0x40;
-        int chunk = CHUNK_SIZE;
-        if (i + chunk > SSD1306_BUFFER_SIZE)
-            chunk = SSD1306_BUFFER_SIZE - i;
-        memcpy(&data[1], &ssd1306_buffer[i], chunk);
-        i2c_write_blocking(I2C_PORT, SSD1306_ADDR, data, chunk + 1, false);
+void iniciar_som_buzzer_5s() {
+    uint16_t n = 0;
+    uint32_t restante_ms = BUZZER_VOZ_DURACAO_US / 1000;
+    while (restante_ms > 0 && n + 2u <= 2 * BUZZER_VOZ_PULSOS) {
+        uint16_t ligado = restante_ms < BUZZER_VOZ_LIGADO_MS ? restante_ms : BUZZER_VOZ_LIGADO_MS;
+        // FrequÃªncia variando para simular um tom de voz: entre 680 e 720 Hz
+        buzzer_voz_notas[n++] = (audio_nota_t){ buzzer_voz_tons[rand() % BUZZER_VOZ_FREQ_FAIXA], ligado, BUZZER_VOZ_VOLUME };
+        restante_ms -= ligado;
+        uint16_t desligado = restante_ms < BUZZER_VOZ_DESLIGADO_MS ? restante_ms : BUZZER_VOZ_DESLIGADO_MS;
+        buzzer_voz_notas[n++] = (audio_nota_t){ AFINACAO_PAUSA, desligado, 0 };
+        restante_ms -= desligado;
     }
+    buzzer_voz.n_notas = n;
+    // Reinicia se ja estiver tocando, como antes
+    audio_parar();
+    audio_tocar(&buzzer_voz);
 }
 
-void ssd1306_clear(void) {
-    memset(ssd1306_buffer, 0, SSD1306_BUFFER_SIZE);
-}
+// =====================
+// Indicadores no LED RGB (nucleo 0)
+// =====================
+// Verde: USB e joystick. Vermelho: voz no microfone e erros (I2C do display
+// ou entrada HID perdida), que piscam em rajada por INDICADOR_ERRO_MS. Os
+// estados vem dos mesmos eventos do display; cada mudanca e uma palavra na
+// FIFO do PIO (led.c).
+#define INDICADOR_DESCONECTADO  LED_PADRAO(100, 900, 1, 0)    // 1 Hz
+#define INDICADOR_PARADO        LED_PADRAO(1, 9, 1, 0)        // meia luz (10% a 100 Hz)
+#define INDICADOR_EM_USO        LED_ACESO
+#define INDICADOR_REPOUSO       LED_PADRAO(20, 1, 1, 30)      // lampejo a cada ~3 s
+#define INDICADOR_ERRO          LED_PADRAO(80, 120, 3, 10)    // 3 pulsos a cada ~1,6 s
+#define INDICADOR_VOZ           LED_ACESO
+#define INDICADOR_ERRO_MS       2000
+
+static struct {
+    evento_t usb;
+    bool em_uso;
+    bool voz;
+    bool ocioso;
+    uint32_t erros;             // soma dos contadores de erro ja vistos
+    absolute_time_t erro_fim;
+} indicador = { .usb = EVENTO_USB_DESCONECTADO };
+
+static void indicadores_atualizar(void) {
+    ssd1306_stats_t oled;
+    hid_mouse_stats_t hid;
+    hid_teclado_stats_t teclado;
+    ssd1306_get_stats(&oled);
+    hid_mouse_get_stats(&hid);
+    hid_teclado_get_stats(&teclado);
+    uint32_t erros = oled.erros_i2c + hid.botoes_perdidos + teclado.descartados;
+    if (erros != indicador.erros) {
+        indicador.erros = erros;
+        indicador.erro_fim = make_timeout_time_ms(INDICADOR_ERRO_MS);
+    }
 
-void ssd1306_set_pixel(int x, int y, bool on) {
-    if (x < 0 || x >= SSD1306_WIDTH || y < 0 || y >= SSD1306_HEIGHT)
-        return;
-    int page = y / 8;
-    int index = x + page * SSD1306_WIDTH;
-    uint8_t mask = 1 << (y % 8);
-    if (on)
-        ssd1306_buffer[index] |= mask;
+    uint32_t verde;
+    if (indicador.usb == EVENTO_USB_DESCONECTADO)
+        verde = INDICADOR_DESCONECTADO;
+    else if (indicador.usb == EVENTO_USB_SUSPENSO || indicador.ocioso)
+        verde = INDICADOR_REPOUSO;
     else
-        ssd1306_buffer[index] &= ~mask;
+        verde = indicador.em_uso ? INDICADOR_EM_USO : INDICADOR_PARADO;
+    led_padrao(LED_VERDE, verde);
+
+    uint32_t vermelho = LED_APAGADO;
+    if (!time_reached(indicador.erro_fim))
+        vermelho = INDICADOR_ERRO;
+    else if (indicador.voz && !indicador.ocioso)
+        vermelho = INDICADOR_VOZ;
+    led_padrao(LED_VERMELHO, vermelho);
 }
 
-void ssd1306_draw_char(char c, int x, int y) {
-    if (c < 32 || c > 127) return;
-    int index = c - 32;
-    for (int col = 0; col < FONT_WIDTH; col++) {
-        uint8_t line = font5x7[index][col];
-        for (int row = 0; row < FONT_HEIGHT; row++) {
-            if (line & (1 << row))
-                ssd1306_set_pixel(x + col, y + row, true);
+// Nucleo 0: aplica os eventos pendentes ao display (painel.c), ao LED e ao
+// buzzer. O LED conta o tempo pelo clk_sys, que o nucleo 1 divide em
+// OCIOSO: o divisor das maquinas acompanha cada troca.
+static scheduler_t scheduler_nucleo0;
+
+void eventos_tarefa(void) {
+    evento_t evento;
+    while (entrada_ler_evento(&evento)) {
+        painel_evento(evento);
+        switch (evento) {
+        case EVENTO_STATUS_EM_USO:
+        case EVENTO_STATUS_AGUARDANDO:
+            indicador.em_uso = evento == EVENTO_STATUS_EM_USO;
+            break;
+        case EVENTO_TRANSCREVER:
+            iniciar_som_buzzer_5s();
+            break;
+        case EVENTO_MIC_VOZ:
+        case EVENTO_MIC_SILENCIO:
+            indicador.voz = evento == EVENTO_MIC_VOZ;
+            break;
+        case EVENTO_USB_CONECTADO:
+        case EVENTO_USB_DESCONECTADO:
+        case EVENTO_USB_SUSPENSO:
+            indicador.usb = evento;
+            break;
+        case EVENTO_ENERGIA_ATIVO:
+        case EVENTO_ENERGIA_ESCURO:
+        case EVENTO_ENERGIA_OCIOSO:
+            if ((evento == EVENTO_ENERGIA_OCIOSO) != indicador.ocioso) {
+                indicador.ocioso = !indicador.ocioso;
+                led_ajustar_relogio();
+            }
+            break;
+        default:
+            break;
         }
     }
-    // EspaÃ§o extra entre caracteres
-    for (int row = 0; row < FONT_HEIGHT; row++) {
-        ssd1306_set_pixel(x + FONT_WIDTH, y + row, false);
-    }
-}
-
-void ssd1306_draw_string(const char *str, int x, int y) {
-    while (*str) {
-        ssd1306_draw_char(*str, x, y);
-        x += FONT_WIDTH + CHAR_SPACING;
-        str++;
-    }
-    ssd1306_update();
+    indicadores_atualizar();
 }
 
 // =====================
-// USB HID (Mouse) via TinyUSB
+// Traco de entrada (entrada.h)
 // =====================
-void enviar_mouse_report(uint8_t buttons, int8_t dx, int8_t dy, int8_t wheel) {
-    if (tud_hid_ready()) {
-        tud_hid_mouse_report(0, buttons, dx, dy, wheel);
-    }
-}
+// Gravado e reproduzido pelo nucleo 1, despejado pelo relatorio. Aqui as
+// entradas reproduzidas entram com a resolucao da tarefa USB (1 ms); a
+// reproducao exata, em tempo virtual, e a do build de host (host/roteiro.c).
+#define TRACO_GRAVACAO_BYTES 32768  // potencia de 2; ~6 s de joystick em movimento
+#define TRACO_SAIDA_BYTES    8192
+
+static uint8_t traco_gravacao_buf[TRACO_GRAVACAO_BYTES];
+static uint8_t traco_saida_buf[TRACO_SAIDA_BYTES];
+static traco_t traco_gravacao, traco_saida;
 
 // =====================
-// Buzzer via PWM
+// Relatorio de perfil e contadores pela stdio (UART e CDC)
 // =====================
-static uint slice_num;
-
-void buzzer_init() {
-    gpio_set_function(BUZZER_PIN, GPIO_FUNC_PWM);
-    slice_num = pwm_gpio_to_slice_num(BUZZER_PIN);
-    pwm_set_wrap(slice_num, 2500);  // Define wrap para o cÃ¡lculo da frequÃªncia (base: 125MHz)
-    pwm_set_chan_level(slice_num, PWM_CHAN_A, 0);
-    pwm_set_enabled(slice_num, true);
-}
-
-void buzzer_set_frequency(uint32_t freq) {
-    float divider = (float)125000000 / (2500 * freq);
-    pwm_set_clkdiv(slice_num, divider);
+// Sai pela UART e pela porta serial USB (cdc_controle.c).
+// Sob demanda, por um caractere recebido: 'p' = texto, 'b' = binario,
+// 'z' = zera os histogramas, 'd' e 'e' = despejo do traco gravado e da
+// saida da ultima reproducao. O texto tambem sai a cada RELATORIO_PERIODO_MS.
+// Cada passo da tarefa escreve uma linha (ou um registro binario) para nao
+// segurar o nucleo 0 enquanto a UART esvazia.
+//
+// Registros binarios em quadros de protocolo.h. Tipo 1 = sonda
+// (perfil_serializar()); tipo 2 = contadores, u32 LE na ordem de
+// relatorio_contadores(); tipos 3 e 4 = pedacos da serializacao do traco
+// gravado e da saida (traco.h), encerrada por um quadro vazio. Os quadros
+// recebidos sao comandos de config.h.
+#define RELATORIO_TIPO_SONDA     1
+#define RELATORIO_TIPO_CONTADORES 2
+#define RELATORIO_TIPO_TRACO     3
+#define RELATORIO_TIPO_TRACO_SAIDA 4
+#define RELATORIO_N_CONTADORES   30
+#define RELATORIO_TRACO_BYTES    128    // bytes do traco por quadro
+
+typedef enum { RELATORIO_PARADO, RELATORIO_TEXTO, RELATORIO_BINARIO, RELATORIO_TRACO } relatorio_modo_t;
+
+static relatorio_modo_t relatorio_modo = RELATORIO_PARADO;
+static uint8_t relatorio_passo;
+static absolute_time_t relatorio_proximo;
+static const traco_t *relatorio_traco;      // traco despejado em RELATORIO_TRACO
+static uint8_t relatorio_traco_tipo;
+static uint32_t relatorio_traco_offset;
+
+// Os contadores do nucleo 1 sao lidos daqui sem trava: uma copia pode
+// misturar valores de instantes proximos, o que nao importa para estatistica
+static void relatorio_contadores(uint32_t c[RELATORIO_N_CONTADORES]) {
+    hid_mouse_stats_t hid;
+    hid_teclado_stats_t teclado;
+    cdc_controle_stats_t cdc;
+    ssd1306_stats_t oled;
+    ui_stats_t ui;
+    microfone_usb_stats_t mic;
+    i2c_fila_stats_t i2c;
+    const energia_stats_t *en = &entrada_energia()->stats;
+    hid_mouse_get_stats(&hid);
+    hid_teclado_get_stats(&teclado);
+    cdc_controle_get_stats(&cdc);
+    ssd1306_get_stats(&oled);
+    ui_get_stats(&ui);
+    microfone_usb_get_stats(&mic);
+    i2c_fila_get_stats(&i2c);
+    uint32_t v[RELATORIO_N_CONTADORES] = {
+        hid.relatorios, hid.endpoint_ocupado, hid.falhas_envio, hid.botoes_perdidos,
+        hid.latencia_max_us,
+        oled.quadros_enviados, oled.quadros_ignorados, oled.bytes_enviados, oled.erros_i2c,
+        ui.quadros, ui.adiados,
+        teclado.relatorios, teclado.descartados, cdc.bytes_enviados, cdc.bytes_perdidos,
+        entrada_energia_nivel(), en->despertares, en->latencia_max_us, en->acima_limite, en->descartadas,
+        mic.pacotes, mic.subfluxos, mic.perdidas, mic.nivel_min, mic.nivel_max, mic.intervalo_max_us,
+        i2c.transacoes, i2c.juntadas, i2c.prazos, i2c.recuperacoes,
+    };
+    memcpy(c, v, sizeof(v));
 }
 
-void buzzer_on() {
-    pwm_set_chan_level(slice_num, PWM_CHAN_A, 1250); // 50% duty cycle
-}
+// Um passo do relatorio; false quando terminou
+static bool relatorio_passo_executar(void) {
+    if (relatorio_modo == RELATORIO_TRACO) {
+        uint8_t bloco[RELATORIO_TRACO_BYTES];
+        uint32_t n = traco_serializar(relatorio_traco, relatorio_traco_offset, bloco, sizeof(bloco));
+        relatorio_traco_offset += n;
+        protocolo_enviar(relatorio_traco_tipo, bloco, (uint8_t)n);
+        return n != 0;
+    }
 
-void buzzer_off() {
-    pwm_set_chan_level(slice_num, PWM_CHAN_A, 0);
-}
+    uint8_t passo = relatorio_passo++;
+    if (passo < PERFIL_NUCLEOS * PERFIL_SONDAS_NUCLEO) {
+        uint8_t nucleo = passo / PERFIL_SONDAS_NUCLEO;
+        const perfil_sonda_t *sonda = perfil_sonda_n(nucleo, passo % PERFIL_SONDAS_NUCLEO);
+        if (!sonda)
+            return true;  // posicao vazia: segue para a proxima
+        if (relatorio_modo == RELATORIO_TEXTO) {
+            char linha[144];
+            perfil_formatar(sonda, nucleo, linha, sizeof(linha));
+            fputs(linha, stdout);
+        } else {
+            uint8_t reg[PERFIL_REGISTRO_BIN];
+            perfil_serializar(sonda, nucleo, reg);
+            protocolo_enviar(RELATORIO_TIPO_SONDA, reg, sizeof(reg));
+        }
+        return true;
+    }
 
-// Executa som "tom de voz" â€“ varia a frequÃªncia levemente â€“ por 5 segundos
-void executar_som_buzzer_5s() {
-    uint32_t start = time_us_32();
-    while ((time_us_32() - start) < 5000000UL) { // 5 segundos
-        // FrequÃªncia variando para simular um tom de voz: entre 680 e 720 Hz
-        uint32_t freq = 680 + (rand() % 41);
-        buzzer_set_frequency(freq);
-        buzzer_on();
-        sleep_ms(100);
-        buzzer_off();
-        sleep_ms(50);
+    uint32_t c[RELATORIO_N_CONTADORES];
+    relatorio_contadores(c);
+    if (relatorio_modo == RELATORIO_TEXTO) {
+        printf("hid relatorios=%lu ocupado=%lu falhas=%lu botoes_perdidos=%lu latencia_max=%luus\n",
+               (unsigned long)c[0], (unsigned long)c[1], (unsigned long)c[2], (unsigned long)c[3],
+               (unsigned long)c[4]);
+        printf("oled quadros=%lu ignorados=%lu bytes=%lu erros_i2c=%lu ui_quadros=%lu ui_adiados=%lu\n",
+               (unsigned long)c[5], (unsigned long)c[6], (unsigned long)c[7], (unsigned long)c[8],
+               (unsigned long)c[9], (unsigned long)c[10]);
+        printf("usb teclado=%lu teclado_descartados=%lu cdc_enviados=%lu cdc_perdidos=%lu\n",
+               (unsigned long)c[11], (unsigned long)c[12], (unsigned long)c[13], (unsigned long)c[14]);
+        printf("energia nivel=%lu despertares=%lu latencia_max=%luus acima_limite=%lu descartadas=%lu\n",
+               (unsigned long)c[15], (unsigned long)c[16], (unsigned long)c[17], (unsigned long)c[18],
+               (unsigned long)c[19]);
+        printf("audio pacotes=%lu subfluxos=%lu perdidas=%lu nivel=%lu..%lu intervalo_max=%luus\n",
+               (unsigned long)c[20], (unsigned long)c[21], (unsigned long)c[22], (unsigned long)c[23],
+               (unsigned long)c[24], (unsigned long)c[25]);
+        printf("i2c transacoes=%lu juntadas=%lu prazos=%lu recuperacoes=%lu\n",
+               (unsigned long)c[26], (unsigned long)c[27], (unsigned long)c[28], (unsigned long)c[29]);
+    } else {
+        uint8_t reg[4 * RELATORIO_N_CONTADORES];
+        for (int i = 0; i < RELATORIO_N_CONTADORES; i++) {
+            reg[4 * i] = (uint8_t)c[i];
+            reg[4 * i + 1] = (uint8_t)(c[i] >> 8);
+            reg[4 * i + 2] = (uint8_t)(c[i] >> 16);
+            reg[4 * i + 3] = (uint8_t)(c[i] >> 24);
+        }
+        protocolo_enviar(RELATORIO_TIPO_CONTADORES, reg, sizeof(reg));
     }
+    return false;
 }
 
-// =====================
-// Leitura do Microfone (ADC)
-// =====================
-uint16_t ler_microfone() {
-    adc_select_input(MIC_ADC_CHANNEL);
-    return adc_read();
+static void relatorio_iniciar(relatorio_modo_t modo) {
+    relatorio_modo = modo;
+    relatorio_passo = 0;
+    if (modo == RELATORIO_TEXTO)
+        printf("perfil: nucleo tarefa n min p50 p99 max media\n");
 }
 
-// =====================
-// Processamento do Joystick (movimento do mouse)
-// =====================
-void processar_joystick() {
-    adc_select_input(JOY_X_ADC_CHANNEL);
-    uint16_t adc_x = adc_read();
-    adc_select_input(JOY_Y_ADC_CHANNEL);
-    uint16_t adc_y = adc_read();
-
-    int x_offset = (int)adc_x - 2048;
-    int y_offset = (int)adc_y - 2048;
-    if (abs(x_offset) < 100) x_offset = 0;
-    if (abs(y_offset) < 100) y_offset = 0;
-
-    int8_t dx = (int8_t)(x_offset / 128);
-    int8_t dy = (int8_t)(y_offset / 128);
-
-    if (dx != 0 || dy != 0) {
-        ssd1306_clear();
-        ssd1306_draw_string("Em uso", 0, 0);
-        enviar_mouse_report(0, dx, dy, 0);
-    } else {
-        ssd1306_clear();
-        ssd1306_draw_string("Aguardando", 0, 0);
+// Comandos de um caractere do relatorio; quadros de configuracao (config.h)
+// respondidos com um quadro do mesmo tipo
+static protocolo_t console;
+
+// Comandos do traco. O nucleo 1 escreve nos tracos enquanto grava ou
+// reproduz, entao o despejo so comeca com ele parado, e nada muda o traco
+// durante o despejo.
+static void console_traco(char c) {
+    bool despejando = relatorio_modo == RELATORIO_TRACO;
+    if ((c == 'g' || c == 'r' || c == 's') && !despejando) {
+        entrada_traco_pedir(c);
+        printf("traco: %s\n", c == 'g' ? "gravando" : c == 'r' ? "reproduzindo" : "parado");
+    } else if ((c == 'd' || c == 'e') && !despejando && entrada_traco_parado()) {
+        relatorio_traco = c == 'd' ? &traco_gravacao : &traco_saida;
+        relatorio_traco_tipo = c == 'd' ? RELATORIO_TIPO_TRACO : RELATORIO_TIPO_TRACO_SAIDA;
+        relatorio_traco_offset = 0;
+        relatorio_modo = RELATORIO_TRACO;
     }
 }
 
-// =====================
-// Processamento do BotÃ£o do Joystick para cliques
-// =====================
-void processar_botao_joystick() {
-    if (gpio_get(JOY_BUTTON_PIN) == 0) {  // Ativo em nÃ­vel baixo
-        uint32_t inicio = to_ms_since_boot(get_absolute_time());
-        while (gpio_get(JOY_BUTTON_PIN) == 0) {
-            sleep_ms(10);
-        }
-        uint32_t duracao = to_ms_since_boot(get_absolute_time()) - inicio;
-        if (duracao < 1000) {
-            // Clique curto: clique esquerdo
-            enviar_mouse_report(0x01, 0, 0, 0);
-            sleep_ms(50);
-            enviar_mouse_report(0, 0, 0, 0);
-        } else {
-            // Clique longo: clique direito
-            enviar_mouse_report(0x02, 0, 0, 0);
-            sleep_ms(50);
-            enviar_mouse_report(0, 0, 0, 0);
-        }
+static void console_comando(protocolo_resultado_t r) {
+    if (r == PROTOCOLO_CARACTERE) {
+        if (console.tipo == 'p')
+            relatorio_iniciar(RELATORIO_TEXTO);
+        else if (console.tipo == 'b')
+            relatorio_iniciar(RELATORIO_BINARIO);
+        else if (console.tipo == 'z')
+            perfil_zerar();
+        else
+            console_traco(console.tipo);
+    } else if (r == PROTOCOLO_QUADRO) {
+        uint8_t resposta[CONFIG_RESPOSTA_MAX];
+        uint8_t n = config_executar(console.tipo, console.dados, console.n, resposta);
+        if (n)
+            protocolo_enviar(console.tipo, resposta, n);
     }
 }
 
-// =====================
-// Processamento do BotÃ£o A: "Transcrevendo tela" e som no buzzer
-// =====================
-void processar_botao_A() {
-    if (gpio_get(BUTTON_A_PIN) == 0) {  // Ativo em nÃ­vel baixo
-        ssd1306_clear();
-        ssd1306_draw_string("Transcrevendo tela", 0, 0);
-        executar_som_buzzer_5s();
-        // Aguarda liberaÃ§Ã£o do botÃ£o
-        while (gpio_get(BUTTON_A_PIN) == 0) { sleep_ms(10); }
+#define CONSOLE_BYTES_PASSO 32  // bytes recebidos tratados por passo
+
+void relatorio_tarefa(void) {
+    for (int i = 0; i < CONSOLE_BYTES_PASSO; i++) {
+        int c = getchar_timeout_us(0);
+        if (c < 0)
+            break;
+        console_comando(protocolo_receber(&console, (uint8_t)c, time_us_32()));
+    }
+
+    if (RELATORIO_PERIODO_MS && relatorio_modo == RELATORIO_PARADO && time_reached(relatorio_proximo)) {
+        relatorio_proximo = make_timeout_time_ms(RELATORIO_PERIODO_MS);
+        relatorio_iniciar(RELATORIO_TEXTO);
     }
+
+    if (relatorio_modo != RELATORIO_PARADO && !relatorio_passo_executar())
+        relatorio_modo = RELATORIO_PARADO;
 }
 
 // =====================
-// Processamento do BotÃ£o B: Microfone para "Ouvindo" ou "Pronto pra ouvir"
+// Nucleo 1: entrada e HID
 // =====================
-void processar_botao_B() {
-    if (gpio_get(BUTTON_B_PIN) == 0) {  // Ativo em nÃ­vel baixo
-        sleep_ms(100); // debounce
-        uint16_t mic_val = ler_microfone();
-        ssd1306_clear();
-        if (mic_val > 2048) {
-            ssd1306_draw_string("Ouvindo", 0, 0);
-        } else {
-            ssd1306_draw_string("Pronto pra ouvir", 0, 0);
-        }
-        // Aguarda liberaÃ§Ã£o do botÃ£o
-        while (gpio_get(BUTTON_B_PIN) == 0) { sleep_ms(10); }
-    }
+// O TinyUSB e inicializado aqui para que a IRQ do USB fique neste nucleo,
+// junto com tud_task() e os relatorios HID.
+void core1_main(void) {
+    perfil_init_nucleo();
+    // Deixa o nucleo 0 pausar este durante as gravacoes da configuracao
+    flash_safe_execute_core_init();
+    tusb_init();
+    hid_mouse_init();
+
+    // Botoes por IRQ de borda, captura continua do ADC e calibracao do
+    // joystick: as IRQs de GPIO e de rearme do DMA ficam neste nucleo,
+    // junto dos consumidores
+    static const uint8_t pinos_botoes[N_BOTOES] = {
+        [BOTAO_JOY] = JOY_BUTTON_PIN,
+        [BOTAO_A] = BUTTON_A_PIN,
+        [BOTAO_B] = BUTTON_B_PIN,
+    };
+    entrada_init(pinos_botoes);
+    traco_init(&traco_gravacao, traco_gravacao_buf, sizeof(traco_gravacao_buf));
+    traco_init(&traco_saida, traco_saida_buf, sizeof(traco_saida_buf));
+    entrada_traco_usar(&traco_gravacao, &traco_saida);
+
+    static scheduler_t scheduler_nucleo1;
+    scheduler_init(&scheduler_nucleo1);
+    entrada_registrar(&scheduler_nucleo1);
+    scheduler_run(&scheduler_nucleo1);
 }
 
 // =====================
 // main
 // =====================
 int main() {
+    // Antes da stdio: a UART passa a usar o clk_peri independente do clk_sys
+    energia_relogio_init();
     stdio_init_all();
-    tusb_init();
+    perfil_init_nucleo();
 
-    // Configura os botÃµes com pull-up
-    gpio_init(BUTTON_A_PIN);
-    gpio_set_dir(BUTTON_A_PIN, GPIO_IN);
-    gpio_pull_up(BUTTON_A_PIN);
-    
-    gpio_init(BUTTON_B_PIN);
-    gpio_set_dir(BUTTON_B_PIN, GPIO_IN);
-    gpio_pull_up(BUTTON_B_PIN);
-    
-    gpio_init(JOY_BUTTON_PIN);
-    gpio_set_dir(JOY_BUTTON_PIN, GPIO_IN);
-    gpio_pull_up(JOY_BUTTON_PIN);
-
-    // Inicializa ADC (joystick e microfone)
-    adc_init();
-
-    // Inicializa I2C para o display OLED
-    i2c_init(I2C_PORT, 400 * 1000);
-    gpio_set_function(PIN_SDA, GPIO_FUNC_I2C);
-    gpio_set_function(PIN_SCL, GPIO_FUNC_I2C);
-    gpio_pull_up(PIN_SDA);
-    gpio_pull_up(PIN_SCL);
+    // Fila do I2C para o display OLED; a IRQ do DMA fica neste nucleo
+    i2c_fila_init(I2C_PORT, 400 * 1000, PIN_SDA, PIN_SCL);
 
     // Inicializa o display OLED
-    ssd1306_init();
+    ssd1306_init(SSD1306_ADDR);
+    painel_init();
 
     // Inicializa o buzzer
-    buzzer_init();
-
-    while (true) {
-        tud_task();  // Processa as tarefas USB do TinyUSB
-        processar_joystick();
-        processar_botao_joystick();
-        processar_botao_A();
-        processar_botao_B();
-        sleep_ms(50);
-    }
+    audio_init(BUZZER_PIN);
+    preparar_som_buzzer();
+
+    // LED RGB: os padroes sao piscados pelo PIO
+    led_init(LED_VERMELHO_PIN, LED_VERDE_PIN);
+    indicadores_atualizar();
+
+    // Entrada e USB no nucleo 1; display e buzzer ficam neste nucleo
+    entrada_eventos_init();
+    cdc_controle_init();
+    config_init();
+    protocolo_init(&console);
+    multicore_launch_core1(core1_main);
+
+    scheduler_init(&scheduler_nucleo0);
+    painel_registrar(&scheduler_nucleo0, eventos_tarefa);
+    relatorio_proximo = make_timeout_time_ms(RELATORIO_PERIODO_MS);
+    scheduler_add_task(&scheduler_nucleo0, "relatorio", relatorio_tarefa, PERIODO_RELATORIO_US);
+    scheduler_run(&scheduler_nucleo0);
     return 0;
 }
\ No newline at end of file
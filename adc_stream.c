@@ -0,0 +1,132 @@
+// adc_stream.c - Captura continua do ADC em round-robin via DMA
+
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "quente.h"
+#include "adc_stream.h"
+
+#define ADC_STREAM_AMOSTRAS (ADC_STREAM_QUADROS * ADC_STREAM_CANAIS)
+#define ADC_STREAM_ANEL_BYTES (ADC_STREAM_AMOSTRAS * sizeof(uint16_t))
+#define ADC_STREAM_ANEL_BITS 12     // log2(ADC_STREAM_ANEL_BYTES)
+
+// O DMA roda com uma contagem enorme e e rearmado pela IRQ quando ela
+// acaba (~9 h a 64 kS/s). Multiplo do anel para manter o alinhamento.
+#define ADC_STREAM_REARME   0x80000000u
+
+// Folga entre o quadro mais antigo que um consumidor le e o que o DMA esta
+// sobrescrevendo naquele momento (1 ms a 16 kHz)
+#define ADC_STREAM_MARGEM   16
+
+_Static_assert(ADC_STREAM_ANEL_BYTES == (1u << ADC_STREAM_ANEL_BITS), "anel do DMA deve ser potencia de 2");
+
+static volatile uint16_t adc_anel[ADC_STREAM_AMOSTRAS] __attribute__((aligned(ADC_STREAM_ANEL_BYTES)));
+static int adc_dma_canal = -1;
+static volatile uint32_t adc_base_quadros;  // quadros completos de disparos anteriores
+static uint32_t adc_taxa_hz;
+
+static void adc_stream_dma_irq(void) {
+    if (!dma_channel_get_irq1_status(adc_dma_canal))
+        return;
+    dma_channel_acknowledge_irq1(adc_dma_canal);
+    adc_base_quadros += ADC_STREAM_REARME / ADC_STREAM_CANAIS;
+    // O endereco de escrita continua de onde parou, dentro do anel
+    dma_channel_set_trans_count(adc_dma_canal, ADC_STREAM_REARME, true);
+}
+
+void adc_stream_set_taxa(uint32_t taxa_por_canal_hz) {
+    // Cada conversao leva (1 + div) ciclos do clk_adc, no minimo 96
+    uint32_t clk_adc_hz = clock_get_hz(clk_adc);
+    uint32_t taxa_total = taxa_por_canal_hz * ADC_STREAM_CANAIS;
+    uint32_t ciclos = taxa_total ? clk_adc_hz / taxa_total : 96;
+    if (ciclos < 96)
+        ciclos = 96;
+    adc_set_clkdiv((float)(ciclos - 1));
+    adc_taxa_hz = clk_adc_hz / ciclos / ADC_STREAM_CANAIS;
+}
+
+void adc_stream_init(uint32_t taxa_por_canal_hz) {
+    adc_init();
+    adc_gpio_init(26);  // canal 0
+    adc_gpio_init(27);  // canal 1
+    adc_gpio_init(28);  // canal 2
+    adc_set_temp_sensor_enabled(true);
+
+    adc_select_input(0);
+    adc_set_round_robin((1u << 0) | (1u << 1) | (1u << 2) | (1u << 4));
+    adc_fifo_setup(true, true, 1, false, false);
+    adc_stream_set_taxa(taxa_por_canal_hz);
+
+    adc_dma_canal = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(adc_dma_canal);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, ADC_STREAM_ANEL_BITS);
+    channel_config_set_dreq(&c, DREQ_ADC);
+    dma_channel_configure(adc_dma_canal, &c, adc_anel, &adc_hw->fifo, ADC_STREAM_REARME, true);
+
+    dma_channel_set_irq1_enabled(adc_dma_canal, true);
+    irq_add_shared_handler(DMA_IRQ_1, adc_stream_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+
+    adc_fifo_drain();
+    adc_run(true);
+}
+
+uint32_t adc_stream_taxa_hz(void) {
+    return adc_taxa_hz;
+}
+
+uint32_t QUENTE(adc_stream_quadros)(void) {
+    uint32_t base, restantes;
+    // Se a IRQ de rearme acontecer entre as duas leituras, repete
+    do {
+        base = adc_base_quadros;
+        restantes = dma_hw->ch[adc_dma_canal].transfer_count;
+    } while (base != adc_base_quadros);
+    return base + (ADC_STREAM_REARME - restantes) / ADC_STREAM_CANAIS;
+}
+
+static inline uint16_t adc_stream_amostra(uint32_t quadro, uint8_t canal) {
+    return adc_anel[(quadro % ADC_STREAM_QUADROS) * ADC_STREAM_CANAIS + canal];
+}
+
+uint16_t adc_stream_ultima(uint8_t canal) {
+    return adc_stream_amostra(adc_stream_quadros() - 1, canal);
+}
+
+uint16_t QUENTE(adc_stream_media)(uint8_t canal, uint32_t n) {
+    if (n == 0)
+        return adc_stream_ultima(canal);
+    if (n > ADC_STREAM_QUADROS - ADC_STREAM_MARGEM)
+        n = ADC_STREAM_QUADROS - ADC_STREAM_MARGEM;
+    uint32_t fim = adc_stream_quadros();
+    uint32_t soma = 0;
+    for (uint32_t q = fim - n; q != fim; q++)
+        soma += adc_stream_amostra(q, canal);
+    return (uint16_t)((soma + n / 2) / n);
+}
+
+uint32_t adc_stream_ler(uint8_t canal, uint32_t *cursor, uint16_t *dest,
+                        uint32_t max, uint32_t *perdidas) {
+    uint32_t fim = adc_stream_quadros();
+    uint32_t disponiveis = fim - *cursor;
+    uint32_t pulados = 0;
+    if (disponiveis > ADC_STREAM_QUADROS - ADC_STREAM_MARGEM) {
+        pulados = disponiveis - (ADC_STREAM_QUADROS - ADC_STREAM_MARGEM);
+        *cursor += pulados;
+        disponiveis -= pulados;
+    }
+    if (perdidas)
+        *perdidas = pulados;
+
+    uint32_t n = disponiveis < max ? disponiveis : max;
+    uint32_t q = *cursor;
+    for (uint32_t i = 0; i < n; i++)
+        dest[i] = adc_stream_amostra(q + i, canal);
+    *cursor = q + n;
+    return n;
+}
@@ -0,0 +1,60 @@
+// adc_stream.h - Captura continua do ADC em round-robin via DMA
+//
+// O ADC converte sem parar os canais 0 (joystick X), 1 (joystick Y),
+// 2 (microfone) e 4 (sensor de temperatura) e o DMA despeja as amostras num
+// anel em RAM, sem nenhuma participacao da CPU por amostra. O canal 4 entra
+// apenas para que cada quadro tenha 4 amostras: o anel do DMA precisa ter
+// tamanho potencia de 2, e assim cada canal ocupa sempre a mesma posicao
+// dentro do quadro.
+//
+// Os consumidores leem a amostra mais recente, medias por bloco ou o fluxo
+// continuo de um canal a partir de um cursor proprio.
+
+#ifndef ADC_STREAM_H
+#define ADC_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ADC_STREAM_CANAIS   4
+#define ADC_STREAM_QUADROS  512     // 512 quadros x 4 canais x 2 bytes = 4 KB
+
+// Posicao de cada canal dentro do quadro
+enum {
+    ADC_STREAM_X = 0,
+    ADC_STREAM_Y = 1,
+    ADC_STREAM_MIC = 2,
+    ADC_STREAM_TEMP = 3,
+};
+
+// Inicia a captura com a taxa de amostragem pedida para cada canal (a taxa
+// total do ADC e 4x maior, limitada a 500 kS/s). Deve ser chamada no nucleo
+// que consome as amostras, pois a IRQ de rearme do DMA fica nele.
+void adc_stream_init(uint32_t taxa_por_canal_hz);
+
+// Muda a taxa por canal com a captura em andamento (so o divisor do ADC;
+// o anel e os cursores seguem valendo). Os quadros seguintes chegam no
+// novo ritmo: medias e leituras por numero de quadros cobrem outra janela
+// de tempo.
+void adc_stream_set_taxa(uint32_t taxa_por_canal_hz);
+
+// Taxa efetiva por canal, apos o arredondamento do divisor do ADC
+uint32_t adc_stream_taxa_hz(void);
+
+// Numero de quadros completos capturados desde o inicio (contador circular)
+uint32_t adc_stream_quadros(void);
+
+// Amostra mais recente de um canal
+uint16_t adc_stream_ultima(uint8_t canal);
+
+// Media das n amostras mais recentes de um canal (n <= ADC_STREAM_QUADROS)
+uint16_t adc_stream_media(uint8_t canal, uint32_t n);
+
+// Copia para dest as amostras de um canal capturadas desde *cursor (um
+// contador de quadros do proprio consumidor) e avanca o cursor. Se o
+// consumidor ficou mais de um anel para tras, as amostras mais antigas sao
+// puladas e *perdidas recebe quantas foram. Retorna o numero copiado.
+uint32_t adc_stream_ler(uint8_t canal, uint32_t *cursor, uint16_t *dest,
+                        uint32_t max, uint32_t *perdidas);
+
+#endif // ADC_STREAM_H
@@ -0,0 +1,87 @@
+// afinacao.c - Afinacao inteira do PWM do buzzer
+
+#include "afinacao.h"
+
+// Divisores testados acima do minimo: uma unidade inteira de DIV (16 passos
+// de 1/16). Alem disso TOP so diminui e o erro de arredondamento cresce.
+#define AFINACAO_BUSCA      16
+
+#define AFINACAO_NOTA_PWM(nome, midi, chz) AFINACAO_PWM_CONST(AFINACAO_CLK_HZ, chz),
+static const afinacao_pwm_t afinacao_tabela_flash[] = {
+    AFINACAO_NOTAS(AFINACAO_NOTA_PWM)
+};
+#undef AFINACAO_NOTA_PWM
+
+#define AFINACAO_NOTA_CHZ(nome, midi, chz) chz,
+static const uint32_t afinacao_tabela_chz[] = {
+    AFINACAO_NOTAS(AFINACAO_NOTA_CHZ)
+};
+#undef AFINACAO_NOTA_CHZ
+
+_Static_assert(sizeof(afinacao_tabela_flash) / sizeof(afinacao_tabela_flash[0]) ==
+               AFINACAO_MIDI_MAX - AFINACAO_MIDI_MIN + 1, "tabela de notas incompleta");
+
+static afinacao_pwm_t afinacao_tabela_ram[AFINACAO_MIDI_MAX - AFINACAO_MIDI_MIN + 1];
+static const afinacao_pwm_t *afinacao_tabela = afinacao_tabela_flash;
+static uint32_t afinacao_clk_hz = AFINACAO_CLK_HZ;
+
+afinacao_pwm_t afinacao_calcular(uint32_t clk_hz, uint32_t freq_chz) {
+    if (freq_chz == 0)
+        return AFINACAO_PAUSA;
+
+    // clk * 16 (fracao do DIV) * 100 (centesimos de Hz)
+    const uint64_t alvo = (uint64_t)clk_hz * 1600;
+    uint64_t div = (alvo + (uint64_t)freq_chz * 65536 - 1) / ((uint64_t)freq_chz * 65536);
+    if (div < AFINACAO_DIV_MIN)
+        div = AFINACAO_DIV_MIN;
+
+    afinacao_pwm_t melhor = { AFINACAO_DIV_MAX, 0xFFFF };
+    uint64_t melhor_erro = UINT64_MAX;
+    for (uint32_t i = 0; i < AFINACAO_BUSCA && div <= AFINACAO_DIV_MAX; i++, div++) {
+        uint64_t passo = div * freq_chz;
+        uint64_t periodo = (alvo + passo / 2) / passo;  // TOP + 1
+        if (periodo < 2 || periodo > 65536)
+            continue;
+        // Erro de frequencia em centesimos de Hz, escalado por 2^16 para
+        // nao perder a comparacao entre pares quase iguais
+        uint64_t produzido = passo * periodo;
+        uint64_t diferenca = produzido > alvo ? produzido - alvo : alvo - produzido;
+        uint64_t erro = (diferenca << 16) / (div * periodo);
+        if (erro < melhor_erro) {
+            melhor_erro = erro;
+            melhor.div = (uint16_t)div;
+            melhor.top = (uint16_t)(periodo - 1);
+            if (erro == 0)
+                break;
+        }
+    }
+    return melhor;
+}
+
+void afinacao_init(uint32_t clk_hz) {
+    afinacao_clk_hz = clk_hz;
+    if (clk_hz == AFINACAO_CLK_HZ) {
+        afinacao_tabela = afinacao_tabela_flash;
+        return;
+    }
+    for (uint32_t i = 0; i < sizeof(afinacao_tabela_ram) / sizeof(afinacao_tabela_ram[0]); i++)
+        afinacao_tabela_ram[i] = afinacao_calcular(clk_hz, afinacao_tabela_chz[i]);
+    afinacao_tabela = afinacao_tabela_ram;
+}
+
+afinacao_pwm_t afinacao_hz(uint32_t freq_hz) {
+    return afinacao_calcular(afinacao_clk_hz, freq_hz * 100);
+}
+
+afinacao_pwm_t afinacao_nota(uint8_t midi) {
+    if (midi < AFINACAO_MIDI_MIN || midi > AFINACAO_MIDI_MAX)
+        return AFINACAO_PAUSA;
+    return afinacao_tabela[midi - AFINACAO_MIDI_MIN];
+}
+
+uint32_t afinacao_freq_chz(uint32_t clk_hz, afinacao_pwm_t pwm) {
+    if (pwm.div == 0)
+        return 0;
+    uint64_t passo = (uint64_t)pwm.div * ((uint32_t)pwm.top + 1);
+    return (uint32_t)(((uint64_t)clk_hz * 1600 + passo / 2) / passo);
+}
@@ -0,0 +1,159 @@
+// afinacao.h - Afinacao inteira do PWM do buzzer
+//
+// A frequencia de uma fatia PWM e f = clk_sys * 16 / (DIV * (TOP + 1)), com
+// DIV no formato 8.4 do registrador (inteiro em 8 bits, fracao em 4). Este
+// modulo escolhe o par DIV/TOP so com aritmetica inteira:
+//   - afinacao_calcular() testa os divisores a partir do menor que ainda
+//     deixa TOP caber em 16 bits e fica com o par de menor erro;
+//   - a tabela de notas (MIDI 24 a 108, C1 a C8) e calculada pelo
+//     compilador para AFINACAO_CLK_HZ, com o divisor minimo, e fica em
+//     flash; afinacao_init() a recalcula em RAM se o clock real for outro.
+// O par escolhido erra menos de 0,002% (0,03 cent); o que domina e o
+// arredondamento das notas para centesimos de Hz, ate ~0,2 cent nas graves.
+
+#ifndef AFINACAO_H
+#define AFINACAO_H
+
+#include <stdint.h>
+
+// Clock assumido pela tabela gerada na compilacao (padrao do RP2040)
+#ifndef AFINACAO_CLK_HZ
+#define AFINACAO_CLK_HZ     125000000u
+#endif
+
+#define AFINACAO_DIV_MIN    0x010   // 1.0
+#define AFINACAO_DIV_MAX    0xFFF   // 255 + 15/16
+
+typedef struct {
+    uint16_t div;               // DIV em 8.4; 0 = pausa
+    uint16_t top;
+} afinacao_pwm_t;
+
+#define AFINACAO_PAUSA      ((afinacao_pwm_t){ 0, 0 })
+
+// Notas da escala temperada (A4 = 440 Hz): X(nome, midi, centesimos de Hz)
+#define AFINACAO_NOTAS(X) \
+    X(C1, 24, 3270) \
+    X(CS1, 25, 3465) \
+    X(D1, 26, 3671) \
+    X(DS1, 27, 3889) \
+    X(E1, 28, 4120) \
+    X(F1, 29, 4365) \
+    X(FS1, 30, 4625) \
+    X(G1, 31, 4900) \
+    X(GS1, 32, 5191) \
+    X(A1, 33, 5500) \
+    X(AS1, 34, 5827) \
+    X(B1, 35, 6174) \
+    X(C2, 36, 6541) \
+    X(CS2, 37, 6930) \
+    X(D2, 38, 7342) \
+    X(DS2, 39, 7778) \
+    X(E2, 40, 8241) \
+    X(F2, 41, 8731) \
+    X(FS2, 42, 9250) \
+    X(G2, 43, 9800) \
+    X(GS2, 44, 10383) \
+    X(A2, 45, 11000) \
+    X(AS2, 46, 11654) \
+    X(B2, 47, 12347) \
+    X(C3, 48, 13081) \
+    X(CS3, 49, 13859) \
+    X(D3, 50, 14683) \
+    X(DS3, 51, 15556) \
+    X(E3, 52, 16481) \
+    X(F3, 53, 17461) \
+    X(FS3, 54, 18500) \
+    X(G3, 55, 19600) \
+    X(GS3, 56, 20765) \
+    X(A3, 57, 22000) \
+    X(AS3, 58, 23308) \
+    X(B3, 59, 24694) \
+    X(C4, 60, 26163) \
+    X(CS4, 61, 27718) \
+    X(D4, 62, 29366) \
+    X(DS4, 63, 31113) \
+    X(E4, 64, 32963) \
+    X(F4, 65, 34923) \
+    X(FS4, 66, 36999) \
+    X(G4, 67, 39200) \
+    X(GS4, 68, 41530) \
+    X(A4, 69, 44000) \
+    X(AS4, 70, 46616) \
+    X(B4, 71, 49388) \
+    X(C5, 72, 52325) \
+    X(CS5, 73, 55437) \
+    X(D5, 74, 58733) \
+    X(DS5, 75, 62225) \
+    X(E5, 76, 65926) \
+    X(F5, 77, 69846) \
+    X(FS5, 78, 73999) \
+    X(G5, 79, 78399) \
+    X(GS5, 80, 83061) \
+    X(A5, 81, 88000) \
+    X(AS5, 82, 93233) \
+    X(B5, 83, 98777) \
+    X(C6, 84, 104650) \
+    X(CS6, 85, 110873) \
+    X(D6, 86, 117466) \
+    X(DS6, 87, 124451) \
+    X(E6, 88, 131851) \
+    X(F6, 89, 139691) \
+    X(FS6, 90, 147998) \
+    X(G6, 91, 156798) \
+    X(GS6, 92, 166122) \
+    X(A6, 93, 176000) \
+    X(AS6, 94, 186466) \
+    X(B6, 95, 197553) \
+    X(C7, 96, 209300) \
+    X(CS7, 97, 221746) \
+    X(D7, 98, 234932) \
+    X(DS7, 99, 248902) \
+    X(E7, 100, 263702) \
+    X(F7, 101, 279383) \
+    X(FS7, 102, 295996) \
+    X(G7, 103, 313596) \
+    X(GS7, 104, 332244) \
+    X(A7, 105, 352000) \
+    X(AS7, 106, 372931) \
+    X(B7, 107, 395107) \
+    X(C8, 108, 418601)
+
+#define AFINACAO_NOTA_ENUM(nome, midi, chz) NOTA_##nome = midi,
+enum {
+    AFINACAO_NOTAS(AFINACAO_NOTA_ENUM)
+};
+#undef AFINACAO_NOTA_ENUM
+
+#define AFINACAO_MIDI_MIN   24
+#define AFINACAO_MIDI_MAX   108
+
+// Par DIV/TOP calculado pelo compilador: o menor DIV (arredondado para
+// cima) que deixa TOP + 1 <= 65536, e TOP arredondado para esse DIV
+#define AFINACAO_DIV_CONST(clk, chz)                                            \
+    ((((uint64_t)(clk) * 1600 + (uint64_t)(chz) * 65536 - 1) / ((uint64_t)(chz) * 65536)) < AFINACAO_DIV_MIN \
+     ? AFINACAO_DIV_MIN                                                         \
+     : (((uint64_t)(clk) * 1600 + (uint64_t)(chz) * 65536 - 1) / ((uint64_t)(chz) * 65536)))
+#define AFINACAO_TOP_CONST(clk, chz)                                            \
+    (((uint64_t)(clk) * 1600 + AFINACAO_DIV_CONST(clk, chz) * (chz) / 2) /       \
+     (AFINACAO_DIV_CONST(clk, chz) * (chz)) - 1)
+#define AFINACAO_PWM_CONST(clk, chz) \
+    { (uint16_t)AFINACAO_DIV_CONST(clk, chz), (uint16_t)AFINACAO_TOP_CONST(clk, chz) }
+
+// Recalcula a tabela de notas se clk_hz diferir de AFINACAO_CLK_HZ e guarda
+// o clock para afinacao_hz()
+void afinacao_init(uint32_t clk_hz);
+
+// Melhor par DIV/TOP para a frequencia (centesimos de Hz); pausa se 0
+afinacao_pwm_t afinacao_calcular(uint32_t clk_hz, uint32_t freq_chz);
+
+// Atalho com o clock de afinacao_init() e frequencia em Hz inteiros
+afinacao_pwm_t afinacao_hz(uint32_t freq_hz);
+
+// Consulta a tabela (NOTA_A4 etc.); pausa fora da faixa
+afinacao_pwm_t afinacao_nota(uint8_t midi);
+
+// Frequencia que o par produz de fato, em centesimos de Hz
+uint32_t afinacao_freq_chz(uint32_t clk_hz, afinacao_pwm_t pwm);
+
+#endif // AFINACAO_H
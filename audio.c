@@ -0,0 +1,222 @@
+// audio.c - Motor de audio do buzzer por PWM + DMA, sem bloquear a CPU
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "audio.h"
+
+// Ritmo do temporizador do DMA nas sequencias de notas: cada transferencia
+// do bloco de espera dura um tique
+#define AUDIO_TIQUE_HZ      8000
+
+
+// Bloco de controle no formato do alias 0 do canal de DMA
+typedef struct {
+    const volatile void *read_addr;
+    volatile void *write_addr;
+    uint32_t trans_count;
+    uint32_t ctrl_trig;
+} audio_bloco_t;
+
+// Imagem dos registradores DIV, CTR, CC e TOP de uma fatia PWM
+typedef struct {
+    uint32_t div;
+    uint32_t ctr;
+    uint32_t cc;
+    uint32_t top;
+} audio_regs_t;
+
+// Por nota: registradores + espera; mais os blocos de PCM e o final
+static audio_bloco_t audio_blocos[2 * AUDIO_MAX_NOTAS + 3];
+static audio_regs_t audio_imagens[AUDIO_MAX_NOTAS + 2];
+static uint32_t audio_lixo;  // origem e destino dos blocos de espera
+
+static int audio_dma_dados = -1;
+static int audio_dma_controle = -1;
+static int audio_dma_timer = -1;
+static uint audio_fatia;
+static uint audio_canal_pwm;
+static uint32_t audio_clk_hz;
+
+// Valores de CTRL dos blocos
+static uint32_t ctrl_regs, ctrl_espera, ctrl_pcm, ctrl_fim;
+
+static const audio_som_t *audio_fila[AUDIO_FILA];
+static uint8_t audio_fila_cabeca, audio_fila_cauda;
+static volatile bool audio_ativo = false;
+
+static uint32_t audio_nivel_cc(uint32_t nivel) {
+    return audio_canal_pwm == PWM_CHAN_A ? nivel : nivel << 16;
+}
+
+static void audio_imagem_nota(audio_regs_t *img, const audio_nota_t *nota) {
+    img->ctr = 0;
+    if (nota->tom.div == 0) {
+        img->div = AFINACAO_DIV_MIN;
+        img->top = AUDIO_PCM_TOPO;
+        img->cc = 0;
+        return;
+    }
+    img->div = nota->tom.div;
+    img->top = nota->tom.top;
+    // Volume maximo = duty de 50%, o mais alto para um buzzer passivo
+    img->cc = audio_nivel_cc(((uint32_t)nota->tom.top + 1) * nota->volume / (2 * AUDIO_VOLUME_MAX));
+}
+
+static void audio_timer_taxa(uint32_t taxa_hz) {
+    uint32_t y = taxa_hz ? audio_clk_hz / taxa_hz : 0xFFFF;
+    if (y > 0xFFFF)
+        y = 0xFFFF;
+    if (y < 1)
+        y = 1;
+    dma_timer_set_fraction(audio_dma_timer, 1, (uint16_t)y);
+}
+
+// Monta a lista de blocos do som e dispara o DMA
+static void audio_iniciar(const audio_som_t *som) {
+    volatile uint32_t *regs = &pwm_hw->slice[audio_fatia].div;
+    uint32_t nb = 0, ni = 0;
+
+    if (som->pcm) {
+        audio_timer_taxa(som->taxa_hz);
+        audio_imagens[ni] = (audio_regs_t){ AFINACAO_DIV_MIN, 0, 0, AUDIO_PCM_TOPO };
+        audio_blocos[nb++] = (audio_bloco_t){ &audio_imagens[ni++], regs, 4, ctrl_regs };
+        if (som->n_pcm)
+            audio_blocos[nb++] = (audio_bloco_t){ som->pcm, &pwm_hw->slice[audio_fatia].cc, som->n_pcm, ctrl_pcm };
+    } else {
+        audio_timer_taxa(AUDIO_TIQUE_HZ);
+        uint16_t n = som->n_notas < AUDIO_MAX_NOTAS ? som->n_notas : AUDIO_MAX_NOTAS;
+        for (uint16_t i = 0; i < n; i++) {
+            const audio_nota_t *nota = &som->notas[i];
+            if (nota->duracao_ms == 0)
+                continue;
+            audio_imagem_nota(&audio_imagens[ni], nota);
+            audio_blocos[nb++] = (audio_bloco_t){ &audio_imagens[ni++], regs, 4, ctrl_regs };
+            audio_blocos[nb++] = (audio_bloco_t){ &audio_lixo, &audio_lixo,
+                                                  (uint32_t)nota->duracao_ms * (AUDIO_TIQUE_HZ / 1000),
+                                                  ctrl_espera };
+        }
+    }
+
+    // Silencio; este bloco nao encadeia e gera a IRQ de fim
+    audio_imagens[ni] = (audio_regs_t){ AFINACAO_DIV_MIN, 0, 0, AUDIO_PCM_TOPO };
+    audio_blocos[nb++] = (audio_bloco_t){ &audio_imagens[ni], regs, 4, ctrl_fim };
+
+    dma_channel_set_read_addr(audio_dma_controle, audio_blocos, true);
+}
+
+// Inicia o proximo som da fila (com as interrupcoes desabilitadas ou na IRQ)
+static void audio_proximo(void) {
+    if (audio_fila_cabeca == audio_fila_cauda) {
+        audio_ativo = false;
+        return;
+    }
+    const audio_som_t *som = audio_fila[audio_fila_cauda++ & (AUDIO_FILA - 1)];
+    audio_ativo = true;
+    audio_iniciar(som);
+}
+
+static void audio_dma_irq(void) {
+    if (!dma_channel_get_irq0_status(audio_dma_dados))
+        return;
+    dma_channel_acknowledge_irq0(audio_dma_dados);
+    audio_proximo();
+}
+
+void audio_init(uint8_t pino) {
+    gpio_set_function(pino, GPIO_FUNC_PWM);
+    audio_fatia = pwm_gpio_to_slice_num(pino);
+    audio_canal_pwm = pwm_gpio_to_channel(pino);
+    pwm_set_wrap(audio_fatia, AUDIO_PCM_TOPO);
+    pwm_set_chan_level(audio_fatia, audio_canal_pwm, 0);
+    pwm_set_enabled(audio_fatia, true);
+
+    audio_clk_hz = clock_get_hz(clk_sys);
+    afinacao_init(audio_clk_hz);
+    audio_dma_dados = dma_claim_unused_channel(true);
+    audio_dma_controle = dma_claim_unused_channel(true);
+    audio_dma_timer = dma_claim_unused_timer(true);
+
+    // Canal de dados: um CTRL por tipo de bloco
+    dma_channel_config c = dma_channel_get_default_config(audio_dma_dados);
+    channel_config_set_chain_to(&c, audio_dma_controle);
+    channel_config_set_irq_quiet(&c, true);
+
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, DREQ_FORCE);
+    ctrl_regs = channel_config_get_ctrl_value(&c);
+
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, dma_get_timer_dreq(audio_dma_timer));
+    ctrl_espera = channel_config_get_ctrl_value(&c);
+
+    // Amostras de 16 bits: o barramento replica a meia palavra nos dois
+    // canais do CC, o que nao importa com apenas um deles no pino
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    ctrl_pcm = channel_config_get_ctrl_value(&c);
+
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, DREQ_FORCE);
+    channel_config_set_chain_to(&c, audio_dma_dados);  // encadear em si = nao encadear
+    channel_config_set_irq_quiet(&c, false);
+    ctrl_fim = channel_config_get_ctrl_value(&c);
+
+    // Canal de controle: copia um bloco (4 palavras) para o alias 0 do
+    // canal de dados; a escrita em CTRL_TRIG dispara o bloco
+    dma_channel_config cc = dma_channel_get_default_config(audio_dma_controle);
+    channel_config_set_transfer_data_size(&cc, DMA_SIZE_32);
+    channel_config_set_read_increment(&cc, true);
+    channel_config_set_write_increment(&cc, true);
+    channel_config_set_ring(&cc, true, 4);  // 16 bytes
+    dma_channel_configure(audio_dma_controle, &cc,
+                          &dma_hw->ch[audio_dma_dados].read_addr,
+                          NULL, 4, false);
+
+    dma_channel_set_irq0_enabled(audio_dma_dados, true);
+    irq_add_shared_handler(DMA_IRQ_0, audio_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+}
+
+bool audio_tocar(const audio_som_t *som) {
+    uint32_t estado = save_and_disable_interrupts();
+    if ((uint8_t)(audio_fila_cabeca - audio_fila_cauda) == AUDIO_FILA) {
+        restore_interrupts(estado);
+        return false;
+    }
+    audio_fila[audio_fila_cabeca++ & (AUDIO_FILA - 1)] = som;
+    if (!audio_ativo)
+        audio_proximo();
+    restore_interrupts(estado);
+    return true;
+}
+
+void audio_parar(void) {
+    uint32_t estado = save_and_disable_interrupts();
+    audio_fila_cauda = audio_fila_cabeca;
+
+    // O abort pode sinalizar a IRQ do canal (errata RP2040-E13): desabilita
+    // a IRQ durante o abort e limpa o que tiver ficado pendente
+    dma_channel_set_irq0_enabled(audio_dma_dados, false);
+    dma_channel_abort(audio_dma_controle);
+    dma_channel_abort(audio_dma_dados);
+    dma_channel_acknowledge_irq0(audio_dma_dados);
+    dma_channel_set_irq0_enabled(audio_dma_dados, true);
+
+    pwm_hw->slice[audio_fatia].cc = 0;
+    audio_ativo = false;
+    restore_interrupts(estado);
+}
+
+bool audio_tocando(void) {
+    return audio_ativo;
+}
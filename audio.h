@@ -0,0 +1,63 @@
+// audio.h - Motor de audio do buzzer por PWM + DMA, sem bloquear a CPU
+//
+// Um som e uma sequencia de notas (frequencia, duracao, volume) ou um bloco
+// de amostras PCM. Ao iniciar um som o motor monta uma lista de blocos de
+// controle e entrega tudo ao DMA:
+//   - cada nota vira um bloco que grava DIV/CTR/CC/TOP da fatia PWM do
+//     buzzer e um bloco de espera, paceado por um temporizador do DMA, que
+//     apenas segura a nota pela duracao pedida;
+//   - PCM vira um bloco que grava cada amostra no CC da fatia no ritmo da
+//     taxa de amostragem (portadora PWM de ~488 kHz, 8 bits);
+//   - o ultimo bloco silencia o buzzer e gera a IRQ que inicia o proximo
+//     som da fila.
+// Um canal de controle carrega cada bloco (4 palavras: READ_ADDR,
+// WRITE_ADDR, TRANS_COUNT, CTRL_TRIG) no canal de dados, como em
+// ssd1306.c. A CPU so participa no inicio de cada som.
+
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "afinacao.h"
+
+#define AUDIO_MAX_NOTAS     80      // notas por som
+#define AUDIO_FILA          4       // sons aguardando (potencia de 2)
+#define AUDIO_VOLUME_MAX    255
+
+// Amostras PCM: niveis de 0 a AUDIO_PCM_TOPO (silencio em 0)
+#define AUDIO_PCM_TOPO      255
+
+// A altura ja vem como par DIV/TOP (afinacao_nota(), afinacao_hz() ou a
+// tabela), para que tocar uma nota nao exija conta nenhuma
+typedef struct {
+    afinacao_pwm_t tom;         // AFINACAO_PAUSA = silencio
+    uint16_t duracao_ms;
+    uint8_t volume;             // 0..AUDIO_VOLUME_MAX (255 = duty de 50%)
+} audio_nota_t;
+
+typedef struct {
+    // Sequencia de notas...
+    const audio_nota_t *notas;
+    uint16_t n_notas;
+    // ...ou PCM (usado se pcm != NULL)
+    const uint16_t *pcm;
+    uint32_t n_pcm;
+    uint32_t taxa_hz;
+} audio_som_t;
+
+// Configura o pino do buzzer como PWM e reserva os canais/temporizador do
+// DMA. A IRQ de fim de som (DMA_IRQ_0) fica no nucleo que chama.
+void audio_init(uint8_t pino);
+
+// Poe o som na fila e retorna imediatamente; false se a fila estiver cheia.
+// O audio_som_t e as notas precisam continuar validos ate o som comecar;
+// as amostras PCM, ate ele terminar.
+bool audio_tocar(const audio_som_t *som);
+
+// Interrompe o som atual, esvazia a fila e silencia o buzzer
+void audio_parar(void);
+
+bool audio_tocando(void);
+
+#endif // AUDIO_H
@@ -0,0 +1,221 @@
+// botoes.c - Botoes por interrupcao de borda, com debounce e classificacao
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "fila_spsc.h"
+#include "botoes.h"
+
+#define BOTOES_FILA_BORDAS  32      // potencia de 2
+#define BOTOES_FILA_EVENTOS 16      // potencia de 2
+
+// Item da fila de bordas: instante em us com os 8 bits baixos trocados pelo
+// indice do botao (bits 1-3) e o nivel (bit 0); resolucao de 256 us
+#define BORDA_NIVEL         0x01u
+#define BORDA_BOTAO(item)   (((item) >> 1) & 0x7u)
+#define BORDA_TEMPO(item)   ((item) & ~0xFFu)
+
+typedef struct {
+    uint8_t pino;
+    bool pressionado;           // estado filtrado
+    bool segurando;             // SEGURANDO ja emitido neste toque
+    bool clique_pendente;       // primeiro clique aguardando o segundo
+    uint32_t borda_us;          // ultima borda aceita
+    uint32_t pressionado_us;
+    uint32_t longo_us;          // limiar do toque longo
+    uint32_t duplo_janela_us;
+    uint32_t clique_pendente_ms;
+} botao_t;
+
+static botao_t botoes[BOTOES_MAX];
+static uint8_t n_botoes;
+static void (*botoes_callback_borda)(uint8_t botao, bool nivel);
+
+// Entrada simulada (botoes_simular()): nivel de cada botao, bit = indice
+static volatile bool simulando;
+static volatile uint8_t niveis_simulados;
+
+static uint32_t bordas_itens[BOTOES_FILA_BORDAS];
+static fila_spsc_t bordas;
+
+static botao_evento_t eventos[BOTOES_FILA_EVENTOS];
+static uint8_t eventos_cabeca, eventos_cauda;
+
+static void botoes_registrar_borda(uint8_t i, bool nivel) {
+    // Fila cheia: a borda se perde, mas a conferencia do nivel ao fim do
+    // bloqueio corrige o estado
+    fila_spsc_push(&bordas, BORDA_TEMPO(time_us_32()) | ((uint32_t)i << 1) | (nivel ? BORDA_NIVEL : 0));
+    if (botoes_callback_borda)
+        botoes_callback_borda(i, nivel);
+}
+
+static bool botoes_nivel(const botao_t *b, uint8_t i) {
+    return simulando ? (niveis_simulados >> i) & 1 : gpio_get(b->pino);
+}
+
+static void botoes_gpio_irq(uint gpio, uint32_t eventos_irq) {
+    if (simulando)
+        return;
+    for (uint8_t i = 0; i < n_botoes; i++) {
+        if (botoes[i].pino != gpio)
+            continue;
+        bool nivel;
+        if ((eventos_irq & GPIO_IRQ_EDGE_RISE) && (eventos_irq & GPIO_IRQ_EDGE_FALL))
+            nivel = gpio_get(gpio);  // as duas bordas juntas: vale o nivel atual
+        else
+            nivel = eventos_irq & GPIO_IRQ_EDGE_RISE;
+        botoes_registrar_borda(i, nivel);
+        return;
+    }
+}
+
+void botoes_init(const uint8_t *pinos, uint8_t n) {
+    if (n > BOTOES_MAX)
+        n = BOTOES_MAX;
+    fila_spsc_init(&bordas, bordas_itens, BOTOES_FILA_BORDAS);
+    uint32_t agora = time_us_32();
+    for (uint8_t i = 0; i < n; i++) {
+        botao_t *b = &botoes[i];
+        b->pino = pinos[i];
+        gpio_init(b->pino);
+        gpio_set_dir(b->pino, GPIO_IN);
+        gpio_pull_up(b->pino);
+        b->pressionado = false;
+        b->segurando = false;
+        b->clique_pendente = false;
+        b->borda_us = agora;
+        b->duplo_janela_us = 0;
+        b->longo_us = BOTOES_LONGO_MS * 1000u;
+    }
+    n_botoes = n;
+    for (uint8_t i = 0; i < n; i++)
+        gpio_set_irq_enabled_with_callback(pinos[i], GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, botoes_gpio_irq);
+}
+
+void botoes_set_duplo_clique(uint8_t botao, uint32_t janela_ms) {
+    if (botao < n_botoes)
+        botoes[botao].duplo_janela_us = janela_ms * 1000;
+}
+
+void botoes_set_longo(uint8_t botao, uint32_t limiar_ms) {
+    if (botao < n_botoes)
+        botoes[botao].longo_us = limiar_ms * 1000;
+}
+
+void botoes_set_callback_borda(void (*callback)(uint8_t botao, bool nivel)) {
+    botoes_callback_borda = callback;
+}
+
+void botoes_simular(bool ligado, uint8_t niveis) {
+    niveis_simulados = niveis;
+    simulando = ligado;
+}
+
+void botoes_simular_borda(uint8_t botao, bool nivel) {
+    if (!simulando || botao >= n_botoes)
+        return;
+    uint8_t bit = 1u << botao;
+    niveis_simulados = nivel ? niveis_simulados | bit : niveis_simulados & ~bit;
+    botoes_registrar_borda(botao, nivel);
+}
+
+static void botoes_emitir(uint8_t botao, botao_evento_tipo_t tipo, uint32_t duracao_ms) {
+    // Sem espaco, descarta o evento mais antigo: o consumidor esta atrasado
+    // e o estado atual importa mais
+    if ((uint8_t)(eventos_cabeca - eventos_cauda) == BOTOES_FILA_EVENTOS)
+        eventos_cauda++;
+    botao_evento_t *ev = &eventos[eventos_cabeca & (BOTOES_FILA_EVENTOS - 1)];
+    ev->botao = botao;
+    ev->tipo = (uint8_t)tipo;
+    ev->duracao_ms = duracao_ms;
+    eventos_cabeca++;
+}
+
+// Transicao aceita pelo debounce, no instante t_us
+static void botoes_transicao(uint8_t i, bool pressionado, uint32_t t_us) {
+    botao_t *b = &botoes[i];
+    b->pressionado = pressionado;
+    b->borda_us = t_us;
+
+    if (pressionado) {
+        b->pressionado_us = t_us;
+        b->segurando = false;
+        botoes_emitir(i, BOTAO_PRESSIONADO, 0);
+        return;
+    }
+
+    uint32_t duracao_us = t_us - b->pressionado_us;
+    uint32_t duracao_ms = duracao_us / 1000;
+    botoes_emitir(i, BOTAO_SOLTO, duracao_ms);
+    if (duracao_us >= b->longo_us) {
+        if (b->clique_pendente) {
+            b->clique_pendente = false;
+            botoes_emitir(i, BOTAO_CLIQUE, b->clique_pendente_ms);
+        }
+        botoes_emitir(i, BOTAO_CLIQUE_LONGO, duracao_ms);
+    } else if (b->duplo_janela_us == 0) {
+        botoes_emitir(i, BOTAO_CLIQUE, duracao_ms);
+    } else if (b->clique_pendente) {
+        b->clique_pendente = false;
+        botoes_emitir(i, BOTAO_DUPLO_CLIQUE, duracao_ms);
+    } else {
+        b->clique_pendente = true;
+        b->clique_pendente_ms = duracao_ms;
+    }
+}
+
+void botoes_tarefa(void) {
+    uint32_t item;
+    while (fila_spsc_pop(&bordas, &item)) {
+        uint8_t i = BORDA_BOTAO(item);
+        if (i >= n_botoes)
+            continue;
+        uint32_t t = BORDA_TEMPO(item);
+        bool pressionado = !(item & BORDA_NIVEL);  // ativo em nivel baixo
+        botao_t *b = &botoes[i];
+        // Repique dentro do bloqueio ou borda repetida: ignora
+        if ((int32_t)(t - b->borda_us) < BOTOES_BLOQUEIO_US || pressionado == b->pressionado)
+            continue;
+        botoes_transicao(i, pressionado, t);
+    }
+
+    uint32_t agora = time_us_32();
+    for (uint8_t i = 0; i < n_botoes; i++) {
+        botao_t *b = &botoes[i];
+        // Fim do bloqueio: confere o nivel real (ultima borda do repique)
+        if (agora - b->borda_us >= BOTOES_BLOQUEIO_US) {
+            bool pressionado = !botoes_nivel(b, i);
+            if (pressionado != b->pressionado)
+                botoes_transicao(i, pressionado, agora);
+        }
+
+        if (b->pressionado && !b->segurando &&
+            agora - b->pressionado_us >= b->longo_us) {
+            b->segurando = true;
+            // Clique seguido de toque longo: o clique sai antes, na ordem
+            if (b->clique_pendente) {
+                b->clique_pendente = false;
+                botoes_emitir(i, BOTAO_CLIQUE, b->clique_pendente_ms);
+            }
+            botoes_emitir(i, BOTAO_SEGURANDO, b->longo_us / 1000);
+        }
+
+        // Janela do duplo clique expirou sem segundo toque
+        if (b->clique_pendente && !b->pressionado &&
+            agora - b->borda_us >= b->duplo_janela_us) {
+            b->clique_pendente = false;
+            botoes_emitir(i, BOTAO_CLIQUE, b->clique_pendente_ms);
+        }
+    }
+}
+
+bool botoes_ler_evento(botao_evento_t *ev) {
+    if (eventos_cabeca == eventos_cauda)
+        return false;
+    *ev = eventos[eventos_cauda & (BOTOES_FILA_EVENTOS - 1)];
+    eventos_cauda++;
+    return true;
+}
+
+bool botoes_pressionado(uint8_t botao) {
+    return botao < n_botoes && botoes[botao].pressionado;
+}
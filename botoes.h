@@ -0,0 +1,75 @@
+// botoes.h - Botoes por interrupcao de borda, com debounce e classificacao
+//
+// A IRQ de GPIO apenas registra cada borda (botao, nivel e instante) numa
+// fila; botoes_tarefa() consome as bordas fora da interrupcao, filtra os
+// repiques e transforma pressionar/soltar em eventos de alto nivel:
+//   PRESSIONADO / SOLTO   assim que a borda e aceita;
+//   SEGURANDO             uma vez, quando o botao passa do limiar de toque
+//                         longo (BOTOES_LONGO_MS, ou botoes_set_longo());
+//   CLIQUE                soltou antes do limiar (se o duplo clique estiver
+//                         habilitado, so depois de a janela expirar, ou
+//                         logo antes do SEGURANDO de um segundo toque);
+//   CLIQUE_LONGO          soltou depois do limiar;
+//   DUPLO_CLIQUE          segundo clique dentro da janela configurada.
+// O debounce aceita a primeira borda na hora (sem atraso) e ignora as
+// seguintes por BOTOES_BLOQUEIO_US; ao fim do bloqueio o nivel real do pino
+// e conferido, para nao perder a ultima borda de um repique.
+// Botoes ativos em nivel baixo, com pull-up.
+
+#ifndef BOTOES_H
+#define BOTOES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BOTOES_MAX          4
+#define BOTOES_BLOQUEIO_US  20000
+#define BOTOES_LONGO_MS     1000    // limiar padrao do toque longo
+
+typedef enum {
+    BOTAO_PRESSIONADO,
+    BOTAO_SOLTO,
+    BOTAO_SEGURANDO,
+    BOTAO_CLIQUE,
+    BOTAO_CLIQUE_LONGO,
+    BOTAO_DUPLO_CLIQUE,
+} botao_evento_tipo_t;
+
+typedef struct {
+    uint8_t botao;              // indice na ordem de botoes_init()
+    uint8_t tipo;               // botao_evento_tipo_t
+    uint32_t duracao_ms;        // tempo pressionado (SOLTO e cliques)
+} botao_evento_t;
+
+// Configura os pinos (entrada com pull-up) e a IRQ de borda. A IRQ fica no
+// nucleo que chama, que deve ser o mesmo de botoes_tarefa().
+void botoes_init(const uint8_t *pinos, uint8_t n);
+
+// Janela de duplo clique de um botao; 0 (padrao) desabilita e o CLIQUE sai
+// imediatamente ao soltar
+void botoes_set_duplo_clique(uint8_t botao, uint32_t janela_ms);
+
+// Limiar do toque longo de um botao (SEGURANDO e CLIQUE_LONGO)
+void botoes_set_longo(uint8_t botao, uint32_t limiar_ms);
+
+// Funcao chamada na IRQ de GPIO a cada borda registrada, com o botao e o
+// nivel do pino, para o chamador antecipar botoes_tarefa() (por exemplo com
+// o escalonador em ritmo lento) ou gravar a borda (traco.h)
+void botoes_set_callback_borda(void (*callback)(uint8_t botao, bool nivel));
+
+// Entrada simulada, para reproduzir um traco: ligada, os pinos e a IRQ sao
+// ignorados e o nivel de cada botao e o de niveis (bit = indice) ate
+// botoes_simular_borda() muda-lo. A borda simulada segue o caminho da IRQ,
+// callback incluido; chamar do nucleo de botoes_tarefa().
+void botoes_simular(bool ligado, uint8_t niveis);
+void botoes_simular_borda(uint8_t botao, bool nivel);
+
+// Processa as bordas pendentes e os temporizadores; chamar periodicamente
+void botoes_tarefa(void);
+
+bool botoes_ler_evento(botao_evento_t *ev);
+
+// Estado ja filtrado do botao
+bool botoes_pressionado(uint8_t botao);
+
+#endif // BOTOES_H
@@ -0,0 +1,93 @@
+// cdc_controle.c - Porta serial USB (CDC) de controle e telemetria
+
+#include "pico/stdlib.h"
+#include "pico/stdio/driver.h"
+#include "tusb.h"
+#include "fila_spsc.h"
+#include "cdc_controle.h"
+
+// Filas de um byte por item: a fila SPSC trabalha com palavras, e o volume
+// (uma linha de relatorio a cada poucos ms) nao justifica empacotar
+static uint32_t saida_itens[CDC_CONTROLE_FILA_SAIDA];
+static uint32_t entrada_itens[CDC_CONTROLE_FILA_ENTRADA];
+static fila_spsc_t saida;       // nucleo 0 -> nucleo 1
+static fila_spsc_t entrada;     // nucleo 1 -> nucleo 0
+
+// Cada contador e escrito por um nucleo so
+static cdc_controle_stats_t stats;
+
+// =====================
+// Driver de stdio (nucleo 0)
+// =====================
+static void cdc_controle_out_chars(const char *buf, int len) {
+    for (int i = 0; i < len; i++) {
+        if (!fila_spsc_push(&saida, (uint8_t)buf[i])) {
+            stats.bytes_perdidos += len - i;
+            return;
+        }
+    }
+}
+
+static int cdc_controle_in_chars(char *buf, int len) {
+    int n = 0;
+    uint32_t item;
+    while (n < len && fila_spsc_pop(&entrada, &item))
+        buf[n++] = (char)item;
+    return n ? n : PICO_ERROR_NO_DATA;
+}
+
+static stdio_driver_t cdc_controle_stdio = {
+    .out_chars = cdc_controle_out_chars,
+    .in_chars = cdc_controle_in_chars,
+#if PICO_STDIO_ENABLE_CRLF_SUPPORT
+    .crlf_enabled = PICO_STDIO_DEFAULT_CRLF,
+#endif
+};
+
+void cdc_controle_init(void) {
+    fila_spsc_init(&saida, saida_itens, CDC_CONTROLE_FILA_SAIDA);
+    fila_spsc_init(&entrada, entrada_itens, CDC_CONTROLE_FILA_ENTRADA);
+    stdio_set_driver_enabled(&cdc_controle_stdio, true);
+}
+
+// =====================
+// Ponte com a interface CDC (nucleo 1)
+// =====================
+void cdc_controle_tarefa(void) {
+    uint32_t item;
+    if (!tud_cdc_connected()) {
+        while (fila_spsc_pop(&saida, &item))
+            stats.bytes_descartados++;
+        return;
+    }
+
+    // Saida: so o que cabe no buffer do TinyUSB, o resto fica para o
+    // proximo passo
+    uint8_t bloco[64];
+    uint32_t livre = tud_cdc_write_available();
+    while (livre) {
+        uint32_t n = 0;
+        while (n < sizeof(bloco) && n < livre && fila_spsc_pop(&saida, &item))
+            bloco[n++] = (uint8_t)item;
+        if (!n)
+            break;
+        tud_cdc_write(bloco, n);
+        stats.bytes_enviados += n;
+        livre -= n;
+    }
+    tud_cdc_write_flush();
+
+    // Entrada: o que nao couber na fila espera no buffer do TinyUSB
+    uint32_t espaco = CDC_CONTROLE_FILA_ENTRADA - (entrada.cabeca - entrada.cauda);
+    if (espaco && tud_cdc_available()) {
+        uint8_t recebidos[CDC_CONTROLE_FILA_ENTRADA];
+        uint32_t n = tud_cdc_read(recebidos, espaco);
+        for (uint32_t i = 0; i < n; i++)
+            fila_spsc_push(&entrada, recebidos[i]);
+        stats.bytes_recebidos += n;
+    }
+}
+
+void cdc_controle_get_stats(cdc_controle_stats_t *s) {
+    *s = stats;
+}
@@ -0,0 +1,40 @@
+// cdc_controle.h - Porta serial USB (CDC) de controle e telemetria
+//
+// A stdio do SDK pela USB (pico_stdio_usb) nao serve aqui: ela traz
+// descritores proprios e roda o TinyUSB por conta propria. Em vez dela,
+// este modulo registra um driver de stdio que apenas troca bytes com o
+// nucleo 1 por duas filas SPSC; la, cdc_controle_tarefa() as liga a
+// interface CDC do dispositivo composto. Assim printf()/getchar_timeout_us()
+// do nucleo 0 (relatorio de perfil, comandos) valem ao mesmo tempo pela
+// UART e pela porta serial USB, sem que o nucleo 0 toque no TinyUSB.
+//
+// Sem terminal aberto (DTR baixo) a saida e descartada, para que a
+// telemetria antiga nao se acumule; com a fila de saida cheia, os bytes
+// excedentes se perdem e sao contados.
+
+#ifndef CDC_CONTROLE_H
+#define CDC_CONTROLE_H
+
+#include <stdint.h>
+
+#define CDC_CONTROLE_FILA_SAIDA     1024    // bytes (potencia de 2)
+#define CDC_CONTROLE_FILA_ENTRADA   64      // bytes (potencia de 2)
+
+typedef struct {
+    uint32_t bytes_enviados;
+    uint32_t bytes_recebidos;
+    uint32_t bytes_perdidos;        // fila de saida cheia
+    uint32_t bytes_descartados;     // saida sem terminal aberto
+} cdc_controle_stats_t;
+
+// Cria as filas e registra o driver de stdio; chamar no nucleo 0 antes de
+// lancar o nucleo 1
+void cdc_controle_init(void);
+
+// Nucleo 1, depois de tud_task(): esvazia a fila de saida na interface CDC
+// e traz o que o host enviou
+void cdc_controle_tarefa(void);
+
+void cdc_controle_get_stats(cdc_controle_stats_t *stats);
+
+#endif // CDC_CONTROLE_H
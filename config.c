@@ -0,0 +1,359 @@
+// config.c - Configuracao ajustavel em tempo de execucao, guardada na flash
+
+#include <stddef.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "vad.h"
+#include "botoes.h"
+#include "energia.h"
+#include "config.h"
+
+// Dois ultimos setores da flash, longe do programa
+#define CONFIG_SETORES          2
+#define CONFIG_FLASH_OFFSET     (PICO_FLASH_SIZE_BYTES - CONFIG_SETORES * FLASH_SECTOR_SIZE)
+#define CONFIG_PAGINAS_SETOR    (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+#define CONFIG_PAGINAS          (CONFIG_SETORES * CONFIG_PAGINAS_SETOR)
+#define CONFIG_SEM_PAGINA       0xFF
+
+#define CONFIG_MAGICA           0x43525048u     // "HPRC"
+#define CONFIG_FLASH_TIMEOUT_MS 100
+
+#define CONFIG_ROLAGEM_PADRAO   2               // ~25 cliques/s na deflexao total
+#define CONFIG_MEDIA_PADRAO     16              // 1 ms de amostras a 16 kHz
+
+// Registro numa pagina da flash; o CRC cobre o cabecalho (com o proprio
+// campo zerado) e os 'tamanho' bytes da configuracao
+typedef struct {
+    uint32_t magica;
+    uint32_t sequencia;
+    uint32_t crc;
+    uint16_t versao;
+    uint16_t tamanho;
+    config_t config;
+} config_registro_t;
+
+_Static_assert(sizeof(config_registro_t) <= FLASH_PAGE_SIZE, "registro maior que uma pagina da flash");
+_Static_assert(CONFIG_PAGINAS < CONFIG_SEM_PAGINA, "paginas demais para o indice");
+
+// Limites de cada campo do protocolo; a curva tem tratamento proprio
+typedef struct {
+    uint8_t campo;
+    uint8_t offset;
+    uint8_t tamanho;
+    uint32_t min, max;
+} config_campo_desc_t;
+
+#define CONFIG_DESC(id, membro, min, max) \
+    { id, offsetof(config_t, membro), sizeof(((config_t *)0)->membro), min, max }
+
+static const config_campo_desc_t config_campos[] = {
+    CONFIG_DESC(CONFIG_JOY_ZONA_MORTA, joy_zona_morta, 0, 1500),
+    CONFIG_DESC(CONFIG_JOY_RAIO_MAX, joy_raio_max, 200, 2900),
+    CONFIG_DESC(CONFIG_JOY_ROLAGEM_FATOR, joy_rolagem_fator, 0, 120),
+    CONFIG_DESC(CONFIG_BOTAO_LONGO_MS, botao_longo_ms, 200, 5000),
+    CONFIG_DESC(CONFIG_VAD_ATAQUE, vad_ataque, 1, 50),
+    CONFIG_DESC(CONFIG_VAD_ESPERA, vad_espera, 1, 250),
+    CONFIG_DESC(CONFIG_VAD_FATOR_RUIDO, vad_fator_ruido, 1, 64),
+    CONFIG_DESC(CONFIG_VAD_ENERGIA_MIN, vad_energia_min, 0, 1000000),
+    CONFIG_DESC(CONFIG_JOY_FILTRO, joy_filtro, JOYSTICK_FILTRO_NENHUM, JOYSTICK_FILTRO_ONE_EURO),
+    CONFIG_DESC(CONFIG_JOY_MEDIA_QUADROS, joy_media_quadros, 1, 128),
+    CONFIG_DESC(CONFIG_JOY_FC_MIN, joy_fc_min_q4, 1, 100 * 16),
+    CONFIG_DESC(CONFIG_JOY_BETA, joy_beta_q4, 0, 1024),
+    CONFIG_DESC(CONFIG_JOY_FC_DERIVADA, joy_fc_derivada_q4, 1, 100 * 16),
+    CONFIG_DESC(CONFIG_ENERGIA_ESCURECER_S, energia_escurecer_s, 0, 3600),
+    CONFIG_DESC(CONFIG_ENERGIA_DESLIGAR_S, energia_desligar_s, 0, 3600),
+};
+
+#define CONFIG_CURVA_MAX        4096            // 16 px/ms
+
+// Configuracao publicada para o nucleo 1: geracao impar = escrita em curso
+static config_t config_atual;
+static volatile uint32_t config_geracao;
+
+static uint8_t config_pagina = CONFIG_SEM_PAGINA;
+static uint32_t config_sequencia;
+static uint32_t config_gravacoes;
+
+// Pagina montada para gravar (precisa estar na RAM durante a gravacao)
+static uint8_t config_buffer[FLASH_PAGE_SIZE];
+
+void config_padrao(config_t *c) {
+    joystick_t j;
+    vad_t v;
+    energia_t e;
+    joystick_init(&j);
+    vad_init(&v);
+    energia_init(&e, 0);
+    memset(c, 0, sizeof(*c));
+    c->joy_zona_morta = j.zona_morta;
+    c->joy_raio_max = j.raio_max;
+    memcpy(c->joy_curva, j.curva, sizeof(c->joy_curva));
+    c->joy_rolagem_fator = CONFIG_ROLAGEM_PADRAO;
+    c->botao_longo_ms = BOTOES_LONGO_MS;
+    c->vad_ataque = v.quadros_ataque;
+    c->vad_espera = v.quadros_espera;
+    c->vad_fator_ruido = v.fator_ruido;
+    c->vad_energia_min = v.energia_min;
+    c->joy_filtro = j.filtro;
+    c->joy_media_quadros = CONFIG_MEDIA_PADRAO;
+    c->joy_fc_min_q4 = j.fc_min_q4;
+    c->joy_beta_q4 = j.beta_q4;
+    c->joy_fc_derivada_q4 = j.fc_derivada_q4;
+    c->energia_escurecer_s = (uint16_t)(e.escurecer_ms / 1000);
+    c->energia_desligar_s = (uint16_t)(e.desligar_ms / 1000);
+}
+
+// Seqlock: so o nucleo 0 escreve
+static void config_publicar(const config_t *c) {
+    config_geracao++;
+    __dmb();
+    config_atual = *c;
+    __dmb();
+    config_geracao++;
+}
+
+bool config_ler(uint32_t *geracao, config_t *c) {
+    uint32_t g = config_geracao;
+    if (g == *geracao || (g & 1))
+        return false;
+    __dmb();
+    *c = config_atual;
+    __dmb();
+    if (config_geracao != g)
+        return false;  // mudou durante a copia: fica para a proxima chamada
+    *geracao = g;
+    return true;
+}
+
+// =====================
+// Flash
+// =====================
+// CRC-32 (IEEE) bit a bit: o registro tem poucas dezenas de bytes
+static uint32_t config_crc32(uint32_t crc, const uint8_t *p, uint32_t n) {
+    crc = ~crc;
+    while (n--) {
+        crc ^= *p++;
+        for (int i = 0; i < 8; i++)
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+    }
+    return ~crc;
+}
+
+static uint32_t config_crc_registro(const config_registro_t *r) {
+    config_registro_t cabecalho = *r;
+    cabecalho.crc = 0;
+    uint32_t crc = config_crc32(0, (const uint8_t *)&cabecalho, offsetof(config_registro_t, config));
+    return config_crc32(crc, (const uint8_t *)&r->config, r->tamanho);
+}
+
+static const config_registro_t *config_flash_pagina(uint8_t pagina) {
+    return (const config_registro_t *)(uintptr_t)(XIP_BASE + CONFIG_FLASH_OFFSET + (uint32_t)pagina * FLASH_PAGE_SIZE);
+}
+
+static bool config_registro_valido(const config_registro_t *r) {
+    return r->magica == CONFIG_MAGICA && r->versao == CONFIG_VERSAO &&
+           r->tamanho <= sizeof(config_t) && config_crc_registro(r) == r->crc;
+}
+
+static bool config_pagina_apagada(uint8_t pagina) {
+    const uint32_t *p = (const uint32_t *)config_flash_pagina(pagina);
+    for (uint32_t i = 0; i < FLASH_PAGE_SIZE / 4; i++)
+        if (p[i] != 0xFFFFFFFFu)
+            return false;
+    return true;
+}
+
+void config_init(void) {
+    config_t c;
+    config_padrao(&c);
+
+    // Registro valido de sequencia mais alta
+    config_pagina = CONFIG_SEM_PAGINA;
+    config_sequencia = 0;
+    for (uint8_t i = 0; i < CONFIG_PAGINAS; i++) {
+        const config_registro_t *r = config_flash_pagina(i);
+        if (!config_registro_valido(r))
+            continue;
+        if (config_pagina == CONFIG_SEM_PAGINA || (int32_t)(r->sequencia - config_sequencia) > 0) {
+            config_pagina = i;
+            config_sequencia = r->sequencia;
+        }
+    }
+    if (config_pagina != CONFIG_SEM_PAGINA) {
+        // Registro mais curto (firmware anterior): o resto fica no padrao
+        const config_registro_t *r = config_flash_pagina(config_pagina);
+        memcpy(&c, &r->config, r->tamanho);
+    }
+    config_geracao = 0;
+    config_publicar(&c);
+}
+
+typedef struct {
+    uint32_t setor;                     // offset a apagar, ou UINT32_MAX
+    uint32_t pagina;                    // offset a programar
+} config_gravacao_t;
+
+// Roda com as interrupcoes desligadas e o outro nucleo parado
+static void config_flash_gravar(void *param) {
+    const config_gravacao_t *g = param;
+    if (g->setor != UINT32_MAX)
+        flash_range_erase(g->setor, FLASH_SECTOR_SIZE);
+    flash_range_program(g->pagina, config_buffer, FLASH_PAGE_SIZE);
+}
+
+static config_status_t config_salvar(void) {
+    // Proxima pagina depois do registro atual; se ela nao estiver limpa (uma
+    // gravacao interrompida, por exemplo), pula para o proximo setor
+    uint8_t pagina = config_pagina == CONFIG_SEM_PAGINA ? 0 : (config_pagina + 1) % CONFIG_PAGINAS;
+    bool apagar = pagina % CONFIG_PAGINAS_SETOR == 0;
+    if (!apagar && !config_pagina_apagada(pagina)) {
+        pagina = (pagina / CONFIG_PAGINAS_SETOR + 1) % CONFIG_SETORES * CONFIG_PAGINAS_SETOR;
+        apagar = true;
+    }
+    // Sem registro nenhum a preservar, o setor de destino so e apagado se
+    // precisar
+    if (apagar && config_pagina == CONFIG_SEM_PAGINA && config_pagina_apagada(pagina))
+        apagar = false;
+
+    config_registro_t *r = (config_registro_t *)config_buffer;
+    memset(config_buffer, 0xFF, sizeof(config_buffer));
+    r->magica = CONFIG_MAGICA;
+    r->sequencia = config_sequencia + 1;
+    r->versao = CONFIG_VERSAO;
+    r->tamanho = sizeof(config_t);
+    r->config = config_atual;
+    r->crc = config_crc_registro(r);
+
+    config_gravacao_t g = {
+        .setor = apagar ? CONFIG_FLASH_OFFSET + (uint32_t)(pagina / CONFIG_PAGINAS_SETOR) * FLASH_SECTOR_SIZE
+                        : UINT32_MAX,
+        .pagina = CONFIG_FLASH_OFFSET + (uint32_t)pagina * FLASH_PAGE_SIZE,
+    };
+    if (flash_safe_execute(config_flash_gravar, &g, CONFIG_FLASH_TIMEOUT_MS) != PICO_OK)
+        return CONFIG_ERRO_FLASH;
+
+    // Confere o que ficou na flash antes de adotar a pagina
+    const config_registro_t *gravado = config_flash_pagina(pagina);
+    if (!config_registro_valido(gravado) || gravado->sequencia != r->sequencia)
+        return CONFIG_ERRO_FLASH;
+    config_pagina = pagina;
+    config_sequencia = r->sequencia;
+    config_gravacoes++;
+    return CONFIG_OK;
+}
+
+// =====================
+// Protocolo
+// =====================
+// Localiza o campo; a curva vira um descritor montado na hora
+static bool config_campo(uint8_t campo, config_campo_desc_t *d) {
+    if (campo >= CONFIG_JOY_CURVA && campo < CONFIG_JOY_CURVA + JOYSTICK_CURVA_PONTOS) {
+        d->campo = campo;
+        d->offset = offsetof(config_t, joy_curva) + 2 * (campo - CONFIG_JOY_CURVA);
+        d->tamanho = 2;
+        d->min = 0;
+        d->max = CONFIG_CURVA_MAX;
+        return true;
+    }
+    for (uint32_t i = 0; i < sizeof(config_campos) / sizeof(config_campos[0]); i++) {
+        if (config_campos[i].campo == campo) {
+            *d = config_campos[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t config_campo_ler(const config_t *c, const config_campo_desc_t *d) {
+    const uint8_t *p = (const uint8_t *)c + d->offset;
+    switch (d->tamanho) {
+    case 1: return *p;
+    case 2: { uint16_t v; memcpy(&v, p, 2); return v; }
+    default: { uint32_t v; memcpy(&v, p, 4); return v; }
+    }
+}
+
+static void config_campo_escrever(config_t *c, const config_campo_desc_t *d, uint32_t v) {
+    uint8_t *p = (uint8_t *)c + d->offset;
+    switch (d->tamanho) {
+    case 1: *p = (uint8_t)v; break;
+    case 2: { uint16_t v16 = (uint16_t)v; memcpy(p, &v16, 2); break; }
+    default: memcpy(p, &v, 4); break;
+    }
+}
+
+static uint32_t config_u32_le(const uint8_t *p) {
+    return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+uint8_t config_executar(uint8_t cmd, const uint8_t *dados, uint8_t n, uint8_t *resposta) {
+    config_campo_desc_t d;
+    config_t c;
+
+    switch (cmd) {
+    case CONFIG_CMD_LER:
+        if (n != 1) {
+            resposta[0] = CONFIG_ERRO_FORMATO;
+            return 1;
+        }
+        if (!config_campo(dados[0], &d)) {
+            resposta[0] = CONFIG_ERRO_CAMPO;
+            return 1;
+        }
+        uint32_t v = config_campo_ler(&config_atual, &d);
+        resposta[0] = d.campo;
+        resposta[1] = (uint8_t)v;
+        resposta[2] = (uint8_t)(v >> 8);
+        resposta[3] = (uint8_t)(v >> 16);
+        resposta[4] = (uint8_t)(v >> 24);
+        return 5;
+
+    case CONFIG_CMD_ESCREVER:
+        if (n != 5) {
+            resposta[0] = CONFIG_ERRO_FORMATO;
+        } else if (!config_campo(dados[0], &d)) {
+            resposta[0] = CONFIG_ERRO_CAMPO;
+        } else {
+            uint32_t valor = config_u32_le(&dados[1]);
+            if (valor < d.min || valor > d.max) {
+                resposta[0] = CONFIG_ERRO_FAIXA;
+            } else {
+                c = config_atual;
+                config_campo_escrever(&c, &d, valor);
+                config_publicar(&c);
+                resposta[0] = CONFIG_OK;
+            }
+        }
+        return 1;
+
+    case CONFIG_CMD_SALVAR:
+        resposta[0] = n ? CONFIG_ERRO_FORMATO : config_salvar();
+        return 1;
+
+    case CONFIG_CMD_PADRAO:
+        if (n) {
+            resposta[0] = CONFIG_ERRO_FORMATO;
+            return 1;
+        }
+        config_padrao(&c);
+        config_publicar(&c);
+        resposta[0] = CONFIG_OK;
+        return 1;
+
+    case CONFIG_CMD_TUDO:
+        resposta[0] = (uint8_t)CONFIG_VERSAO;
+        resposta[1] = (uint8_t)(CONFIG_VERSAO >> 8);
+        memcpy(&resposta[2], &config_atual, sizeof(config_t));
+        return 2 + sizeof(config_t);
+    }
+    return 0;
+}
+
+void config_get_stats(config_stats_t *s) {
+    s->gravacoes = config_gravacoes;
+    s->sequencia = config_sequencia;
+    s->pagina = config_pagina;
+}
@@ -0,0 +1,129 @@
+// config.h - Configuracao ajustavel em tempo de execucao, guardada na flash
+//
+// Os parametros de ajuste fino (zona morta e curva do joystick, limiar do
+// toque longo, sensibilidade do VAD) ficam num config_t versionado. No boot
+// o registro mais recente e valido da flash e carregado na RAM; os modulos
+// copiam os valores para as proprias estruturas (joystick_t, vad_t, botoes)
+// e o caminho quente so le esses campos, sem consultar nada aqui.
+//
+// Persistencia com nivelamento de desgaste: os dois ultimos setores da
+// flash sao divididos em paginas de 256 bytes, e cada gravacao usa a pagina
+// seguinte a do registro mais recente, com numero de sequencia crescente e
+// CRC-32. Um setor so e apagado quando a gravacao chega nele, e o registro
+// valido mais recente esta sempre no outro: uma queda de energia no meio da
+// gravacao perde no maximo a alteracao em curso. Com 16 paginas por setor,
+// cada setor e apagado uma vez a cada 32 gravacoes.
+//
+// Versoes: campos novos so entram no fim do config_t. Um registro mais curto
+// (de um firmware anterior) e aceito, e os campos que ele nao tem ficam com
+// o valor padrao; CONFIG_VERSAO muda apenas se o significado de um campo
+// existente mudar, e entao os registros antigos sao ignorados.
+//
+// A configuracao e alterada no nucleo 0 (protocolo da porta serial) e lida
+// no nucleo 1: config_ler() usa um contador de geracao (seqlock) para nunca
+// entregar uma copia pela metade.
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "joystick.h"
+
+#define CONFIG_VERSAO           1
+
+typedef struct {
+    // Joystick (joystick.h)
+    uint16_t joy_zona_morta;            // raio em unidades do ADC
+    uint16_t joy_raio_max;
+    uint16_t joy_curva[JOYSTICK_CURVA_PONTOS];
+    uint16_t joy_rolagem_fator;         // unidades de roda por pixel no modo rolagem
+    // Botoes (botoes.h)
+    uint16_t botao_longo_ms;            // toque longo / clique direito do joystick
+    // Microfone (vad.h)
+    uint8_t vad_ataque;
+    uint8_t vad_espera;
+    uint8_t vad_fator_ruido;
+    uint8_t reservado;
+    uint32_t vad_energia_min;
+    // Filtro do joystick (joystick.h)
+    uint8_t joy_filtro;                 // joystick_filtro_t
+    uint8_t joy_media_quadros;          // amostras do ADC na media de cada leitura
+    uint16_t joy_fc_min_q4;
+    uint16_t joy_beta_q4;
+    uint16_t joy_fc_derivada_q4;
+    // Governador de ociosidade (energia.h), em segundos; 0 = nunca
+    uint16_t energia_escurecer_s;
+    uint16_t energia_desligar_s;
+} config_t;
+
+// Identificadores dos campos no protocolo (config_executar())
+typedef enum {
+    CONFIG_JOY_ZONA_MORTA = 0x01,
+    CONFIG_JOY_RAIO_MAX,
+    CONFIG_JOY_ROLAGEM_FATOR,
+    CONFIG_BOTAO_LONGO_MS,
+    CONFIG_VAD_ATAQUE,
+    CONFIG_VAD_ESPERA,
+    CONFIG_VAD_FATOR_RUIDO,
+    CONFIG_VAD_ENERGIA_MIN,
+    CONFIG_JOY_FILTRO,
+    CONFIG_JOY_MEDIA_QUADROS,
+    CONFIG_JOY_FC_MIN,
+    CONFIG_JOY_BETA,
+    CONFIG_JOY_FC_DERIVADA,
+    CONFIG_ENERGIA_ESCURECER_S,
+    CONFIG_ENERGIA_DESLIGAR_S,
+    CONFIG_JOY_CURVA = 0x20,            // 0x20 + ponto da curva
+} config_campo_t;
+
+// Protocolo binario: quadros do protocolo.h; a resposta usa o mesmo tipo
+// do comando.
+//   CONFIG_CMD_LER       [campo]              -> [campo, valor u32 LE] ou [status]
+//   CONFIG_CMD_ESCREVER  [campo, valor u32]   -> [status]
+//   CONFIG_CMD_SALVAR    []                   -> [status]
+//   CONFIG_CMD_PADRAO    []                   -> [status]   (so na RAM; SALVAR grava)
+//   CONFIG_CMD_TUDO      []                   -> [versao u16, config_t]
+#define CONFIG_CMD_LER          0x10
+#define CONFIG_CMD_ESCREVER     0x11
+#define CONFIG_CMD_SALVAR       0x12
+#define CONFIG_CMD_PADRAO       0x13
+#define CONFIG_CMD_TUDO         0x14
+
+typedef enum {
+    CONFIG_OK = 0,
+    CONFIG_ERRO_CAMPO,                  // campo desconhecido
+    CONFIG_ERRO_FAIXA,                  // valor fora dos limites do campo
+    CONFIG_ERRO_FORMATO,                // tamanho de comando invalido
+    CONFIG_ERRO_FLASH,                  // gravacao nao confirmada na leitura
+} config_status_t;
+
+// Maior resposta de config_executar()
+#define CONFIG_RESPOSTA_MAX     (2 + sizeof(config_t))
+
+// Valores padrao, tirados de joystick_init(), vad_init(), energia_init() e
+// botoes.h
+void config_padrao(config_t *c);
+
+// Carrega o registro mais recente da flash (ou os padroes). Nucleo 0, antes
+// de lancar o nucleo 1.
+void config_init(void);
+
+// Copia a configuracao atual se ela mudou desde *geracao (comece com 0 para
+// sempre receber a primeira); retorna false sem mudanca
+bool config_ler(uint32_t *geracao, config_t *c);
+
+// Executa um comando do protocolo. Retorna o tamanho da resposta, 0 se o
+// comando nao for de configuracao.
+uint8_t config_executar(uint8_t cmd, const uint8_t *dados, uint8_t n, uint8_t *resposta);
+
+// Gravacoes feitas desde o boot e sequencia do registro atual
+typedef struct {
+    uint32_t gravacoes;
+    uint32_t sequencia;
+    uint8_t pagina;                     // pagina do registro atual (0xFF = nenhum)
+} config_stats_t;
+
+void config_get_stats(config_stats_t *stats);
+
+#endif // CONFIG_H
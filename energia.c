@@ -0,0 +1,98 @@
+// energia.c - Governador de ociosidade: display, amostragem e relogio
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "energia.h"
+
+// clk_sys em OCIOSO: PLL_SYS / 2 (62,5 MHz com o padrao de 125 MHz). Por
+// cautela fica acima dos 48 MHz do clk_usb, com o USB ainda em servico.
+#define ENERGIA_DIVISOR_RELOGIO 2
+
+static uint32_t energia_pll_hz;  // frequencia do PLL_SYS (clk_sys normal)
+
+void energia_init(energia_t *e, uint32_t agora_us) {
+    e->escurecer_ms = 30000;
+    e->desligar_ms = 120000;
+    e->nivel = ENERGIA_ATIVO;
+    e->suspenso = false;
+    e->medindo = false;
+    e->atividade_us = agora_us;
+    e->gatilho_us = agora_us;
+    e->stats = (energia_stats_t){ 0 };
+}
+
+bool energia_atividade(energia_t *e, uint32_t t_us, bool borda) {
+    e->atividade_us = t_us;
+    if (e->suspenso)
+        return false;
+    if (e->nivel == ENERGIA_OCIOSO) {
+        e->stats.despertares++;
+        e->medindo = true;
+        e->gatilho_us = t_us;
+    } else if (borda && e->medindo) {
+        e->gatilho_us = t_us;
+    }
+    if (e->nivel == ENERGIA_ATIVO)
+        return false;
+    e->nivel = ENERGIA_ATIVO;
+    return true;
+}
+
+energia_nivel_t energia_atualizar(energia_t *e, uint32_t agora_us, bool usb_suspenso) {
+    if (usb_suspenso != e->suspenso) {
+        e->suspenso = usb_suspenso;
+        e->medindo = false;
+        e->atividade_us = agora_us;
+        e->nivel = usb_suspenso ? ENERGIA_OCIOSO : ENERGIA_ATIVO;
+        return (energia_nivel_t)e->nivel;
+    }
+
+    if (e->medindo && agora_us - e->gatilho_us > ENERGIA_JANELA_US) {
+        e->medindo = false;
+        e->stats.descartadas++;
+    }
+
+    // Daqui o nivel so desce; so a atividade o faz subir. Em OCIOSO nada
+    // mais e calculado, entao o contador de 32 bits pode dar a volta
+    // (71 min) sem efeito.
+    if (e->nivel == ENERGIA_OCIOSO)
+        return ENERGIA_OCIOSO;
+    uint32_t parado_ms = (agora_us - e->atividade_us) / 1000;
+    uint32_t desligar_ms = e->desligar_ms;
+    if (desligar_ms && desligar_ms < ENERGIA_DESLIGAR_MIN_MS)
+        desligar_ms = ENERGIA_DESLIGAR_MIN_MS;
+    if (desligar_ms && parado_ms >= desligar_ms)
+        e->nivel = ENERGIA_OCIOSO;
+    else if (e->escurecer_ms && parado_ms >= e->escurecer_ms)
+        e->nivel = ENERGIA_ESCURO;
+    return (energia_nivel_t)e->nivel;
+}
+
+void energia_relatorio(energia_t *e, uint32_t agora_us) {
+    if (!e->medindo)
+        return;
+    e->medindo = false;
+    uint32_t latencia = agora_us - e->gatilho_us;
+    e->stats.medidas++;
+    e->stats.latencia_ultima_us = latencia;
+    if (latencia > e->stats.latencia_max_us)
+        e->stats.latencia_max_us = latencia;
+    if (latencia > ENERGIA_LATENCIA_LIMITE_US)
+        e->stats.acima_limite++;
+}
+
+void energia_relogio_init(void) {
+    energia_pll_hz = clock_get_hz(clk_sys);
+    clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS,
+                    energia_pll_hz, energia_pll_hz);
+}
+
+// A troca do divisor do clk_sys e sem glitch e nao para o outro nucleo.
+// O SysTick conta ciclos do clk_sys e perfil.c converte pela frequencia do
+// momento do relatorio: passos medidos no outro nivel saem com a escala
+// errada por um fator ENERGIA_DIVISOR_RELOGIO.
+void energia_relogio(bool reduzido) {
+    uint32_t hz = reduzido ? energia_pll_hz / ENERGIA_DIVISOR_RELOGIO : energia_pll_hz;
+    clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX,
+                    CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS, energia_pll_hz, hz);
+}
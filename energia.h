@@ -0,0 +1,94 @@
+// energia.h - Governador de ociosidade: display, amostragem e relogio
+//
+// Sem uso do controle, o consumo desce em degraus:
+//   ATIVO    ritmo normal;
+//   ESCURO   depois de escurecer_ms sem atividade: contraste do OLED baixo;
+//   OCIOSO   depois de desligar_ms: OLED desligado, ADC e tarefas de
+//            entrada em ritmo lento e clk_sys dividido (energia_relogio()).
+// Atividade e o joystick fora da zona morta e qualquer borda dos botoes; voz
+// no microfone nao conta. Com o barramento USB suspenso pelo host o nivel
+// vai direto para OCIOSO, e a retomada conta como atividade.
+//
+// O modulo so decide o nivel e mede o despertar; quem aplica cada nivel e
+// o HPR.c, que conhece as tarefas e os perifericos.
+//
+// Latencia de despertar: do gatilho (a amostra do joystick que viu o
+// movimento ou a borda do botao) ate o primeiro relatorio HID depois de
+// sair de OCIOSO. Cada borda antes desse relatorio reinicia a medida, para
+// que um clique conte a partir da borda que o gerou (soltar) e nao do tempo
+// que o dedo ficou no botao. Sem relatorio em ENERGIA_JANELA_US a medida e
+// descartada (um toque sem efeito no computador). Despertares com o USB
+// suspenso dependem da retomada pelo host e nao sao medidos.
+
+#ifndef ENERGIA_H
+#define ENERGIA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Minimo de inatividade para OCIOSO. O relogio dividido tambem atrasa o PWM
+// e os temporizadores de DMA do audio; o som mais longo (5 s) ja terminou.
+#define ENERGIA_DESLIGAR_MIN_MS     10000
+
+// Limite da latencia de despertar: um quadro USB ate o SOF, mais um passo
+// da tarefa USB e folga para a retomada do relogio
+#define ENERGIA_LATENCIA_LIMITE_US  3000
+#define ENERGIA_JANELA_US           250000
+
+typedef enum {
+    ENERGIA_ATIVO,
+    ENERGIA_ESCURO,
+    ENERGIA_OCIOSO,
+} energia_nivel_t;
+
+typedef struct {
+    uint32_t despertares;       // saidas de OCIOSO por atividade
+    uint32_t medidas;           // despertares com relatorio dentro da janela
+    uint32_t descartadas;       // despertares sem relatorio dentro da janela
+    uint32_t acima_limite;      // medidas acima de ENERGIA_LATENCIA_LIMITE_US
+    uint32_t latencia_ultima_us;
+    uint32_t latencia_max_us;
+} energia_stats_t;
+
+typedef struct {
+    // Parametros (config.h); 0 = nunca
+    uint32_t escurecer_ms;
+    uint32_t desligar_ms;
+
+    // Estado
+    uint8_t nivel;              // energia_nivel_t
+    bool suspenso;              // barramento USB suspenso na ultima avaliacao
+    bool medindo;               // despertou e aguarda o primeiro relatorio
+    uint32_t atividade_us;      // instante da ultima atividade
+    uint32_t gatilho_us;        // inicio da medida de latencia
+
+    energia_stats_t stats;
+} energia_t;
+
+void energia_init(energia_t *e, uint32_t agora_us);
+
+// Atividade do usuario no instante t_us; borda = veio de um botao. Retorna
+// true se o nivel mudou: saindo de OCIOSO, o chamador deve restaurar o
+// ritmo normal antes de tratar a entrada. Com o USB suspenso o nivel nao
+// muda (o chamador pede a retomada ao host).
+bool energia_atividade(energia_t *e, uint32_t t_us, bool borda);
+
+// Avalia a inatividade e o estado do barramento; retorna o nivel atual
+energia_nivel_t energia_atualizar(energia_t *e, uint32_t agora_us, bool usb_suspenso);
+
+// Um relatorio HID saiu em agora_us: fecha a medida pendente
+void energia_relatorio(energia_t *e, uint32_t agora_us);
+
+static inline bool energia_medindo(const energia_t *e) {
+    return e->medindo;
+}
+
+// Relogio do sistema. energia_relogio_init() (uma vez, no boot, antes da
+// stdio) passa clk_peri a vir direto do PLL_SYS, para que a UART nao mude de
+// baud quando energia_relogio(true) divide o clk_sys. O I2C conta SCL no
+// clk_sys: i2c_fila.c ve a troca e refaz o divisor no nucleo 0, entre
+// transacoes; a que estiver em curso termina no SCL antigo.
+void energia_relogio_init(void);
+void energia_relogio(bool reduzido);
+
+#endif // ENERGIA_H
@@ -0,0 +1,606 @@
+// entrada.c - Caminho de entrada do nucleo 1: USB, joystick, botoes, microfone e energia
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "tusb.h"
+#include "fila_spsc.h"
+#include "adc_stream.h"
+#include "joystick.h"
+#include "hid_mouse.h"
+#include "hid_teclado.h"
+#include "cdc_controle.h"
+#include "botoes.h"
+#include "config.h"
+#include "microfone_usb.h"
+#include "quente.h"
+#include "entrada.h"
+
+#define JOY_DUPLO_CLIQUE_MS 250     // janela do duplo clique no botao do joystick
+
+// ADC: joystick X/Y (GP26/GP27) e microfone (GP28) capturados continuamente
+// em round-robin por DMA (adc_stream.c)
+#define ADC_TAXA_POR_CANAL_HZ 16000
+#define ADC_TAXA_OCIOSO_HZ    1000  // em OCIOSO (energia.h): so o joystick importa
+#define JOY_CALIB_QUADROS     256   // media de 16 ms em repouso para o centro
+#define JOY_MEDIA_OCIOSO      2     // quadros na media em OCIOSO (2 ms a 1 kHz)
+
+// Atalhos enviados ao computador pelo teclado USB (hid_teclado.c):
+// A = Win+Ctrl+Enter (liga/desliga o Narrador, leitor de tela do Windows)
+// B = Win+H (ditado por voz do Windows)
+#define ATALHO_A_MODIFICADORES (KEYBOARD_MODIFIER_LEFTGUI | KEYBOARD_MODIFIER_LEFTCTRL)
+#define ATALHO_A_TECLA         HID_KEY_ENTER
+#define ATALHO_B_MODIFICADORES KEYBOARD_MODIFIER_LEFTGUI
+#define ATALHO_B_TECLA         HID_KEY_H
+
+// Periodos das tarefas do escalonador (us)
+#define PERIODO_USB_US       1000
+#define PERIODO_JOYSTICK_US  1000
+#define PERIODO_BOTOES_US    5000
+#define PERIODO_MICROFONE_US 10000
+#define PERIODO_CONFIG_US    50000
+#define PERIODO_ENERGIA_US   50000
+
+// Periodos em OCIOSO (energia.h). As bordas dos botoes antecipam a tarefa
+// deles, e o joystick e visto em ate PERIODO_JOYSTICK_OCIOSO_US. A tarefa
+// USB mantem o ritmo para atender o host (retomada, requisicoes de controle).
+#define PERIODO_JOYSTICK_OCIOSO_US  20000
+#define PERIODO_BOTOES_OCIOSO_US   100000
+#define PERIODO_MICROFONE_OCIOSO_US 100000
+
+// =====================
+// Eventos entre nucleos
+// =====================
+_Static_assert(EVENTO_ENERGIA_OCIOSO - EVENTO_ENERGIA_ATIVO == ENERGIA_OCIOSO - ENERGIA_ATIVO,
+               "eventos de energia na ordem de energia_nivel_t");
+
+#define EVENTOS_CAPACIDADE 32
+
+static uint32_t eventos_itens[EVENTOS_CAPACIDADE];
+static fila_spsc_t eventos_fila;
+
+void entrada_eventos_init(void) {
+    fila_spsc_init(&eventos_fila, eventos_itens, EVENTOS_CAPACIDADE);
+}
+
+bool entrada_ler_evento(evento_t *evento) {
+    uint32_t item;
+    if (!fila_spsc_pop(&eventos_fila, &item))
+        return false;
+    *evento = (evento_t)item;
+    return true;
+}
+
+// Nucleo 1: publica um evento (descartado se a fila estiver cheia)
+static void publicar_evento(evento_t evento) {
+    if (fila_spsc_push(&eventos_fila, evento))
+        __sev();  // acorda o nucleo 0 se estiver dormindo em WFE
+}
+
+// =====================
+// Microfone: deteccao de voz no fluxo continuo do ADC
+// =====================
+// A tarefa consome todas as amostras novas do microfone desde a ultima
+// execucao (160 a cada 10 ms) e alimenta o VAD, que fica sempre atualizado.
+// Cada mudanca do VAD vai para o campo do microfone na tela. Com o ADC em
+// ritmo lento (OCIOSO) as amostras nao servem ao VAD e sao puladas.
+static vad_t vad;
+static uint32_t microfone_cursor;
+static bool microfone_voz;
+
+static void microfone_tarefa(void) {
+    if (adc_stream_taxa_hz() < VAD_TAXA_HZ) {
+        microfone_cursor = adc_stream_quadros();
+        return;
+    }
+
+    uint16_t amostras[256];
+    uint32_t n;
+    do {
+        n = adc_stream_ler(ADC_STREAM_MIC, &microfone_cursor, amostras, 256, NULL);
+        vad_processar(&vad, amostras, n);
+    } while (n == 256);
+
+    if (vad_ativo(&vad) != microfone_voz) {
+        microfone_voz = !microfone_voz;
+        publicar_evento(microfone_voz ? EVENTO_MIC_VOZ : EVENTO_MIC_SILENCIO);
+    }
+}
+
+const vad_t *entrada_vad(void) {
+    return &vad;
+}
+
+// =====================
+// Traco de entrada: gravacao e reproducao
+// =====================
+typedef enum { TRACO_PARADO, TRACO_GRAVANDO, TRACO_REPRODUZINDO } traco_estado_t;
+
+static traco_t *traco_gravacao, *traco_saida;
+static volatile uint8_t traco_estado;
+static volatile char traco_pedido;          // comando pendente do nucleo 0
+static traco_cursor_t traco_cursor_reproducao;
+static traco_evento_t traco_proximo;        // proximo registro a injetar
+static bool traco_ha_proximo;
+static uint32_t traco_reproducao_us;        // inicio da reproducao
+static uint16_t traco_x, traco_y;           // joystick reproduzido
+
+void entrada_traco_usar(traco_t *gravacao, traco_t *saida) {
+    traco_gravacao = gravacao;
+    traco_saida = saida;
+    traco_estado = TRACO_PARADO;
+    traco_pedido = 0;
+}
+
+void entrada_traco_pedir(char pedido) {
+    traco_pedido = pedido;
+}
+
+bool entrada_traco_parado(void) {
+    return traco_estado == TRACO_PARADO && !traco_pedido;
+}
+
+// Nivel de cada botao (bit = indice), ativos em nivel baixo
+static uint8_t traco_niveis_botoes(void) {
+    uint8_t niveis = 0xFF;
+    for (uint8_t i = 0; i < BOTOES_MAX; i++) {
+        if (botoes_pressionado(i))
+            niveis &= ~(1u << i);
+    }
+    return niveis;
+}
+
+static void traco_atender(char pedido) {
+    uint32_t agora = time_us_32();
+    if (traco_estado == TRACO_GRAVANDO)
+        traco_fechar(traco_gravacao, agora);
+    botoes_simular(false, 0xFF);
+    traco_estado = TRACO_PARADO;
+    if (!traco_gravacao)
+        return;
+
+    if (pedido == 'g') {
+        traco_iniciar(traco_gravacao, agora, adc_stream_media(ADC_STREAM_X, 1),
+                      adc_stream_media(ADC_STREAM_Y, 1), traco_niveis_botoes());
+        traco_estado = TRACO_GRAVANDO;
+    } else if (pedido == 'r') {
+        traco_iniciar(traco_saida, agora, traco_gravacao->inicio_x, traco_gravacao->inicio_y,
+                      traco_gravacao->inicio_niveis);
+        traco_cursor(traco_gravacao, &traco_cursor_reproducao);
+        traco_ha_proximo = traco_ler(traco_gravacao, &traco_cursor_reproducao, &traco_proximo);
+        traco_x = traco_gravacao->inicio_x;
+        traco_y = traco_gravacao->inicio_y;
+        traco_reproducao_us = agora;
+        botoes_simular(true, traco_gravacao->inicio_niveis);
+        traco_estado = TRACO_REPRODUZINDO;
+    }
+}
+
+bool entrada_traco_proximo_us(uint32_t *t_us) {
+    if (traco_estado != TRACO_REPRODUZINDO || !traco_ha_proximo)
+        return false;
+    *t_us = traco_reproducao_us + traco_proximo.t_us;
+    return true;
+}
+
+void entrada_traco_injetar(void) {
+    if (traco_estado != TRACO_REPRODUZINDO)
+        return;
+    uint32_t decorrido = time_us_32() - traco_reproducao_us;
+    while (traco_ha_proximo && traco_proximo.t_us <= decorrido) {
+        if (traco_proximo.tipo == TRACO_ADC) {
+            traco_x = traco_proximo.x;
+            traco_y = traco_proximo.y;
+        } else if (traco_proximo.tipo == TRACO_BORDA) {
+            botoes_simular_borda(traco_proximo.botao, traco_proximo.nivel);
+        }
+        traco_ha_proximo = traco_ler(traco_gravacao, &traco_cursor_reproducao, &traco_proximo);
+    }
+    if (!traco_ha_proximo) {
+        botoes_simular(false, 0xFF);
+        traco_estado = TRACO_PARADO;
+    }
+}
+
+// Chamada pela tarefa USB a cada passo
+static void traco_tarefa(void) {
+    char pedido = traco_pedido;
+    if (pedido) {
+        traco_pedido = 0;
+        traco_atender(pedido);
+    }
+    entrada_traco_injetar();
+}
+
+// Callback do TinyUSB: relatorio HID entregue ao host (instante da entrega,
+// nao da submissao, que e o que o build de host registra)
+void tud_hid_report_complete_cb(uint8_t instance, uint8_t const *report, uint16_t len) {
+    if (traco_estado == TRACO_GRAVANDO)
+        traco_hid(traco_gravacao, time_us_32(), instance, report, len);
+    else if (traco_estado == TRACO_REPRODUZINDO)
+        traco_hid(traco_saida, time_us_32(), instance, report, len);
+}
+
+// =====================
+// Governador de ociosidade
+// =====================
+// energia.c decide o nivel; aqui ele e aplicado as tarefas e perifericos
+// deste nucleo, e o nucleo 0 recebe um evento (display e LED). Atividade e
+// o joystick fora da zona morta, as bordas dos botoes (a IRQ de GPIO
+// antecipa a tarefa dos botoes) e botao mantido pressionado.
+static scheduler_t *scheduler_nucleo1;
+static int tarefa_joystick = -1, tarefa_botoes = -1, tarefa_microfone = -1;
+static energia_t energia;
+static energia_nivel_t energia_nivel;   // nivel aplicado
+static bool microfone_usb_aberto;       // ultimo estado visto pela tarefa USB
+static uint32_t energia_relatorios;     // relatorios HID no despertar
+static volatile uint32_t energia_borda_us;
+static volatile bool energia_borda;
+static bool usb_retomada_pedida;        // remote wakeup ja pedido nesta suspensao
+
+const energia_t *entrada_energia(void) {
+    return &energia;
+}
+
+energia_nivel_t entrada_energia_nivel(void) {
+    return energia_nivel;
+}
+
+static uint32_t relatorios_hid(void) {
+    hid_mouse_stats_t mouse;
+    hid_teclado_stats_t teclado;
+    hid_mouse_get_stats(&mouse);
+    hid_teclado_get_stats(&teclado);
+    return mouse.relatorios + teclado.relatorios;
+}
+
+// O ADC so fica lento em OCIOSO sem o host ouvindo o microfone: o fluxo de
+// audio precisa da taxa cheia mesmo com a placa parada
+static void adc_taxa_aplicar(void) {
+    bool lento = energia_nivel == ENERGIA_OCIOSO && !microfone_usb_ativo();
+    adc_stream_set_taxa(lento ? ADC_TAXA_OCIOSO_HZ : ADC_TAXA_POR_CANAL_HZ);
+}
+
+static void energia_aplicar(energia_nivel_t nivel) {
+    bool ocioso = nivel == ENERGIA_OCIOSO;
+    if (ocioso != (energia_nivel == ENERGIA_OCIOSO)) {
+        // Ao acordar o relogio volta primeiro, para o resto ja rodar rapido.
+        // O que deriva do clk_sys no nucleo 0 (LED) e reajustado la, com o
+        // evento.
+        energia_relogio(ocioso);
+        energia_nivel = nivel;
+        adc_taxa_aplicar();
+        scheduler_set_period(scheduler_nucleo1, tarefa_joystick,
+                             ocioso ? PERIODO_JOYSTICK_OCIOSO_US : PERIODO_JOYSTICK_US);
+        scheduler_set_period(scheduler_nucleo1, tarefa_botoes,
+                             ocioso ? PERIODO_BOTOES_OCIOSO_US : PERIODO_BOTOES_US);
+        scheduler_set_period(scheduler_nucleo1, tarefa_microfone,
+                             ocioso ? PERIODO_MICROFONE_OCIOSO_US : PERIODO_MICROFONE_US);
+        if (!ocioso) {
+            // Prazos ja marcados no ritmo lento sao antecipados
+            scheduler_acordar(scheduler_nucleo1, tarefa_joystick);
+            scheduler_acordar(scheduler_nucleo1, tarefa_botoes);
+            microfone_cursor = adc_stream_quadros();
+            energia_relatorios = relatorios_hid();
+        }
+    }
+    energia_nivel = nivel;
+    publicar_evento((evento_t)(EVENTO_ENERGIA_ATIVO + nivel));
+}
+
+static void QUENTE(registrar_atividade)(uint32_t t_us, bool borda) {
+    // Suspenso, so o host tira o barramento do repouso: pede a retomada
+    // (vale se ele habilitou o remote wakeup) e espera por ela
+    if (tud_suspended() && !usb_retomada_pedida) {
+        usb_retomada_pedida = true;
+        tud_remote_wakeup();
+    }
+    if (energia_atividade(&energia, t_us, borda))
+        energia_aplicar((energia_nivel_t)energia.nivel);
+}
+
+// IRQ de GPIO (nucleo 1), a cada borda de botao
+static void botoes_borda_irq(uint8_t botao, bool nivel) {
+    if (traco_estado == TRACO_GRAVANDO)
+        traco_borda(traco_gravacao, time_us_32(), botao, nivel);
+    energia_borda_us = time_us_32();
+    energia_borda = true;
+    if (scheduler_nucleo1)
+        scheduler_acordar(scheduler_nucleo1, tarefa_botoes);
+}
+
+static void energia_tarefa(void) {
+    bool suspenso = tud_suspended();
+    if (!suspenso)
+        usb_retomada_pedida = false;
+    energia_nivel_t nivel = energia_atualizar(&energia, time_us_32(), suspenso);
+    if (nivel != energia_nivel)
+        energia_aplicar(nivel);
+}
+
+// =====================
+// Processamento do Joystick (movimento do mouse)
+// =====================
+// O movimento e integrado a cada execucao (joystick.c); os pixels inteiros
+// vao para o produtor HID (hid_mouse.c), que os agrupa num relatorio por
+// quadro USB. Com A+B pressionados o joystick rola em vez de mover o cursor.
+static bool rolagem_ativa;
+static evento_t joystick_status;
+static joystick_t joystick;
+static uint32_t joystick_ultimo_us;
+
+// Rolagem com A+B pressionados: unidades de roda (1/120 de clique) por pixel
+// de movimento do joystick; e amostras do ADC na media de cada leitura,
+// primeiro estagio de filtragem antes do filtro de joystick.c (config.h)
+static uint16_t rolagem_fator;
+static uint8_t joystick_media_quadros;
+
+static void QUENTE(processar_joystick)(void) {
+    uint32_t agora = time_us_32();
+    uint8_t media = energia_nivel == ENERGIA_OCIOSO ? JOY_MEDIA_OCIOSO : joystick_media_quadros;
+    uint16_t adc_x = adc_stream_media(ADC_STREAM_X, media);
+    uint16_t adc_y = adc_stream_media(ADC_STREAM_Y, media);
+    if (traco_estado == TRACO_GRAVANDO) {
+        traco_adc(traco_gravacao, agora, adc_x, adc_y);
+    } else if (traco_estado == TRACO_REPRODUZINDO) {
+        adc_x = traco_x;
+        adc_y = traco_y;
+    }
+
+    bool ativo = joystick_atualizar(&joystick, adc_x, adc_y, agora - joystick_ultimo_us);
+    joystick_ultimo_us = agora;
+    if (ativo)
+        registrar_atividade(agora, false);
+
+    if (joystick_pendente(&joystick)) {
+        int8_t dx, dy;
+        joystick_extrair(&joystick, &dx, &dy);
+        if (rolagem_ativa)
+            hid_mouse_rolar(-dy * rolagem_fator, dx * rolagem_fator);
+        else
+            hid_mouse_mover(dx, dy, agora);
+    }
+
+    evento_t status = ativo ? EVENTO_STATUS_EM_USO : EVENTO_STATUS_AGUARDANDO;
+    // So publica quando o estado muda, para nao inundar a fila
+    if (status != joystick_status) {
+        joystick_status = status;
+        publicar_evento(status);
+    }
+}
+
+// =====================
+// Botoes: eventos filtrados (botoes.c)
+// =====================
+static bool rolagem_usada;  // A+B formaram acorde desde o ultimo repouso
+
+// =====================
+// Processamento do Botao do Joystick para cliques
+// =====================
+// Clique curto: clique esquerdo, ao fim da janela de duplo clique. Dois
+// cliques curtos na janela: duplo clique esquerdo, enviado em relatorios
+// seguidos, para o computador reconhecer mesmo com toques mais lentos que o
+// limite dele. Toque longo: clique direito assim que o botao passa do
+// limiar (1 s por padrao, config.h), sem esperar soltar.
+static void processar_botao_joystick(const botao_evento_t *ev) {
+    if (ev->tipo == BOTAO_CLIQUE) {
+        hid_mouse_botoes(HID_MOUSE_BOTAO_ESQUERDO);
+        hid_mouse_botoes(0);
+    } else if (ev->tipo == BOTAO_DUPLO_CLIQUE) {
+        for (int i = 0; i < 2; i++) {
+            hid_mouse_botoes(HID_MOUSE_BOTAO_ESQUERDO);
+            hid_mouse_botoes(0);
+        }
+    } else if (ev->tipo == BOTAO_SEGURANDO) {
+        hid_mouse_botoes(HID_MOUSE_BOTAO_DIREITO);
+        hid_mouse_botoes(0);
+    }
+}
+
+// =====================
+// Processamento do Botao A: "Transcrevendo tela" e som no buzzer
+// =====================
+// Dispara ao soltar, para nao confundir com o inicio do acorde A+B; o
+// atalho pede ao computador a leitura da tela
+static void processar_botao_A(const botao_evento_t *ev) {
+    if ((ev->tipo == BOTAO_CLIQUE || ev->tipo == BOTAO_CLIQUE_LONGO) && !rolagem_usada) {
+        hid_teclado_atalho(ATALHO_A_MODIFICADORES, ATALHO_A_TECLA);
+        publicar_evento(EVENTO_TRANSCREVER);
+    }
+}
+
+// =====================
+// Processamento do Botao B: Microfone para "Ouvindo" ou "Pronto pra ouvir"
+// =====================
+// A mensagem fica na tela enquanto o botao estiver pressionado e acompanha
+// o VAD: "Ouvindo" durante a fala. Ao pressionar, o atalho abre o ditado
+// no computador. O acorde A+B a substitui pela mensagem de rolagem.
+static bool botao_b_voz;       // estado do VAD exibido na mensagem atual
+static bool botao_b_exibindo;  // mensagem do microfone na tela
+
+static void processar_botao_B(const botao_evento_t *ev) {
+    if (ev->tipo == BOTAO_PRESSIONADO && !rolagem_usada) {
+        hid_teclado_atalho(ATALHO_B_MODIFICADORES, ATALHO_B_TECLA);
+        botao_b_exibindo = true;
+        botao_b_voz = vad_ativo(&vad);
+        publicar_evento(botao_b_voz ? EVENTO_STATUS_OUVINDO : EVENTO_STATUS_PRONTO_OUVIR);
+    } else if (ev->tipo == BOTAO_SOLTO && botao_b_exibindo) {
+        botao_b_exibindo = false;
+        publicar_evento(EVENTO_LIMPAR_TEMPORARIO);
+    }
+}
+
+static void atualizar_botao_B(void) {
+    if (botao_b_exibindo && vad_ativo(&vad) != botao_b_voz) {
+        botao_b_voz = !botao_b_voz;
+        publicar_evento(botao_b_voz ? EVENTO_STATUS_OUVINDO : EVENTO_STATUS_PRONTO_OUVIR);
+    }
+}
+
+// =====================
+// Acorde A+B: rolagem com o joystick
+// =====================
+// Enquanto A e B estiverem pressionados juntos o joystick vira roda de
+// rolagem (vertical e horizontal). As acoes individuais de A e B ficam
+// suspensas ate os dois serem soltos.
+static void processar_acorde_AB(void) {
+    bool acorde = botoes_pressionado(BOTAO_A) && botoes_pressionado(BOTAO_B);
+    if (acorde && !rolagem_ativa) {
+        rolagem_usada = true;
+        botao_b_exibindo = false;
+        publicar_evento(EVENTO_STATUS_ROLAGEM);
+    } else if (!acorde && rolagem_ativa) {
+        publicar_evento(EVENTO_LIMPAR_TEMPORARIO);
+        publicar_evento(EVENTO_MODO_CURSOR);
+    }
+    rolagem_ativa = acorde;
+}
+
+static void processar_botoes(void) {
+    if (energia_borda) {
+        energia_borda = false;
+        registrar_atividade(energia_borda_us, true);
+    }
+    botoes_tarefa();
+    if (botoes_pressionado(BOTAO_JOY) || botoes_pressionado(BOTAO_A) || botoes_pressionado(BOTAO_B))
+        registrar_atividade(time_us_32(), false);
+    // O acorde e avaliado antes dos eventos para que o B pressionado como
+    // parte dele nao chegue a exibir a mensagem do microfone
+    processar_acorde_AB();
+
+    botao_evento_t ev;
+    while (botoes_ler_evento(&ev)) {
+        switch (ev.botao) {
+        case BOTAO_JOY:
+            processar_botao_joystick(&ev);
+            break;
+        case BOTAO_A:
+            processar_botao_A(&ev);
+            break;
+        case BOTAO_B:
+            processar_botao_B(&ev);
+            break;
+        }
+    }
+    atualizar_botao_B();
+
+    // Libera as acoes individuais so depois de A e B estarem soltos
+    if (rolagem_usada && !botoes_pressionado(BOTAO_A) && !botoes_pressionado(BOTAO_B))
+        rolagem_usada = false;
+}
+
+// =====================
+// Configuracao
+// =====================
+// Copia os parametros de config.h para as estruturas dos modulos quando a
+// configuracao muda; no caminho quente eles sao campos comuns na RAM.
+static uint32_t config_geracao;
+
+static void aplicar_config(const config_t *c) {
+    joystick.zona_morta = c->joy_zona_morta;
+    joystick.raio_max = c->joy_raio_max;
+    joystick_set_curva(&joystick, c->joy_curva);
+    joystick.filtro = c->joy_filtro;
+    joystick.fc_min_q4 = c->joy_fc_min_q4;
+    joystick.beta_q4 = c->joy_beta_q4;
+    joystick.fc_derivada_q4 = c->joy_fc_derivada_q4;
+    joystick_media_quadros = c->joy_media_quadros;
+    rolagem_fator = c->joy_rolagem_fator;
+    for (uint8_t i = 0; i < N_BOTOES; i++)
+        botoes_set_longo(i, c->botao_longo_ms);
+    vad.quadros_ataque = c->vad_ataque;
+    vad.quadros_espera = c->vad_espera;
+    vad.fator_ruido = c->vad_fator_ruido;
+    vad.energia_min = c->vad_energia_min;
+    energia.escurecer_ms = c->energia_escurecer_s * 1000u;
+    energia.desligar_ms = c->energia_desligar_s * 1000u;
+}
+
+static void config_tarefa(void) {
+    config_t c;
+    if (config_ler(&config_geracao, &c))
+        aplicar_config(&c);
+}
+
+// =====================
+// USB
+// =====================
+// Estado da conexao exibido na tela; publicado so quando muda
+static evento_t usb_estado;
+
+static void usb_tarefa(void) {
+    tud_task();  // Processa as tarefas USB do TinyUSB
+    hid_teclado_tarefa();
+    cdc_controle_tarefa();
+    traco_tarefa();
+
+    // Primeiro relatorio depois de sair de OCIOSO: latencia de despertar
+    if (energia_medindo(&energia) && relatorios_hid() != energia_relatorios)
+        energia_relatorio(&energia, time_us_32());
+
+    if (microfone_usb_ativo() != microfone_usb_aberto) {
+        microfone_usb_aberto = !microfone_usb_aberto;
+        adc_taxa_aplicar();
+    }
+
+    evento_t estado = tud_suspended() ? EVENTO_USB_SUSPENSO :
+                      tud_mounted() ? EVENTO_USB_CONECTADO : EVENTO_USB_DESCONECTADO;
+    if (estado != usb_estado) {
+        usb_estado = estado;
+        publicar_evento(estado);
+        energia_tarefa();  // suspensao e retomada valem na hora
+    }
+}
+
+// =====================
+// Inicializacao
+// =====================
+void entrada_init(const uint8_t pinos_botoes[N_BOTOES]) {
+    scheduler_nucleo1 = NULL;
+    traco_estado = TRACO_PARADO;
+    traco_pedido = 0;
+    rolagem_ativa = rolagem_usada = false;
+    botao_b_voz = botao_b_exibindo = false;
+    joystick_status = EVENTO_STATUS_AGUARDANDO;
+    usb_estado = EVENTO_USB_DESCONECTADO;
+    energia_nivel = ENERGIA_ATIVO;
+    microfone_usb_aberto = false;
+    microfone_voz = false;
+    energia_borda = false;
+    usb_retomada_pedida = false;
+    config_geracao = 0;
+
+    // Botoes por IRQ de borda; a IRQ de GPIO fica neste nucleo
+    botoes_init(pinos_botoes, N_BOTOES);
+    botoes_set_callback_borda(botoes_borda_irq);
+    botoes_set_duplo_clique(BOTAO_JOY, JOY_DUPLO_CLIQUE_MS);
+
+    // Captura continua do ADC (joystick e microfone); a IRQ de rearme do
+    // DMA fica neste nucleo, junto dos consumidores
+    adc_stream_init(ADC_TAXA_POR_CANAL_HZ);
+    microfone_usb_init();
+    vad_init(&vad);
+    microfone_cursor = adc_stream_quadros();
+
+    // Calibra o centro do joystick com o anel ja cheio de amostras em repouso
+    joystick_init(&joystick);
+    sleep_ms(JOY_CALIB_QUADROS * 1000 / ADC_TAXA_POR_CANAL_HZ + 1);
+    joystick_calibrar_centro(&joystick,
+                             adc_stream_media(ADC_STREAM_X, JOY_CALIB_QUADROS),
+                             adc_stream_media(ADC_STREAM_Y, JOY_CALIB_QUADROS));
+    joystick_ultimo_us = time_us_32();
+    energia_init(&energia, time_us_32());
+    config_tarefa();
+}
+
+void entrada_registrar(scheduler_t *s) {
+    // A tarefa USB e registrada primeiro: em empate de prazos ela vence, e
+    // como todos os passos das demais tarefas sao curtos, tud_task() roda
+    // pelo menos a cada PERIODO_USB_US mais a duracao de um passo.
+    scheduler_nucleo1 = s;
+    scheduler_add_task(s, "usb", usb_tarefa, PERIODO_USB_US);
+    tarefa_joystick = scheduler_add_task(s, "joystick", processar_joystick, PERIODO_JOYSTICK_US);
+    tarefa_botoes = scheduler_add_task(s, "botoes", processar_botoes, PERIODO_BOTOES_US);
+    tarefa_microfone = scheduler_add_task(s, "microfone", microfone_tarefa, PERIODO_MICROFONE_US);
+    scheduler_add_task(s, "config", config_tarefa, PERIODO_CONFIG_US);
+    scheduler_add_task(s, "energia", energia_tarefa, PERIODO_ENERGIA_US);
+}
@@ -0,0 +1,102 @@
+// entrada.h - Caminho de entrada do nucleo 1: USB, joystick, botoes, microfone e energia
+//
+// As tarefas que transformam as entradas da placa em relatorios HID e em
+// eventos para o nucleo 0: a tarefa USB (tud_task() e o que vai junto), o
+// joystick (cursor ou rolagem), os botoes (cliques e atalhos de teclado),
+// o microfone (VAD), a configuracao e o governador de ociosidade (energia.h),
+// que muda o ritmo das demais. Tambem grava e reproduz o traco das entradas
+// (traco.h).
+//
+// O firmware (HPR.c) e o build de host (host/roteiro.c) montam este mesmo
+// encadeamento; o que muda entre os dois e so a HAL por baixo.
+//
+// O nucleo 1 nunca espera pelo nucleo 0: publica eventos numa fila SPSC e
+// segue; o nucleo 0 consome a fila na sua propria cadencia
+// (entrada_ler_evento()).
+
+#ifndef ENTRADA_H
+#define ENTRADA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "scheduler.h"
+#include "energia.h"
+#include "traco.h"
+#include "vad.h"
+
+// Indices dos botoes, na ordem dos pinos de entrada_init()
+enum {
+    BOTAO_JOY,
+    BOTAO_A,
+    BOTAO_B,
+    N_BOTOES
+};
+
+// Eventos do nucleo 1 para o nucleo 0 (display, LED e buzzer)
+typedef enum {
+    EVENTO_STATUS_EM_USO,
+    EVENTO_STATUS_AGUARDANDO,
+    EVENTO_TRANSCREVER,          // "Transcrevendo tela" + som de 5 s
+    EVENTO_STATUS_OUVINDO,
+    EVENTO_STATUS_PRONTO_OUVIR,
+    EVENTO_STATUS_ROLAGEM,       // tambem poe o modo em rolagem
+    EVENTO_LIMPAR_TEMPORARIO,
+    EVENTO_MODO_CURSOR,
+    EVENTO_MIC_VOZ,
+    EVENTO_MIC_SILENCIO,
+    EVENTO_USB_CONECTADO,
+    EVENTO_USB_DESCONECTADO,
+    EVENTO_USB_SUSPENSO,
+    EVENTO_ENERGIA_ATIVO,        // + energia_nivel_t
+    EVENTO_ENERGIA_ESCURO,
+    EVENTO_ENERGIA_OCIOSO
+} evento_t;
+
+// Nucleo 0, antes de lancar o nucleo 1: prepara a fila de eventos
+void entrada_eventos_init(void);
+
+// Nucleo 0: proximo evento publicado; false com a fila vazia
+bool entrada_ler_evento(evento_t *evento);
+
+// Nucleo 1, depois de tusb_init() e hid_mouse_init(): botoes (pinos na
+// ordem de BOTAO_*), captura do ADC, microfone USB, VAD, calibracao do
+// centro do joystick (espera o anel do ADC encher em repouso, ~17 ms),
+// governador e configuracao atual
+void entrada_init(const uint8_t pinos_botoes[N_BOTOES]);
+
+// Registra as tarefas do nucleo 1, a USB primeiro (ganha os empates de
+// prazo): usb, joystick, botoes, microfone, config e energia
+void entrada_registrar(scheduler_t *s);
+
+// Estado para o relatorio e o roteiro; leituras sem trava de outro nucleo
+// podem misturar instantes proximos
+const energia_t *entrada_energia(void);
+energia_nivel_t entrada_energia_nivel(void);
+const vad_t *entrada_vad(void);
+
+// =====================
+// Traco das entradas
+// =====================
+// Gravacao: as leituras do joystick como entram no filtro, as bordas dos
+// botoes e os relatorios HID entregues ao host. Reproducao: as mesmas
+// entradas no mesmo processamento (botoes_simular()), com os relatorios que
+// saem gravados na saida, para comparar com os da gravacao.
+//
+// Os pedidos ('g' grava, 'r' reproduz a gravacao, 's' para) podem vir do
+// nucleo 0 e sao atendidos no proximo passo da tarefa USB, que tambem
+// injeta os registros vencidos: no dispositivo, com a resolucao do periodo
+// dela (1 ms). Quem quiser o instante exato chama entrada_traco_injetar()
+// em entrada_traco_proximo_us(), entre dois passos do escalonador.
+
+// Tracos usados (ja com traco_init()); nucleo 1, antes do primeiro pedido
+void entrada_traco_usar(traco_t *gravacao, traco_t *saida);
+void entrada_traco_pedir(char pedido);
+// Nada gravando nem reproduzindo, e nenhum pedido pendente: os tracos podem
+// ser lidos pelo outro nucleo
+bool entrada_traco_parado(void);
+// Instante (time_us_32) do proximo registro a injetar; false sem reproducao
+bool entrada_traco_proximo_us(uint32_t *t_us);
+// Injeta os registros vencidos ate agora
+void entrada_traco_injetar(void);
+
+#endif // ENTRADA_H
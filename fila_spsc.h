@@ -0,0 +1,55 @@
+// fila_spsc.h - Fila circular sem travas, um produtor / um consumidor
+//
+// Usada para troca de eventos entre os nucleos (ou entre uma interrupcao e
+// uma tarefa). O produtor escreve apenas 'cabeca' e o consumidor apenas
+// 'cauda'; as barreiras garantem que o item esteja visivel antes do indice.
+// A capacidade deve ser potencia de 2.
+
+#ifndef FILA_SPSC_H
+#define FILA_SPSC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/sync.h"
+
+typedef struct {
+    volatile uint32_t cabeca;   // proxima posicao de escrita (produtor)
+    volatile uint32_t cauda;    // proxima posicao de leitura (consumidor)
+    uint32_t mascara;
+    uint32_t *itens;
+} fila_spsc_t;
+
+static inline void fila_spsc_init(fila_spsc_t *f, uint32_t *itens, uint32_t capacidade) {
+    f->cabeca = 0;
+    f->cauda = 0;
+    f->mascara = capacidade - 1;
+    f->itens = itens;
+}
+
+static inline bool fila_spsc_vazia(const fila_spsc_t *f) {
+    return f->cabeca == f->cauda;
+}
+
+// Retorna false (e descarta o item) se a fila estiver cheia
+static inline bool fila_spsc_push(fila_spsc_t *f, uint32_t item) {
+    uint32_t cabeca = f->cabeca;
+    if (cabeca - f->cauda > f->mascara)
+        return false;
+    f->itens[cabeca & f->mascara] = item;
+    __dmb();
+    f->cabeca = cabeca + 1;
+    return true;
+}
+
+static inline bool fila_spsc_pop(fila_spsc_t *f, uint32_t *item) {
+    uint32_t cauda = f->cauda;
+    if (f->cabeca == cauda)
+        return false;
+    __dmb();
+    *item = f->itens[cauda & f->mascara];
+    __dmb();
+    f->cauda = cauda + 1;
+    return true;
+}
+
+#endif // FILA_SPSC_H
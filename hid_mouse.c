@@ -0,0 +1,176 @@
+// hid_mouse.c - Produtor de relatorios HID do mouse sincronizado ao USB
+
+#include "pico/stdlib.h"
+#include "tusb.h"
+#include "usb_descriptors.h"
+#include "quente.h"
+#include "hid_mouse.h"
+
+#define HID_MOUSE_FILA_BOTOES   8           // potencia de 2
+
+// Movimento maximo guardado entre relatorios (em unidades do relatorio);
+// evita um salto longo depois de o host ficar um tempo sem pedir dados
+#define HID_MOUSE_ACUMULO_MAX   4096
+#define HID_MOUSE_ROLAGEM_MAX   (16 * HID_MOUSE_ROLAGEM_CLIQUE)
+
+// Bits do relatorio de feature: multiplicador da roda (bits 0-1) e do pan
+// (bits 2-3); valor logico 1 = multiplicador fisico 120
+#define HID_MOUSE_FEATURE_WHEEL 0x01
+#define HID_MOUSE_FEATURE_PAN   0x04
+
+static int32_t acum_x, acum_y, acum_wheel, acum_pan;
+static uint8_t feature_multiplicador;
+static bool movimento_pendente;
+static uint32_t pendente_desde_us;      // amostra mais antiga ainda nao enviada
+
+static uint8_t botoes_fila[HID_MOUSE_FILA_BOTOES];
+static uint8_t botoes_cabeca, botoes_cauda;
+static uint8_t botoes_atual;            // ultimo estado enviado ou enfileirado
+static uint8_t botoes_enviados;         // botoes do ultimo relatorio enviado
+
+static hid_mouse_stats_t stats;
+
+void hid_mouse_init(void) {
+    // Produtor vazio: o build de host reinicia a logica a cada reproducao
+    // de traco (traco.h)
+    acum_x = acum_y = acum_wheel = acum_pan = 0;
+    movimento_pendente = false;
+    botoes_cabeca = botoes_cauda = 0;
+    botoes_atual = 0;
+    botoes_enviados = 0;
+    stats = (hid_mouse_stats_t){ 0 };
+    tud_sof_cb_enable(true);
+}
+
+static int32_t QUENTE(hid_mouse_limitar)(int32_t v, int32_t max) {
+    return v > max ? max : (v < -max ? -max : v);
+}
+
+static void QUENTE(hid_mouse_marcar_pendente)(uint32_t amostra_us) {
+    if (movimento_pendente) {
+        stats.coalescidas++;
+    } else {
+        movimento_pendente = true;
+        pendente_desde_us = amostra_us;
+    }
+}
+
+void QUENTE(hid_mouse_mover)(int32_t dx, int32_t dy, uint32_t amostra_us) {
+    stats.amostras++;
+    if (dx == 0 && dy == 0)
+        return;
+    acum_x = hid_mouse_limitar(acum_x + dx, HID_MOUSE_ACUMULO_MAX);
+    acum_y = hid_mouse_limitar(acum_y + dy, HID_MOUSE_ACUMULO_MAX);
+    hid_mouse_marcar_pendente(amostra_us);
+}
+
+void QUENTE(hid_mouse_rolar)(int32_t wheel, int32_t pan) {
+    if (wheel == 0 && pan == 0)
+        return;
+    acum_wheel = hid_mouse_limitar(acum_wheel + wheel, HID_MOUSE_ROLAGEM_MAX);
+    acum_pan = hid_mouse_limitar(acum_pan + pan, HID_MOUSE_ROLAGEM_MAX);
+    hid_mouse_marcar_pendente(time_us_32());
+}
+
+void hid_mouse_botoes(uint8_t botoes) {
+    if (botoes == botoes_atual)
+        return;
+    if ((uint8_t)(botoes_cabeca - botoes_cauda) == HID_MOUSE_FILA_BOTOES) {
+        stats.botoes_perdidos++;
+        return;
+    }
+    botoes_fila[botoes_cabeca++ & (HID_MOUSE_FILA_BOTOES - 1)] = botoes;
+    botoes_atual = botoes;
+}
+
+void hid_mouse_get_stats(hid_mouse_stats_t *s) {
+    *s = stats;
+}
+
+// Parte do acumulador que cabe num relatorio
+static int16_t QUENTE(hid_mouse_parcela)(int32_t acum) {
+    return (int16_t)hid_mouse_limitar(acum, INT16_MAX);
+}
+
+// Sem o multiplicador habilitado pelo host, so cliques inteiros da roda
+static int16_t QUENTE(hid_mouse_parcela_rolagem)(int32_t acum, bool alta_resolucao) {
+    if (alta_resolucao)
+        return hid_mouse_parcela(acum);
+    return (int16_t)(acum / HID_MOUSE_ROLAGEM_CLIQUE);
+}
+
+static void QUENTE(hid_mouse_enviar)(void) {
+    bool tem_botao = botoes_cabeca != botoes_cauda;
+    if (!tem_botao && !movimento_pendente)
+        return;
+    if (!tud_hid_n_ready(USB_HID_MOUSE)) {
+        stats.endpoint_ocupado++;
+        return;
+    }
+
+    uint8_t botoes = tem_botao ? botoes_fila[botoes_cauda & (HID_MOUSE_FILA_BOTOES - 1)] : botoes_enviados;
+
+    // O que nao couber no relatorio fica para o proximo quadro
+    bool wheel_hr = feature_multiplicador & HID_MOUSE_FEATURE_WHEEL;
+    bool pan_hr = feature_multiplicador & HID_MOUSE_FEATURE_PAN;
+    hid_mouse_relatorio_t r = {
+        .botoes = botoes,
+        .x = hid_mouse_parcela(acum_x),
+        .y = hid_mouse_parcela(acum_y),
+        .wheel = hid_mouse_parcela_rolagem(acum_wheel, wheel_hr),
+        .pan = hid_mouse_parcela_rolagem(acum_pan, pan_hr),
+    };
+    if (!tem_botao && !r.x && !r.y && !r.wheel && !r.pan)
+        return;  // so fracoes de clique da roda: nada a enviar ainda
+    if (!tud_hid_n_report(USB_HID_MOUSE, 0, &r, sizeof(r))) {
+        stats.falhas_envio++;
+        return;
+    }
+    acum_x -= r.x;
+    acum_y -= r.y;
+    acum_wheel -= wheel_hr ? r.wheel : r.wheel * HID_MOUSE_ROLAGEM_CLIQUE;
+    acum_pan -= pan_hr ? r.pan : r.pan * HID_MOUSE_ROLAGEM_CLIQUE;
+    if (tem_botao)
+        botoes_cauda++;
+    botoes_enviados = botoes;
+
+    uint32_t agora = time_us_32();
+    stats.relatorios++;
+    if (movimento_pendente) {
+        uint32_t latencia = agora - pendente_desde_us;
+        stats.latencia_ultima_us = latencia;
+        stats.latencia_soma_us += latencia;
+        if (latencia > stats.latencia_max_us)
+            stats.latencia_max_us = latencia;
+        // O que sobrou (saturacao ou fracao de clique da roda) continua
+        // pendente, com a idade atual
+        movimento_pendente = acum_x || acum_y || acum_wheel || acum_pan;
+        pendente_desde_us = agora;
+    }
+}
+
+// Inicio de quadro USB (chamado dentro de tud_task())
+void QUENTE(tud_sof_cb)(uint32_t frame_count) {
+    (void)frame_count;
+    hid_mouse_enviar();
+}
+
+// Relatorio de feature com os multiplicadores de resolucao das rodas. A
+// interface do teclado nao tem relatorios de feature e ignora o de saida
+// (LEDs), entao os callbacks so atendem o mouse.
+uint16_t tud_hid_get_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type,
+                               uint8_t *buffer, uint16_t reqlen) {
+    (void)report_id;
+    if (instance != USB_HID_MOUSE || report_type != HID_REPORT_TYPE_FEATURE || reqlen < 1)
+        return 0;
+    buffer[0] = feature_multiplicador;
+    return 1;
+}
+
+void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type,
+                           uint8_t const *buffer, uint16_t bufsize) {
+    (void)report_id;
+    if (instance != USB_HID_MOUSE || report_type != HID_REPORT_TYPE_FEATURE || bufsize < 1)
+        return;
+    feature_multiplicador = buffer[0] & (HID_MOUSE_FEATURE_WHEEL | HID_MOUSE_FEATURE_PAN);
+}
@@ -0,0 +1,77 @@
+// hid_mouse.h - Produtor de relatorios HID do mouse sincronizado ao USB
+//
+// As tarefas de entrada apenas depositam movimento e mudancas de botoes
+// aqui; o envio acontece no SOF (inicio de cada quadro USB, 1 ms em full
+// speed), no maximo um relatorio por quadro e apenas com o endpoint livre.
+// Movimento que chega enquanto o endpoint esta ocupado e somado ao proximo
+// relatorio em vez de descartado. Mudancas de botoes ficam numa fila curta,
+// e cada estado sai em um relatorio proprio para que um clique rapido
+// (aperta e solta no mesmo quadro) nao desapareca.
+//
+// O mouse e a instancia HID USB_HID_MOUSE, com endpoint proprio; o
+// relatorio e definido pelo projeto (usb_descriptors.c), sem report ID:
+//   byte 0     5 botoes + 3 bits de enchimento
+//   bytes 1-4  X e Y relativos, int16
+//   bytes 5-8  roda vertical e horizontal (AC Pan), int16
+// As rodas declaram um Resolution Multiplier de 120 num relatorio de
+// feature. Se o host o habilitar (Windows e Linux o fazem), cada unidade
+// enviada vale 1/120 de "clique" da roda; senao o produtor envia cliques
+// inteiros e guarda a fracao.
+//
+// Tudo roda no nucleo do TinyUSB (nucleo 1): as funcoes nao sao seguras
+// para chamar do outro nucleo.
+
+#ifndef HID_MOUSE_H
+#define HID_MOUSE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HID_MOUSE_BOTAO_ESQUERDO    0x01
+#define HID_MOUSE_BOTAO_DIREITO     0x02
+#define HID_MOUSE_BOTAO_MEIO        0x04
+#define HID_MOUSE_BOTAO_VOLTAR      0x08
+#define HID_MOUSE_BOTAO_AVANCAR     0x10
+
+// Unidades de rolagem por clique da roda (multiplicador de alta resolucao)
+#define HID_MOUSE_ROLAGEM_CLIQUE    120
+
+typedef struct __attribute__((packed)) {
+    uint8_t botoes;
+    int16_t x;
+    int16_t y;
+    int16_t wheel;
+    int16_t pan;
+} hid_mouse_relatorio_t;
+
+typedef struct {
+    uint32_t relatorios;            // relatorios enviados
+    uint32_t amostras;              // chamadas a hid_mouse_mover()
+    uint32_t coalescidas;           // amostras somadas a um relatorio ja pendente
+    uint32_t botoes_perdidos;       // mudancas de botao com a fila cheia
+    uint32_t endpoint_ocupado;      // SOFs com dados pendentes e o endpoint ocupado
+    uint32_t falhas_envio;          // tud_hid_report() recusou o relatorio
+    // Latencia da amostra mais antiga de cada relatorio ate a submissao
+    uint32_t latencia_ultima_us;
+    uint32_t latencia_max_us;
+    uint64_t latencia_soma_us;
+} hid_mouse_stats_t;
+
+// Zera o produtor e habilita o callback de SOF do TinyUSB; chamar depois
+// de tusb_init()
+void hid_mouse_init(void);
+
+// Soma movimento ao proximo relatorio. amostra_us e o instante (time_us_32)
+// da leitura que originou o movimento, usado na medida de latencia.
+void hid_mouse_mover(int32_t dx, int32_t dy, uint32_t amostra_us);
+
+// Soma rolagem vertical (positivo = para cima) e horizontal (positivo =
+// para a direita), em 1/HID_MOUSE_ROLAGEM_CLIQUE de clique da roda
+void hid_mouse_rolar(int32_t wheel, int32_t pan);
+
+// Novo estado dos botoes (mascara HID_MOUSE_BOTAO_*)
+void hid_mouse_botoes(uint8_t botoes);
+
+void hid_mouse_get_stats(hid_mouse_stats_t *stats);
+
+#endif // HID_MOUSE_H
@@ -0,0 +1,72 @@
+// hid_teclado.c - Atalhos de teclado e teclas de consumo pelo USB
+
+#include "tusb.h"
+#include "usb_descriptors.h"
+#include "hid_teclado.h"
+
+// Relatorio de teclado do protocolo de boot (sem o ID, que vai a parte)
+#define HID_TECLADO_TAMANHO 8
+#define HID_CONSUMO_TAMANHO 2
+
+typedef struct {
+    uint8_t id;                     // USB_RELATORIO_TECLADO ou USB_RELATORIO_CONSUMO
+    uint8_t dados[HID_TECLADO_TAMANHO];
+} hid_teclado_relatorio_t;
+
+static hid_teclado_relatorio_t fila[HID_TECLADO_FILA];
+static uint8_t fila_cabeca, fila_cauda;
+
+static hid_teclado_stats_t stats;
+
+// Reserva os dois relatorios (apertar e soltar) de uma vez, para que um
+// atalho nunca fique com a tecla presa por falta de espaco para o soltar
+static hid_teclado_relatorio_t *hid_teclado_reservar(uint8_t id) {
+    if ((uint8_t)(fila_cabeca - fila_cauda) > HID_TECLADO_FILA - 2) {
+        stats.descartados++;
+        return NULL;
+    }
+    hid_teclado_relatorio_t *apertar = &fila[fila_cabeca & (HID_TECLADO_FILA - 1)];
+    hid_teclado_relatorio_t *soltar = &fila[(uint8_t)(fila_cabeca + 1) & (HID_TECLADO_FILA - 1)];
+    *apertar = (hid_teclado_relatorio_t){ .id = id };
+    *soltar = (hid_teclado_relatorio_t){ .id = id };
+    return apertar;
+}
+
+bool hid_teclado_atalho(uint8_t modificadores, uint8_t tecla) {
+    hid_teclado_relatorio_t *r = hid_teclado_reservar(USB_RELATORIO_TECLADO);
+    if (!r)
+        return false;
+    r->dados[0] = modificadores;
+    r->dados[2] = tecla;
+    fila_cabeca += 2;
+    return true;
+}
+
+bool hid_teclado_consumo(uint16_t uso) {
+    hid_teclado_relatorio_t *r = hid_teclado_reservar(USB_RELATORIO_CONSUMO);
+    if (!r)
+        return false;
+    r->dados[0] = (uint8_t)uso;
+    r->dados[1] = (uint8_t)(uso >> 8);
+    fila_cabeca += 2;
+    return true;
+}
+
+void hid_teclado_tarefa(void) {
+    if (fila_cabeca == fila_cauda)
+        return;
+    if (!tud_hid_n_ready(USB_HID_TECLADO)) {
+        stats.endpoint_ocupado++;
+        return;
+    }
+    const hid_teclado_relatorio_t *r = &fila[fila_cauda & (HID_TECLADO_FILA - 1)];
+    uint16_t n = r->id == USB_RELATORIO_CONSUMO ? HID_CONSUMO_TAMANHO : HID_TECLADO_TAMANHO;
+    if (tud_hid_n_report(USB_HID_TECLADO, r->id, r->dados, n)) {
+        fila_cauda++;
+        stats.relatorios++;
+    }
+}
+
+void hid_teclado_get_stats(hid_teclado_stats_t *s) {
+    *s = stats;
+}
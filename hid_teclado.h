@@ -0,0 +1,41 @@
+// hid_teclado.h - Atalhos de teclado e teclas de consumo pelo USB
+//
+// Segunda interface HID do dispositivo composto (USB_HID_TECLADO), com
+// endpoint e fila proprios: uma rajada de atalhos aqui nunca atrasa os
+// relatorios do mouse. Cada atalho vira dois relatorios (teclas apertadas,
+// depois todas soltas) que saem um por vez, quando o endpoint libera.
+//   ID 1 (teclado)   modificadores, reservado, 6 codigos de tecla (boot)
+//   ID 2 (consumo)   um uso de 16 bits da pagina Consumer (volume, midia...)
+// Codigos de tecla e modificadores sao os do TinyUSB (HID_KEY_*,
+// KEYBOARD_MODIFIER_*); usos de consumo, HID_USAGE_CONSUMER_*.
+//
+// Como hid_mouse.c, roda no nucleo do TinyUSB (nucleo 1).
+
+#ifndef HID_TECLADO_H
+#define HID_TECLADO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HID_TECLADO_FILA    16      // relatorios aguardando (potencia de 2)
+
+typedef struct {
+    uint32_t relatorios;            // relatorios enviados
+    uint32_t descartados;           // atalhos recusados com a fila cheia
+    uint32_t endpoint_ocupado;      // passos com relatorio pendente e o endpoint ocupado
+} hid_teclado_stats_t;
+
+// Atalho: modificadores + uma tecla, apertados e soltos em seguida.
+// false (e nada enfileirado) se nao couberem os dois relatorios.
+bool hid_teclado_atalho(uint8_t modificadores, uint8_t tecla);
+
+// Tecla de consumo (uso da pagina Consumer), apertada e solta
+bool hid_teclado_consumo(uint16_t uso);
+
+// Envia o proximo relatorio da fila se o endpoint estiver livre; chamar
+// depois de tud_task()
+void hid_teclado_tarefa(void);
+
+void hid_teclado_get_stats(hid_teclado_stats_t *stats);
+
+#endif // HID_TECLADO_H
@@ -0,0 +1,173 @@
+// bench.c - Microbenchmarks das funcoes quentes do firmware, no host
+//
+// Mede o tempo por chamada com o relogio monotonic do host. Os numeros nao
+// valem como ciclos do RP2040, mas servem para comparar versoes: uma
+// regressao aparece como aumento relativo na mesma maquina. As funcoes que
+// passam pela HAL simulada (envio do display, relatorio HID) incluem o
+// custo dela.
+//
+// Uso: hpr_bench [fator]   (multiplica o numero de iteracoes)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "pico/stdlib.h"
+#include "tusb.h"
+#include "hal_host.h"
+#include "afinacao.h"
+#include "botoes.h"
+#include "hid_mouse.h"
+#include "i2c_fila.h"
+#include "joystick.h"
+#include "ssd1306.h"
+#include "ui.h"
+#include "vad.h"
+
+static volatile uint32_t sumidouro;     // impede que o compilador descarte o resultado
+static uint32_t fator = 1;
+
+static uint64_t agora_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+static void relatar(const char *nome, uint64_t ns, uint32_t n) {
+    printf("%-36s %10.1f ns/chamada  (%u chamadas)\n", nome, (double)ns / n, n);
+}
+
+static void bench_joystick(void) {
+    joystick_t j;
+    joystick_init(&j);
+    uint32_t n = 1000000 * fator;
+    uint64_t t0 = agora_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        // Varre a deflexao inteira para passar por todos os segmentos da curva
+        uint16_t x = (uint16_t)(i * 7 & 0xFFF), y = (uint16_t)(i * 13 & 0xFFF);
+        sumidouro += joystick_atualizar(&j, x, y, 1000);
+        if (joystick_pendente(&j)) {
+            int8_t dx, dy;
+            joystick_extrair(&j, &dx, &dy);
+            sumidouro += (uint32_t)(dx + dy);
+        }
+    }
+    relatar("joystick_atualizar+extrair", agora_ns() - t0, n);
+}
+
+static void bench_vad(void) {
+    vad_t v;
+    vad_init(&v);
+    uint16_t amostras[160];
+    for (int i = 0; i < 160; i++)
+        amostras[i] = (uint16_t)(2048 + (rand() % 401 - 200));
+    uint32_t n = 20000 * fator;
+    uint64_t t0 = agora_ns();
+    for (uint32_t i = 0; i < n; i++)
+        sumidouro += vad_processar(&v, amostras, 160);
+    relatar("vad_processar (160 amostras)", agora_ns() - t0, n);
+}
+
+static void bench_botoes(void) {
+    static const uint8_t pinos[3] = { 22, 5, 6 };
+    botoes_init(pinos, 3);
+    uint32_t n = 200000 * fator;
+    uint64_t t0 = agora_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        hal_host_avancar_us(5000);
+        botoes_tarefa();
+    }
+    relatar("botoes_tarefa (sem bordas)", agora_ns() - t0, n);
+
+    botao_evento_t ev;
+    n = 100000 * fator;
+    t0 = agora_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        hal_host_gpio_definir(pinos[0], i & 1);
+        hal_host_avancar_us(30000);
+        botoes_tarefa();
+        while (botoes_ler_evento(&ev))
+            sumidouro += ev.tipo;
+    }
+    relatar("botoes_tarefa (uma borda)", agora_ns() - t0, n);
+}
+
+static void bench_hid(void) {
+    tusb_init();
+    hid_mouse_init();
+    uint32_t n = 500000 * fator;
+    uint64_t t0 = agora_ns();
+    for (uint32_t i = 0; i < n; i++)
+        hid_mouse_mover(3, -2, time_us_32());
+    relatar("hid_mouse_mover", agora_ns() - t0, n);
+
+    t0 = agora_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        hid_mouse_mover(3, -2, time_us_32());
+        hal_host_avancar_us(1000);
+        tud_task();             // SOF -> relatorio
+    }
+    relatar("hid_mouse_mover+SOF (relatorio)", agora_ns() - t0, n);
+}
+
+static void bench_display(void) {
+    i2c_fila_init(i2c0, 400 * 1000, 14, 15);
+    ssd1306_init(0x3C);
+    const char *texto = "Transcrevendo tela 12";
+    uint32_t n = 200000 * fator;
+    uint64_t t0 = agora_ns();
+    for (uint32_t i = 0; i < n; i++)
+        ssd1306_render_string(texto, 0, 8);
+    relatar("ssd1306_render_string (y alinhado)", agora_ns() - t0, n);
+
+    t0 = agora_ns();
+    for (uint32_t i = 0; i < n; i++)
+        ssd1306_render_string(texto, 0, 13);
+    relatar("ssd1306_render_string (y livre)", agora_ns() - t0, n);
+
+    n = 20000 * fator;
+    t0 = agora_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        ssd1306_clear_area(0, 24, SSD1306_WIDTH, 8);
+        ssd1306_render_string(i & 1 ? "Modo: cursor" : "Modo: rolagem", 0, 24);
+        sumidouro += ssd1306_update();
+    }
+    relatar("linha + ssd1306_update (DMA sim.)", agora_ns() - t0, n);
+
+    ui_init();
+    t0 = agora_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        ui_definir(UI_JOYSTICK, i & 1 ? "Joystick: em uso" : "Joystick: parado");
+        hal_host_avancar_us(UI_QUADRO_MIN_US);
+        ui_tarefa();
+    }
+    relatar("ui_definir+ui_tarefa (1 campo)", agora_ns() - t0, n);
+
+    n = 1000000 * fator;
+    t0 = agora_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        ui_definir(UI_JOYSTICK, "Joystick: parado");
+        ui_tarefa();
+    }
+    relatar("ui_definir+ui_tarefa (sem mudanca)", agora_ns() - t0, n);
+}
+
+static void bench_afinacao(void) {
+    uint32_t n = 200000 * fator;
+    uint64_t t0 = agora_ns();
+    for (uint32_t i = 0; i < n; i++)
+        sumidouro += afinacao_calcular(125000000, 2000 + (i % 400000)).top;
+    relatar("afinacao_calcular", agora_ns() - t0, n);
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1)
+        fator = (uint32_t)atoi(argv[1]) ? (uint32_t)atoi(argv[1]) : 1;
+    hal_host_reiniciar();
+    bench_joystick();
+    bench_vad();
+    bench_botoes();
+    bench_hid();
+    bench_display();
+    bench_afinacao();
+    return 0;
+}
@@ -0,0 +1,1084 @@
+// hal_host.c - HAL simulada para o build de host (HPR_HOST_BUILD)
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "hardware/structs/systick.h"
+#include "tusb.h"
+#include "adc_stream.h"
+#include "hal_host.h"
+
+static hal_host_stats_t stats;
+
+// =====================
+// Tempo virtual
+// =====================
+static uint64_t agora_us;
+static uint32_t sofs_pendentes;
+
+uint64_t hal_host_agora_us(void) {
+    return agora_us;
+}
+
+void hal_host_avancar_us(uint64_t us) {
+    uint64_t antes = agora_us;
+    agora_us += us;
+    sofs_pendentes += (uint32_t)(agora_us / 1000 - antes / 1000);
+}
+
+uint32_t time_us_32(void) { return (uint32_t)agora_us; }
+uint64_t time_us_64(void) { return agora_us; }
+void busy_wait_us(uint64_t us) { hal_host_avancar_us(us); }
+void busy_wait_us_32(uint32_t us) { hal_host_avancar_us(us); }
+
+absolute_time_t get_absolute_time(void) { return agora_us; }
+uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) { return t + us; }
+absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms) { return t + (uint64_t)ms * 1000; }
+absolute_time_t make_timeout_time_us(uint64_t us) { return agora_us + us; }
+absolute_time_t make_timeout_time_ms(uint32_t ms) { return agora_us + (uint64_t)ms * 1000; }
+int64_t absolute_time_diff_us(absolute_time_t de, absolute_time_t ate) { return (int64_t)(ate - de); }
+bool time_reached(absolute_time_t t) { return agora_us >= t; }
+void sleep_us(uint64_t us) { hal_host_avancar_us(us); }
+void sleep_ms(uint32_t ms) { hal_host_avancar_us((uint64_t)ms * 1000); }
+
+// Nada acorda o nucleo antes do prazo: o relogio salta direto para ele
+bool best_effort_wfe_or_timeout(absolute_time_t prazo) {
+    if (prazo > agora_us)
+        hal_host_avancar_us(prazo - agora_us);
+    return true;
+}
+
+systick_hw_t hal_host_systick;
+
+static uint32_t relogios_hz[clk_rtc + 1];
+
+static void relogios_reiniciar(void) {
+    for (int i = 0; i <= clk_rtc; i++)
+        relogios_hz[i] = 125000000;
+    relogios_hz[clk_ref] = 12000000;
+    relogios_hz[clk_usb] = 48000000;
+    relogios_hz[clk_adc] = 48000000;
+    relogios_hz[clk_rtc] = 46875;
+}
+
+bool clock_configure(enum clock_index clk, uint32_t src, uint32_t auxsrc,
+                     uint32_t src_freq, uint32_t freq) {
+    (void)src;
+    (void)auxsrc;
+    if (freq > src_freq)
+        return false;
+    relogios_hz[clk] = freq;
+    return true;
+}
+
+uint32_t clock_get_hz(enum clock_index clk) {
+    return relogios_hz[clk];
+}
+
+// =====================
+// GPIO
+// =====================
+typedef struct {
+    bool forcado;               // nivel ditado pelo roteiro
+    bool nivel_forcado;
+    bool pull_up;
+    bool pull_down;
+    bool saida;
+    bool valor_saida;
+    uint32_t irq_eventos;
+} pino_t;
+
+static pino_t pinos[NUM_BANK0_GPIOS];
+static gpio_irq_callback_t gpio_callback;
+
+// I2C travado (hal_host_i2c_travar): subidas de SCL que faltam para soltar
+static struct {
+    bool travado;
+    uint sda, scl;
+    uint32_t pulsos;
+} i2c_trava;
+
+static void i2c_scl_subiu(void);
+
+static bool pino_nivel(const pino_t *p) {
+    if (p->saida)
+        return p->valor_saida;
+    if (p->forcado)
+        return p->nivel_forcado;
+    return p->pull_up;
+}
+
+// Aplica uma mudanca no pino e gera a IRQ de borda correspondente
+static void pino_mudar(uint gpio, void (*mudanca)(pino_t *p, bool v), bool v) {
+    if (gpio >= NUM_BANK0_GPIOS)
+        return;
+    pino_t *p = &pinos[gpio];
+    bool antes = pino_nivel(p);
+    mudanca(p, v);
+    bool depois = pino_nivel(p);
+    if (i2c_trava.travado && gpio == i2c_trava.scl && !antes && depois)
+        i2c_scl_subiu();
+    if (antes == depois || !gpio_callback)
+        return;
+    uint32_t evento = depois ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+    if (p->irq_eventos & evento)
+        gpio_callback(gpio, evento);
+}
+
+static void mudar_forcado(pino_t *p, bool v) { p->forcado = true; p->nivel_forcado = v; }
+static void mudar_solto(pino_t *p, bool v) { (void)v; p->forcado = false; }
+static void mudar_saida(pino_t *p, bool v) { p->valor_saida = v; }
+static void mudar_direcao(pino_t *p, bool v) { p->saida = v; }
+static void mudar_pull_up(pino_t *p, bool v) { p->pull_up = v; p->pull_down = !v; }
+static void mudar_sem_pull(pino_t *p, bool v) { (void)v; p->pull_up = false; p->pull_down = false; }
+
+void hal_host_gpio_definir(uint pino, bool nivel) { pino_mudar(pino, mudar_forcado, nivel); }
+void hal_host_gpio_soltar(uint pino) { pino_mudar(pino, mudar_solto, false); }
+
+void gpio_init(uint gpio) {
+    if (gpio < NUM_BANK0_GPIOS) {
+        pinos[gpio].saida = false;
+        pinos[gpio].valor_saida = false;
+    }
+}
+void gpio_set_function(uint gpio, enum gpio_function fn) { (void)gpio; (void)fn; }
+void gpio_set_dir(uint gpio, bool saida) { pino_mudar(gpio, mudar_direcao, saida); }
+void gpio_pull_up(uint gpio) { pino_mudar(gpio, mudar_pull_up, true); }
+void gpio_pull_down(uint gpio) { pino_mudar(gpio, mudar_pull_up, false); }
+void gpio_disable_pulls(uint gpio) { pino_mudar(gpio, mudar_sem_pull, false); }
+bool gpio_get(uint gpio) { return gpio < NUM_BANK0_GPIOS && pino_nivel(&pinos[gpio]); }
+void gpio_put(uint gpio, bool valor) { pino_mudar(gpio, mudar_saida, valor); }
+
+void gpio_set_irq_enabled(uint gpio, uint32_t eventos, bool habilitar) {
+    if (gpio >= NUM_BANK0_GPIOS)
+        return;
+    if (habilitar)
+        pinos[gpio].irq_eventos |= eventos;
+    else
+        pinos[gpio].irq_eventos &= ~eventos;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t eventos, bool habilitar,
+                                        gpio_irq_callback_t callback) {
+    gpio_set_irq_enabled(gpio, eventos, habilitar);
+    gpio_callback = callback;
+}
+
+// =====================
+// ADC
+// =====================
+static uint16_t adc_valores[HAL_HOST_ADC_CANAIS];
+static uint adc_entrada;
+
+static void adcs_encher(void);
+
+void hal_host_adc_definir(uint canal, uint16_t valor) {
+    adcs_encher();
+    if (canal < HAL_HOST_ADC_CANAIS)
+        adc_valores[canal] = valor & 0xFFF;
+}
+
+void adc_init(void) {}
+void adc_gpio_init(uint gpio) { (void)gpio; }
+void adc_select_input(uint entrada) { adc_entrada = entrada < HAL_HOST_ADC_CANAIS ? entrada : 0; }
+uint16_t adc_read(void) { return adc_valores[adc_entrada]; }
+
+// =====================
+// Captura continua do ADC (adc_stream.h)
+// =====================
+// O contador de quadros segue o tempo virtual; a cada mudanca de taxa ou
+// de desvio ele guarda a base e recomeca a contar dali. O anel e preenchido
+// sob demanda, quadro a quadro ate o contador, antes de cada leitura e de
+// cada mudanca de valor, taxa, desvio ou fonte: cada quadro fica com o que
+// valia no instante dele.
+#define ADC_STREAM_MARGEM   16      // a mesma folga do adc_stream.c
+
+static const uint8_t adcs_entrada[ADC_STREAM_CANAIS] = { 0, 1, 2, 4 };
+static uint32_t adcs_taxa_hz;
+static int32_t adcs_deriva_ppm;
+static uint64_t adcs_base_us, adcs_base_quadros;
+static uint16_t adcs_anel[ADC_STREAM_QUADROS][ADC_STREAM_CANAIS];
+static uint64_t adcs_escritos;          // quadros ja no anel
+static hal_host_adc_fonte_fn_t adcs_fonte;
+
+static double adcs_hz(void) {
+    return (double)adcs_taxa_hz * (1000000.0 + adcs_deriva_ppm) / 1000000.0;
+}
+
+static uint64_t adcs_contar(void) {
+    return adcs_base_quadros + (uint64_t)((double)(agora_us - adcs_base_us) * adcs_hz() / 1000000.0);
+}
+
+static void adcs_encher(void) {
+    uint64_t fim = adcs_contar();
+    if (fim - adcs_escritos > ADC_STREAM_QUADROS)
+        adcs_escritos = fim - ADC_STREAM_QUADROS;    // o resto seria sobrescrito
+    double ns_por_quadro = adcs_taxa_hz ? 1e9 / adcs_hz() : 0;
+    for (; adcs_escritos < fim; adcs_escritos++) {
+        uint64_t t_ns = adcs_base_us * 1000 +
+                        (uint64_t)((double)(adcs_escritos - adcs_base_quadros) * ns_por_quadro);
+        uint16_t *quadro = adcs_anel[adcs_escritos % ADC_STREAM_QUADROS];
+        for (int c = 0; c < ADC_STREAM_CANAIS; c++) {
+            uint entrada = adcs_entrada[c];
+            uint16_t v = adc_valores[entrada];
+            if (adcs_fonte)
+                v = adcs_fonte(entrada, t_ns, v);
+            quadro[c] = v & 0xFFF;
+        }
+    }
+}
+
+static void adcs_rebase(void) {
+    adcs_encher();
+    adcs_base_quadros = adcs_contar();
+    adcs_base_us = agora_us;
+}
+
+void hal_host_adc_deriva(int32_t ppm) {
+    adcs_rebase();
+    adcs_deriva_ppm = ppm;
+}
+
+void hal_host_adc_fonte(hal_host_adc_fonte_fn_t fn) {
+    adcs_encher();
+    adcs_fonte = fn;
+}
+
+void adc_stream_set_taxa(uint32_t taxa_por_canal_hz) {
+    // Mesmo arredondamento do divisor do adc_stream.c
+    uint32_t clk_adc_hz = clock_get_hz(clk_adc);
+    uint32_t taxa_total = taxa_por_canal_hz * ADC_STREAM_CANAIS;
+    uint32_t ciclos = taxa_total ? clk_adc_hz / taxa_total : 96;
+    if (ciclos < 96)
+        ciclos = 96;
+    adcs_rebase();
+    adcs_taxa_hz = clk_adc_hz / ciclos / ADC_STREAM_CANAIS;
+}
+
+void adc_stream_init(uint32_t taxa_por_canal_hz) {
+    adcs_base_us = agora_us;
+    adcs_base_quadros = adcs_escritos = 0;
+    adcs_taxa_hz = 0;
+    memset(adcs_anel, 0, sizeof(adcs_anel));
+    adc_stream_set_taxa(taxa_por_canal_hz);
+}
+
+uint32_t adc_stream_taxa_hz(void) {
+    return adcs_taxa_hz;
+}
+
+uint32_t adc_stream_quadros(void) {
+    return (uint32_t)adcs_contar();
+}
+
+static uint16_t adcs_amostra(uint32_t quadro, uint8_t canal) {
+    return adcs_anel[quadro % ADC_STREAM_QUADROS][canal % ADC_STREAM_CANAIS];
+}
+
+uint16_t adc_stream_ultima(uint8_t canal) {
+    adcs_encher();
+    return adcs_amostra(adc_stream_quadros() - 1, canal);
+}
+
+uint16_t adc_stream_media(uint8_t canal, uint32_t n) {
+    if (n == 0)
+        return adc_stream_ultima(canal);
+    if (n > ADC_STREAM_QUADROS - ADC_STREAM_MARGEM)
+        n = ADC_STREAM_QUADROS - ADC_STREAM_MARGEM;
+    adcs_encher();
+    uint32_t fim = adc_stream_quadros();
+    uint32_t soma = 0;
+    for (uint32_t q = fim - n; q != fim; q++)
+        soma += adcs_amostra(q, canal);
+    return (uint16_t)((soma + n / 2) / n);
+}
+
+uint32_t adc_stream_ler(uint8_t canal, uint32_t *cursor, uint16_t *dest,
+                        uint32_t max, uint32_t *perdidas) {
+    adcs_encher();
+    uint32_t disponiveis = adc_stream_quadros() - *cursor;
+    uint32_t pulados = 0;
+    if (disponiveis > ADC_STREAM_QUADROS - ADC_STREAM_MARGEM) {
+        pulados = disponiveis - (ADC_STREAM_QUADROS - ADC_STREAM_MARGEM);
+        *cursor += pulados;
+        disponiveis -= pulados;
+    }
+    if (perdidas)
+        *perdidas = pulados;
+    uint32_t n = disponiveis < max ? disponiveis : max;
+    for (uint32_t i = 0; i < n; i++)
+        dest[i] = adcs_amostra(*cursor + i, canal);
+    *cursor += n;
+    return n;
+}
+
+// =====================
+// IRQ
+// =====================
+#define IRQ_NUMEROS         32
+#define IRQ_TRATADORES      4
+
+static irq_handler_t irq_tratadores[IRQ_NUMEROS][IRQ_TRATADORES];
+static bool irq_habilitada[IRQ_NUMEROS];
+
+void irq_set_exclusive_handler(uint num, irq_handler_t tratador) {
+    if (num >= IRQ_NUMEROS)
+        return;
+    memset(irq_tratadores[num], 0, sizeof(irq_tratadores[num]));
+    irq_tratadores[num][0] = tratador;
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t tratador, uint8_t prioridade) {
+    (void)prioridade;
+    if (num >= IRQ_NUMEROS)
+        return;
+    for (int i = 0; i < IRQ_TRATADORES; i++) {
+        if (!irq_tratadores[num][i]) {
+            irq_tratadores[num][i] = tratador;
+            return;
+        }
+    }
+}
+
+void irq_set_enabled(uint num, bool habilitar) {
+    if (num < IRQ_NUMEROS)
+        irq_habilitada[num] = habilitar;
+}
+
+static void irq_chamar(uint num) {
+    if (!irq_habilitada[num])
+        return;
+    for (int i = 0; i < IRQ_TRATADORES && irq_tratadores[num][i]; i++)
+        irq_tratadores[num][i]();
+}
+
+// =====================
+// SSD1306 simulado (escravo I2C)
+// =====================
+static struct {
+    uint8_t ram[HAL_HOST_SSD1306_PAGINAS * HAL_HOST_SSD1306_COLUNAS];
+    bool inicio;                // proximo byte e um byte de controle
+    bool dados;                 // D/C do controle atual
+    bool continuo;              // Co = 0: o resto da transacao segue o controle
+    uint8_t cmd;
+    uint8_t args[2];
+    uint8_t n_args, args_faltando;
+    uint8_t col_ini, col_fim, pag_ini, pag_fim;
+    uint8_t col, pag;
+    uint8_t contraste;
+    bool ligado;
+} oled;
+
+static void oled_reiniciar(void) {
+    memset(&oled, 0, sizeof(oled));
+    oled.inicio = true;
+    oled.col_fim = HAL_HOST_SSD1306_COLUNAS - 1;
+    oled.pag_fim = HAL_HOST_SSD1306_PAGINAS - 1;
+    oled.contraste = 0x7F;      // valor de reset do controlador
+}
+
+static void oled_comando(uint8_t b) {
+    if (oled.args_faltando) {
+        oled.args[oled.n_args++] = b;
+        if (--oled.args_faltando)
+            return;
+        if (oled.cmd == 0x21) {
+            oled.col_ini = oled.args[0] & 0x7F;
+            oled.col_fim = oled.args[1] & 0x7F;
+            oled.col = oled.col_ini;
+        } else if (oled.cmd == 0x22) {
+            oled.pag_ini = oled.args[0] & 0x07;
+            oled.pag_fim = oled.args[1] & 0x07;
+            oled.pag = oled.pag_ini;
+        } else if (oled.cmd == 0x81) {
+            oled.contraste = oled.args[0];
+        }
+        return;
+    }
+    oled.cmd = b;
+    oled.n_args = 0;
+    switch (b) {
+    case 0x21: case 0x22:
+        oled.args_faltando = 2;
+        break;
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+    case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        oled.args_faltando = 1;
+        break;
+    case 0xAE: case 0xAF:
+        oled.ligado = b & 0x01;
+        break;
+    default:
+        if (b >= 0xB0 && b <= 0xB7)
+            oled.pag = b & 0x07;
+        break;
+    }
+}
+
+// Enderecamento horizontal dentro da janela 0x21/0x22
+static void oled_dado(uint8_t b) {
+    oled.ram[oled.pag * HAL_HOST_SSD1306_COLUNAS + oled.col] = b;
+    if (oled.col++ < oled.col_fim)
+        return;
+    oled.col = oled.col_ini;
+    if (oled.pag++ >= oled.pag_fim)
+        oled.pag = oled.pag_ini;
+}
+
+static void oled_byte(uint8_t b, bool stop) {
+    if (oled.inicio) {
+        oled.dados = b & 0x40;
+        oled.continuo = !(b & 0x80);
+        oled.inicio = false;
+    } else {
+        if (oled.dados)
+            oled_dado(b);
+        else
+            oled_comando(b);
+        if (!oled.continuo)
+            oled.inicio = true;
+    }
+    if (stop) {
+        oled.inicio = true;
+        stats.i2c_transacoes++;
+    }
+}
+
+const uint8_t *hal_host_ssd1306_ram(void) {
+    return oled.ram;
+}
+
+uint8_t hal_host_ssd1306_contraste(void) {
+    return oled.contraste;
+}
+
+bool hal_host_ssd1306_ligado(void) {
+    return oled.ligado;
+}
+
+// =====================
+// I2C
+// =====================
+i2c_inst_t i2c0_inst = { .indice = 0 };
+i2c_inst_t i2c1_inst = { .indice = 1 };
+
+static void dma_retomar_i2c(void);
+
+static void i2c_status(void) {
+    uint32_t status = i2c_trava.travado ? I2C_IC_STATUS_ACTIVITY_BITS
+                                        : I2C_IC_STATUS_TFE_BITS | I2C_IC_STATUS_TFNF_BITS;
+    i2c0_inst.hw.status = status;
+    i2c1_inst.hw.status = status;
+}
+
+static bool i2c_destino(uintptr_t escrita) {
+    return escrita == (uintptr_t)&i2c0_inst.hw.data_cmd || escrita == (uintptr_t)&i2c1_inst.hw.data_cmd;
+}
+
+void hal_host_i2c_travar(uint pino_sda, uint pino_scl, uint32_t pulsos) {
+    i2c_trava.travado = true;
+    i2c_trava.sda = pino_sda;
+    i2c_trava.scl = pino_scl;
+    i2c_trava.pulsos = pulsos;
+    i2c_status();
+    hal_host_gpio_definir(pino_sda, false);
+}
+
+void hal_host_i2c_soltar(void) {
+    if (!i2c_trava.travado)
+        return;
+    i2c_trava.travado = false;
+    i2c_status();
+    hal_host_gpio_soltar(i2c_trava.sda);
+    dma_retomar_i2c();
+}
+
+static void i2c_scl_subiu(void) {
+    if (i2c_trava.pulsos && --i2c_trava.pulsos == 0)
+        hal_host_i2c_soltar();
+}
+
+static void i2c_palavra(i2c_inst_t *i2c, uint32_t palavra) {
+    (void)i2c;
+    stats.i2c_bytes++;
+    oled_byte((uint8_t)palavra, palavra & I2C_IC_DATA_CMD_STOP_BITS);
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate) {
+    i2c->baudrate = baudrate;
+    i2c->clk_sys_hz = clock_get_hz(clk_sys);
+    return baudrate;
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    i2c->hw.tar = 0x55;
+    i2c->hw.enable = I2C_IC_ENABLE_ENABLE_BITS;
+    i2c->hw.raw_intr_stat = 0;
+    i2c_status();
+    return i2c_set_baudrate(i2c, baudrate);
+}
+
+uint32_t hal_host_i2c_scl_hz(void) {
+    if (i2c0_inst.clk_sys_hz == 0)
+        return 0;
+    return (uint32_t)((uint64_t)i2c0_inst.baudrate * clock_get_hz(clk_sys) / i2c0_inst.clk_sys_hz);
+}
+
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c) {
+    return &i2c->hw;
+}
+
+uint i2c_get_dreq(i2c_inst_t *i2c, bool tx) {
+    return 32 + i2c->indice * 2 + (tx ? 0 : 1);
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)addr;
+    for (size_t i = 0; i < len; i++)
+        i2c_palavra(i2c, src[i] | (i + 1 == len && !nostop ? I2C_IC_DATA_CMD_STOP_BITS : 0));
+    return (int)len;
+}
+
+// =====================
+// DMA
+// =====================
+// Campos do CTRL, como no RP2040
+#define CTRL_EN             (1u << 0)
+#define CTRL_DATA_SIZE_LSB  2
+#define CTRL_INCR_READ      (1u << 4)
+#define CTRL_INCR_WRITE     (1u << 5)
+#define CTRL_RING_SIZE_LSB  6
+#define CTRL_RING_SEL       (1u << 10)
+#define CTRL_CHAIN_TO_LSB   11
+#define CTRL_TREQ_SEL_LSB   15
+#define CTRL_IRQ_QUIET      (1u << 21)
+
+// Registrador canonico de cada palavra dos 4 aliases
+enum { REG_READ, REG_WRITE, REG_COUNT, REG_CTRL };
+static const uint8_t dma_alias[16] = {
+    REG_READ, REG_WRITE, REG_COUNT, REG_CTRL,
+    REG_CTRL, REG_READ, REG_WRITE, REG_COUNT,
+    REG_CTRL, REG_COUNT, REG_READ, REG_WRITE,
+    REG_CTRL, REG_WRITE, REG_COUNT, REG_READ,
+};
+
+typedef struct {
+    uintptr_t leitura;
+    uintptr_t escrita;
+    uint32_t contagem;          // valor de recarga de TRANS_COUNT
+    uint32_t ctrl;
+    bool reclamado;
+    bool na_fila;
+    bool parado;                // escrita no I2C travado; retoma ao soltar
+} canal_t;
+
+dma_hw_t hal_host_dma;
+static canal_t canais[NUM_DMA_CHANNELS];
+static bool timers_reclamados[NUM_DMA_TIMERS];
+static uint8_t dma_fila[NUM_DMA_CHANNELS];
+static uint8_t dma_fila_n;
+static bool dma_processando;
+
+static void dma_irq_sinalizar(uint canal) {
+    hal_host_dma.intr |= 1u << canal;
+    hal_host_dma.ints0 = hal_host_dma.intr & hal_host_dma.inte0;
+    hal_host_dma.ints1 = hal_host_dma.intr & hal_host_dma.inte1;
+}
+
+static void dma_enfileirar(uint canal) {
+    if (canal >= NUM_DMA_CHANNELS || canais[canal].na_fila)
+        return;
+    canais[canal].na_fila = true;
+    dma_fila[dma_fila_n++] = (uint8_t)canal;
+}
+
+// Escrita num registrador de disparo: valor nulo nao inicia o canal e, com
+// IRQ_QUIET, sinaliza a IRQ (fim de lista de blocos de controle)
+static void dma_disparo(uint canal, uintptr_t valor) {
+    if (valor == 0) {
+        if (canais[canal].ctrl & CTRL_IRQ_QUIET)
+            dma_irq_sinalizar(canal);
+        return;
+    }
+    if (canais[canal].ctrl & CTRL_EN)
+        dma_enfileirar(canal);
+}
+
+static uintptr_t alinhar(uintptr_t p, uintptr_t a) {
+    return (p + a - 1) & ~(a - 1);
+}
+
+// Um elemento escrito na janela de registradores da DMA: aplica o valor e
+// avanca *leitura pelo que foi lido, com o alinhamento natural do campo.
+static void dma_registrador(uintptr_t destino, uintptr_t *leitura, bool incr) {
+    uintptr_t indice = (destino - (uintptr_t)hal_host_dma.ch) / 4;
+    uint canal = (uint)(indice / 16);
+    uint alias = (uint)(indice % 16);
+    canal_t *c = &canais[canal];
+    uint reg = dma_alias[alias];
+    uintptr_t valor;
+    if (reg == REG_READ || reg == REG_WRITE) {
+        uintptr_t p = alinhar(*leitura, sizeof(void *));
+        memcpy(&valor, (const void *)p, sizeof(void *));
+        if (incr)
+            *leitura = p + sizeof(void *);
+    } else {
+        uint32_t v;
+        uintptr_t p = alinhar(*leitura, 4);
+        memcpy(&v, (const void *)p, 4);
+        valor = v;
+        if (incr)
+            *leitura = p + 4;
+    }
+    switch (reg) {
+    case REG_READ:  c->leitura = valor; break;
+    case REG_WRITE: c->escrita = valor; break;
+    case REG_COUNT: c->contagem = (uint32_t)valor; break;
+    case REG_CTRL:  c->ctrl = (uint32_t)valor; break;
+    }
+    if ((alias & 3) == 3)
+        dma_disparo(canal, valor);
+}
+
+static void dma_executar(uint canal) {
+    canal_t *c = &canais[canal];
+    if (i2c_trava.travado && i2c_destino(c->escrita)) {
+        c->parado = true;
+        return;
+    }
+    uint tamanho = 1u << ((c->ctrl >> CTRL_DATA_SIZE_LSB) & 3);
+    bool incr_leitura = c->ctrl & CTRL_INCR_READ;
+    bool incr_escrita = c->ctrl & CTRL_INCR_WRITE;
+    uint anel = (c->ctrl >> CTRL_RING_SIZE_LSB) & 0xF;
+    uintptr_t mascara_anel = anel ? ((uintptr_t)1 << anel) - 1 : 0;
+    bool anel_escrita = c->ctrl & CTRL_RING_SEL;
+
+    uintptr_t regs_ini = (uintptr_t)hal_host_dma.ch;
+    uintptr_t regs_fim = (uintptr_t)&hal_host_dma.ch[NUM_DMA_CHANNELS];
+
+    for (uint32_t i = 0; i < c->contagem; i++) {
+        uintptr_t leitura = c->leitura;
+        if (c->escrita >= regs_ini && c->escrita < regs_fim) {
+            dma_registrador(c->escrita, &leitura, incr_leitura);
+        } else {
+            uint32_t v = 0;
+            memcpy(&v, (const void *)c->leitura, tamanho);
+            if (i2c_destino(c->escrita))
+                i2c_palavra(c->escrita == (uintptr_t)&i2c0_inst.hw.data_cmd ? &i2c0_inst : &i2c1_inst, v);
+            else
+                memcpy((void *)c->escrita, &v, tamanho);
+            if (incr_leitura)
+                leitura += tamanho;
+        }
+        stats.dma_transferencias++;
+
+        if (anel && !anel_escrita)
+            leitura = (c->leitura & ~mascara_anel) | (leitura & mascara_anel);
+        c->leitura = leitura;
+        if (incr_escrita) {
+            uintptr_t escrita = c->escrita + tamanho;
+            if (anel && anel_escrita)
+                escrita = (c->escrita & ~mascara_anel) | (escrita & mascara_anel);
+            c->escrita = escrita;
+        }
+    }
+
+    uint encadeado = (c->ctrl >> CTRL_CHAIN_TO_LSB) & 0xF;
+    if (encadeado != canal)
+        dma_enfileirar(encadeado);
+    if (!(c->ctrl & CTRL_IRQ_QUIET))
+        dma_irq_sinalizar(canal);
+}
+
+// Roda os canais disparados e entrega as IRQs, que podem disparar outros
+static void dma_processar(void) {
+    if (dma_processando)
+        return;
+    dma_processando = true;
+    for (;;) {
+        if (dma_fila_n) {
+            uint canal = dma_fila[0];
+            memmove(dma_fila, dma_fila + 1, --dma_fila_n);
+            canais[canal].na_fila = false;
+            dma_executar(canal);
+            continue;
+        }
+        uint32_t pendentes = hal_host_dma.ints0 | (hal_host_dma.ints1 << 16);
+        if (!pendentes)
+            break;
+        if (hal_host_dma.ints0)
+            irq_chamar(DMA_IRQ_0);
+        if (hal_host_dma.ints1)
+            irq_chamar(DMA_IRQ_1);
+        // IRQ sem ninguem para reconhecer: fica pendente, como no hardware
+        if ((hal_host_dma.ints0 | (hal_host_dma.ints1 << 16)) == pendentes && !dma_fila_n)
+            break;
+    }
+    dma_processando = false;
+}
+
+int dma_claim_unused_channel(bool obrigatorio) {
+    (void)obrigatorio;
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        if (!canais[i].reclamado) {
+            canais[i].reclamado = true;
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void dma_channel_unclaim(uint canal) {
+    if (canal < NUM_DMA_CHANNELS)
+        canais[canal].reclamado = false;
+}
+
+int dma_claim_unused_timer(bool obrigatorio) {
+    (void)obrigatorio;
+    for (uint i = 0; i < NUM_DMA_TIMERS; i++) {
+        if (!timers_reclamados[i]) {
+            timers_reclamados[i] = true;
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void dma_timer_set_fraction(uint timer, uint16_t numerador, uint16_t denominador) {
+    (void)timer; (void)numerador; (void)denominador;
+}
+
+uint dma_get_timer_dreq(uint timer) {
+    return 0x3b + timer;
+}
+
+dma_channel_config dma_channel_get_default_config(uint canal) {
+    dma_channel_config c = {
+        CTRL_EN | ((uint32_t)DMA_SIZE_32 << CTRL_DATA_SIZE_LSB) | CTRL_INCR_READ |
+        ((uint32_t)canal << CTRL_CHAIN_TO_LSB) | ((uint32_t)DREQ_FORCE << CTRL_TREQ_SEL_LSB)
+    };
+    return c;
+}
+
+dma_channel_config dma_get_channel_config(uint canal) {
+    dma_channel_config c = { canais[canal].ctrl };
+    return c;
+}
+
+static void ctrl_bit(dma_channel_config *c, uint32_t bit, bool v) {
+    c->ctrl = v ? c->ctrl | bit : c->ctrl & ~bit;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) { ctrl_bit(c, CTRL_INCR_READ, incr); }
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) { ctrl_bit(c, CTRL_INCR_WRITE, incr); }
+void channel_config_set_irq_quiet(dma_channel_config *c, bool quieto) { ctrl_bit(c, CTRL_IRQ_QUIET, quieto); }
+void channel_config_set_enable(dma_channel_config *c, bool habilitar) { ctrl_bit(c, CTRL_EN, habilitar); }
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) {
+    c->ctrl = (c->ctrl & ~(0x3Fu << CTRL_TREQ_SEL_LSB)) | ((dreq & 0x3F) << CTRL_TREQ_SEL_LSB);
+}
+
+void channel_config_set_chain_to(dma_channel_config *c, uint canal) {
+    c->ctrl = (c->ctrl & ~(0xFu << CTRL_CHAIN_TO_LSB)) | ((canal & 0xF) << CTRL_CHAIN_TO_LSB);
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size tamanho) {
+    c->ctrl = (c->ctrl & ~(3u << CTRL_DATA_SIZE_LSB)) | ((uint32_t)tamanho << CTRL_DATA_SIZE_LSB);
+}
+
+void channel_config_set_ring(dma_channel_config *c, bool escrita, uint bits) {
+    c->ctrl = (c->ctrl & ~(0xFu << CTRL_RING_SIZE_LSB)) | ((bits & 0xF) << CTRL_RING_SIZE_LSB);
+    ctrl_bit(c, CTRL_RING_SEL, escrita);
+}
+
+uint32_t channel_config_get_ctrl_value(const dma_channel_config *c) {
+    return c->ctrl;
+}
+
+void dma_channel_set_config(uint canal, const dma_channel_config *c, bool disparar) {
+    canais[canal].ctrl = c->ctrl;
+    if (disparar)
+        dma_channel_start(canal);
+}
+
+void dma_channel_configure(uint canal, const dma_channel_config *c, volatile void *escrita,
+                           const volatile void *leitura, uint contagem, bool disparar) {
+    canais[canal].escrita = (uintptr_t)escrita;
+    canais[canal].leitura = (uintptr_t)leitura;
+    canais[canal].contagem = contagem;
+    dma_channel_set_config(canal, c, disparar);
+}
+
+void dma_channel_set_read_addr(uint canal, const volatile void *leitura, bool disparar) {
+    canais[canal].leitura = (uintptr_t)leitura;
+    if (disparar)
+        dma_channel_start(canal);
+}
+
+void dma_channel_set_write_addr(uint canal, volatile void *escrita, bool disparar) {
+    canais[canal].escrita = (uintptr_t)escrita;
+    if (disparar)
+        dma_channel_start(canal);
+}
+
+void dma_channel_set_trans_count(uint canal, uint32_t contagem, bool disparar) {
+    canais[canal].contagem = contagem;
+    if (disparar)
+        dma_channel_start(canal);
+}
+
+void dma_channel_start(uint canal) {
+    dma_enfileirar(canal);
+    dma_processar();
+}
+
+void dma_channel_abort(uint canal) {
+    canais[canal].parado = false;
+    if (!canais[canal].na_fila)
+        return;
+    for (uint i = 0; i < dma_fila_n; i++) {
+        if (dma_fila[i] == canal) {
+            memmove(&dma_fila[i], &dma_fila[i + 1], --dma_fila_n - i);
+            break;
+        }
+    }
+    canais[canal].na_fila = false;
+}
+
+bool dma_channel_is_busy(uint canal) {
+    return canais[canal].na_fila || canais[canal].parado;
+}
+
+static void dma_retomar_i2c(void) {
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        if (canais[i].parado) {
+            canais[i].parado = false;
+            dma_enfileirar(i);
+        }
+    }
+    dma_processar();
+}
+
+void dma_channel_set_irq0_enabled(uint canal, bool habilitar) {
+    if (habilitar)
+        hal_host_dma.inte0 |= 1u << canal;
+    else
+        hal_host_dma.inte0 &= ~(1u << canal);
+    hal_host_dma.ints0 = hal_host_dma.intr & hal_host_dma.inte0;
+}
+
+void dma_channel_set_irq1_enabled(uint canal, bool habilitar) {
+    if (habilitar)
+        hal_host_dma.inte1 |= 1u << canal;
+    else
+        hal_host_dma.inte1 &= ~(1u << canal);
+    hal_host_dma.ints1 = hal_host_dma.intr & hal_host_dma.inte1;
+}
+
+bool dma_channel_get_irq0_status(uint canal) { return hal_host_dma.ints0 & (1u << canal); }
+bool dma_channel_get_irq1_status(uint canal) { return hal_host_dma.ints1 & (1u << canal); }
+
+void dma_channel_acknowledge_irq0(uint canal) {
+    hal_host_dma.intr &= ~(1u << canal);
+    hal_host_dma.ints0 = hal_host_dma.intr & hal_host_dma.inte0;
+    hal_host_dma.ints1 = hal_host_dma.intr & hal_host_dma.inte1;
+}
+
+void dma_channel_acknowledge_irq1(uint canal) {
+    dma_channel_acknowledge_irq0(canal);
+}
+
+// =====================
+// Flash
+// =====================
+// Persiste entre hal_host_reiniciar(), como a flash de verdade; so comeca
+// apagada
+uint8_t hal_host_flash[PICO_FLASH_SIZE_BYTES];
+
+__attribute__((constructor)) static void flash_apagar_tudo(void) {
+    memset(hal_host_flash, 0xFF, sizeof(hal_host_flash));
+}
+
+void flash_range_erase(uint32_t offset, size_t n) {
+    if (offset % FLASH_SECTOR_SIZE || n % FLASH_SECTOR_SIZE || offset + n > sizeof(hal_host_flash))
+        return;
+    memset(&hal_host_flash[offset], 0xFF, n);
+    stats.flash_setores_apagados += n / FLASH_SECTOR_SIZE;
+}
+
+void flash_range_program(uint32_t offset, const uint8_t *dados, size_t n) {
+    if (offset % FLASH_PAGE_SIZE || n % FLASH_PAGE_SIZE || offset + n > sizeof(hal_host_flash))
+        return;
+    for (size_t i = 0; i < n; i++)
+        hal_host_flash[offset + i] &= dados[i];
+    stats.flash_paginas_gravadas += n / FLASH_PAGE_SIZE;
+}
+
+// =====================
+// TinyUSB minimo
+// =====================
+static bool usb_montado = true, usb_suspenso = false;
+static bool hid_ocupado, hid_em_transito[HAL_HOST_HID_INSTANCIAS];
+static bool sof_habilitado;
+static uint32_t sof_quadro;
+static hal_host_hid_fn_t hid_observador;
+static bool audio_aberto;
+static uint8_t audio_fifo[CFG_TUD_AUDIO_EP_SZ_IN];
+static uint16_t audio_fifo_n;
+
+void hal_host_usb_definir(bool montado, bool suspenso) {
+    usb_montado = montado;
+    usb_suspenso = suspenso;
+}
+
+void hal_host_hid_ocupado(bool ocupado) { hid_ocupado = ocupado; }
+void hal_host_hid_observar(hal_host_hid_fn_t fn) { hid_observador = fn; }
+
+void hal_host_audio_abrir(uint8_t itf, bool aberto) {
+    tusb_control_request_t req = { .bmRequestType = 0x01, .bRequest = 0x0B,
+                                   .wValue = aberto, .wIndex = itf };
+    if (aberto)
+        tud_audio_set_itf_cb(0, &req);
+    else if (audio_aberto)
+        tud_audio_set_itf_close_EP_cb(0, &req);
+    audio_aberto = aberto;
+    audio_fifo_n = 0;
+}
+
+uint16_t tud_audio_write(const void *dados, uint16_t len) {
+    uint16_t livre = (uint16_t)(sizeof(audio_fifo) - audio_fifo_n);
+    if (len > livre)
+        len = livre;
+    memcpy(&audio_fifo[audio_fifo_n], dados, len);
+    audio_fifo_n += len;
+    return len;
+}
+
+bool tud_audio_buffer_and_schedule_control_xfer(uint8_t rhport, tusb_control_request_t const *p_request,
+                                                void *dados, uint16_t len) {
+    (void)rhport; (void)p_request; (void)dados; (void)len;
+    return true;
+}
+
+bool tusb_init(void) { return true; }
+bool tud_mounted(void) { return usb_montado; }
+bool tud_suspended(void) { return usb_suspenso; }
+bool tud_remote_wakeup(void) {
+    if (!usb_suspenso)
+        return false;
+    stats.usb_retomadas++;
+    return true;
+}
+void tud_sof_cb_enable(bool habilitar) { sof_habilitado = habilitar; }
+
+// Cada SOF libera o endpoint (o host busca um relatorio por quadro) e
+// chama o callback, como o tud_task() do dispositivo. Com o audio aberto o
+// pacote armado sai no primeiro SOF e o proximo e pedido uma vez so: nos
+// SOFs seguintes de um tud_task() atrasado o endpoint nao tinha pacote.
+void tud_task(void) {
+    uint32_t quadros = sofs_pendentes;
+    while (sofs_pendentes) {
+        sofs_pendentes--;
+        sof_quadro = (sof_quadro + 1) & 0x7FF;
+        memset(hid_em_transito, 0, sizeof(hid_em_transito));
+        if (sof_habilitado && usb_montado && !usb_suspenso) {
+            stats.sofs++;
+            tud_sof_cb(sof_quadro);
+        }
+    }
+    if (quadros && audio_aberto && usb_montado && !usb_suspenso) {
+        stats.audio_pacotes++;
+        stats.audio_bytes += audio_fifo_n;
+        stats.audio_sem_pacote += quadros - 1;
+        audio_fifo_n = 0;
+        tud_audio_tx_done_pre_load_cb(0, 0, 0x81, 1);
+    }
+}
+
+bool tud_hid_n_ready(uint8_t instancia) {
+    return instancia < HAL_HOST_HID_INSTANCIAS && usb_montado && !usb_suspenso &&
+           !hid_ocupado && !hid_em_transito[instancia];
+}
+
+bool tud_hid_n_report(uint8_t instancia, uint8_t report_id, const void *relatorio, uint16_t len) {
+    if (!tud_hid_n_ready(instancia)) {
+        stats.hid_recusados++;
+        return false;
+    }
+    uint8_t buf[64];
+    uint16_t n = 0;
+    if (report_id)
+        buf[n++] = report_id;
+    if (len > sizeof(buf) - n)
+        len = sizeof(buf) - n;
+    memcpy(&buf[n], relatorio, len);
+    n += len;
+    hid_em_transito[instancia] = true;
+    stats.hid_relatorios++;
+    if (hid_observador)
+        hid_observador(instancia, buf, n);
+    tud_hid_report_complete_cb(instancia, buf, n);
+    return true;
+}
+
+bool tud_hid_ready(void) {
+    return tud_hid_n_ready(0);
+}
+
+bool tud_hid_report(uint8_t report_id, const void *relatorio, uint16_t len) {
+    return tud_hid_n_report(0, report_id, relatorio, len);
+}
+
+bool tud_hid_mouse_report(uint8_t report_id, uint8_t botoes, int8_t x, int8_t y,
+                          int8_t vertical, int8_t horizontal) {
+    int8_t r[5] = { (int8_t)botoes, x, y, vertical, horizontal };
+    return tud_hid_report(report_id, r, sizeof(r));
+}
+
+// =====================
+// Controle
+// =====================
+void hal_host_get_stats(hal_host_stats_t *s) {
+    *s = stats;
+}
+
+void hal_host_reiniciar(void) {
+    agora_us = 0;
+    sofs_pendentes = 0;
+    memset(&stats, 0, sizeof(stats));
+    relogios_reiniciar();
+    memset(pinos, 0, sizeof(pinos));
+    gpio_callback = NULL;
+    memset(&i2c_trava, 0, sizeof(i2c_trava));
+    i2c0_inst.baudrate = i2c1_inst.baudrate = 0;
+    i2c0_inst.clk_sys_hz = i2c1_inst.clk_sys_hz = 0;
+    memset(adc_valores, 0, sizeof(adc_valores));
+    adc_entrada = 0;
+    memset(irq_tratadores, 0, sizeof(irq_tratadores));
+    memset(irq_habilitada, 0, sizeof(irq_habilitada));
+    oled_reiniciar();
+    memset(&hal_host_dma, 0, sizeof(hal_host_dma));
+    memset(canais, 0, sizeof(canais));
+    memset(timers_reclamados, 0, sizeof(timers_reclamados));
+    dma_fila_n = 0;
+    usb_montado = true;
+    usb_suspenso = false;
+    hid_ocupado = false;
+    memset(hid_em_transito, 0, sizeof(hid_em_transito));
+    sof_habilitado = false;
+    sof_quadro = 0;
+    audio_aberto = false;
+    audio_fifo_n = 0;
+    adcs_taxa_hz = 0;
+    adcs_deriva_ppm = 0;
+    adcs_base_us = adcs_base_quadros = 0;
+    adcs_escritos = 0;
+    adcs_fonte = NULL;
+    memset(adcs_anel, 0, sizeof(adcs_anel));
+}
@@ -0,0 +1,105 @@
+// hal_host.h - Controle da HAL simulada, usado pelo roteiro e pelos benchmarks
+//
+// A HAL substitui o SDK do Pico no build de host (HPR_HOST_BUILD): tempo
+// virtual, GPIO e ADC com valores ditados pelo roteiro, DMA executada na
+// hora, I2C ligado a um SSD1306 simulado e um TinyUSB minimo que registra
+// os relatorios HID e os pacotes de audio. A captura do ADC (adc_stream.h)
+// e a da HAL: a DMA executada na hora nao tem o ritmo do DREQ do ADC. O
+// anel dela tem o tamanho e a ordem de canais do adc_stream.c, com cada
+// quadro amostrado no seu instante virtual.
+//
+// Diferenca do hardware: enderecos sao ponteiros nativos (64 bits). Quando
+// um canal de DMA copia blocos de controle para os registradores de outro
+// canal, cada registrador de endereco le um ponteiro inteiro, com o
+// alinhamento natural, como a struct do bloco fica em C no host.
+
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/types.h"
+
+#define HAL_HOST_ADC_CANAIS         5
+#define HAL_HOST_SSD1306_PAGINAS    8
+#define HAL_HOST_SSD1306_COLUNAS    128
+
+// Volta tudo ao estado de reset (tempo 0, pinos soltos, canais livres)
+void hal_host_reiniciar(void);
+
+// Tempo virtual; cada fronteira de 1 ms cruzada gera um SOF pendente,
+// entregue no proximo tud_task()
+uint64_t hal_host_agora_us(void);
+void hal_host_avancar_us(uint64_t us);
+
+// Forca o nivel de uma entrada; chama a IRQ de borda, se habilitada
+void hal_host_gpio_definir(uint pino, bool nivel);
+// Solta o pino: volta a ler o pull configurado
+void hal_host_gpio_soltar(uint pino);
+
+void hal_host_adc_definir(uint canal, uint16_t valor);
+
+// Desvio do relogio do ADC em relacao ao tempo virtual (o do host USB), em
+// partes por milhao: o contador de quadros de adc_stream_quadros() corre
+// na taxa pedida vezes (1 + ppm / 10^6), e cada quadro tem os valores de
+// hal_host_adc_definir() do momento
+void hal_host_adc_deriva(int32_t ppm);
+
+// Sinal variando dentro do quadro de tempo: cada amostra de cada quadro do
+// anel (entrada do ADC e instante em ns de tempo virtual) passa pela fonte,
+// que recebe o valor de hal_host_adc_definir() e devolve o amostrado. NULL
+// volta aos valores fixos. Quadros ja capturados nao mudam.
+typedef uint16_t (*hal_host_adc_fonte_fn_t)(uint entrada, uint64_t t_ns, uint16_t valor);
+void hal_host_adc_fonte(hal_host_adc_fonte_fn_t fn);
+
+// Estado do USB e dos endpoints HID (ocupado vale para todas as instancias)
+#define HAL_HOST_HID_INSTANCIAS 2
+void hal_host_usb_definir(bool montado, bool suspenso);
+void hal_host_hid_ocupado(bool ocupado);
+
+// Cada relatorio HID aceito por tud_hid_n_report() e entregue aqui, com a
+// instancia (usb_descriptors.h) e o report ID a frente se houver
+typedef void (*hal_host_hid_fn_t)(uint8_t instancia, const uint8_t *relatorio, uint16_t len);
+void hal_host_hid_observar(hal_host_hid_fn_t fn);
+
+// Abre ou fecha a interface de streaming de audio (alternativa 1 ou 0),
+// como o SET_INTERFACE do host; aberta, o SOF despacha o pacote da FIFO e
+// tud_task() pede o proximo a tud_audio_tx_done_pre_load_cb()
+void hal_host_audio_abrir(uint8_t itf, bool aberto);
+
+typedef struct {
+    uint32_t hid_relatorios;        // aceitos
+    uint32_t hid_recusados;         // tud_hid_n_report() com o endpoint ocupado
+    uint32_t sofs;                  // SOFs entregues ao callback
+    uint32_t i2c_bytes;             // bytes no barramento (DMA e bloqueante)
+    uint32_t i2c_transacoes;        // terminadas em STOP
+    uint32_t dma_transferencias;    // elementos copiados pela DMA simulada
+    uint32_t flash_setores_apagados;
+    uint32_t flash_paginas_gravadas;
+    uint32_t usb_retomadas;         // tud_remote_wakeup() com o barramento suspenso
+    uint32_t audio_pacotes;         // pacotes isocronos despachados
+    uint32_t audio_bytes;
+    uint32_t audio_sem_pacote;      // SOFs com o fluxo aberto e nada armado
+} hal_host_stats_t;
+
+void hal_host_get_stats(hal_host_stats_t *stats);
+
+// Trava o I2C como um alvo segurando SDA em 0: o DMA para na escrita em
+// IC_DATA_CMD, o status fica em atividade e SDA le 0. Solta sozinho depois
+// de pulsos subidas de SCL (recuperacao do barramento) ou, com pulsos = 0,
+// so em hal_host_i2c_soltar(); os canais parados seguem de onde estavam.
+void hal_host_i2c_travar(uint pino_sda, uint pino_scl, uint32_t pulsos);
+void hal_host_i2c_soltar(void);
+
+// SCL do i2c0 agora: a taxa pedida escalada pelo clk_sys atual sobre o do
+// pedido; 0 antes do i2c_init()
+uint32_t hal_host_i2c_scl_hz(void);
+
+// RAM do SSD1306 simulado, indice = coluna + pagina * 128
+const uint8_t *hal_host_ssd1306_ram(void);
+
+// Contraste (0x81) e painel ligado (0xAF) do SSD1306 simulado
+uint8_t hal_host_ssd1306_contraste(void);
+bool hal_host_ssd1306_ligado(void);
+
+#endif // HAL_HOST_H
@@ -0,0 +1,13 @@
+// hardware/adc.h - HAL simulada (host): leituras definidas pelo roteiro
+
+#ifndef HPR_HOST_HARDWARE_ADC_H
+#define HPR_HOST_HARDWARE_ADC_H
+
+#include "pico/types.h"
+
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint entrada);
+uint16_t adc_read(void);
+
+#endif // HPR_HOST_HARDWARE_ADC_H
@@ -0,0 +1,23 @@
+// hardware/clocks.h - HAL simulada (host)
+
+#ifndef HPR_HOST_HARDWARE_CLOCKS_H
+#define HPR_HOST_HARDWARE_CLOCKS_H
+
+#include "pico/types.h"
+
+enum clock_index {
+    clk_gpout0 = 0, clk_gpout1, clk_gpout2, clk_gpout3,
+    clk_ref, clk_sys, clk_peri, clk_usb, clk_adc, clk_rtc,
+};
+
+// Fontes usadas pelo firmware (valores do RP2040)
+#define CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX    0x1
+#define CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS     0x0
+#define CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS    0x1
+
+// So registra a frequencia pedida, devolvida por clock_get_hz()
+bool clock_configure(enum clock_index clk, uint32_t src, uint32_t auxsrc,
+                     uint32_t src_freq, uint32_t freq);
+uint32_t clock_get_hz(enum clock_index clk);
+
+#endif // HPR_HOST_HARDWARE_CLOCKS_H
@@ -0,0 +1,96 @@
+// hardware/dma.h - HAL simulada (host): DMA executada de forma sincrona
+//
+// Um canal disparado transfere tudo na hora, na thread do chamador. Escritas
+// nos registradores de outro canal (blocos de controle) seguem o mapa de
+// aliases do RP2040, e a escrita num registrador de disparo enfileira aquele
+// canal; encadeamento (CHAIN_TO), anel de escrita, IRQ_QUIET e disparo nulo
+// funcionam como no hardware. DREQs nao sao simuladas: tudo corre a vontade.
+
+#ifndef HPR_HOST_HARDWARE_DMA_H
+#define HPR_HOST_HARDWARE_DMA_H
+
+#include "pico/types.h"
+
+#define NUM_DMA_CHANNELS    12
+#define NUM_DMA_TIMERS      4
+#define DREQ_FORCE          0x3f
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2,
+};
+
+typedef struct {
+    uint32_t ctrl;
+} dma_channel_config;
+
+// Mesmo leiaute do RP2040: 4 aliases de 4 palavras; a ultima de cada alias
+// dispara o canal
+typedef struct __attribute__((aligned(64))) {
+    volatile uint32_t read_addr;
+    volatile uint32_t write_addr;
+    volatile uint32_t transfer_count;
+    volatile uint32_t ctrl_trig;
+    volatile uint32_t al1_ctrl;
+    volatile uint32_t al1_read_addr;
+    volatile uint32_t al1_write_addr;
+    volatile uint32_t al1_transfer_count_trig;
+    volatile uint32_t al2_ctrl;
+    volatile uint32_t al2_transfer_count;
+    volatile uint32_t al2_read_addr;
+    volatile uint32_t al2_write_addr_trig;
+    volatile uint32_t al3_ctrl;
+    volatile uint32_t al3_write_addr;
+    volatile uint32_t al3_transfer_count;
+    volatile uint32_t al3_read_addr_trig;
+} dma_channel_hw_t;
+
+typedef struct {
+    dma_channel_hw_t ch[NUM_DMA_CHANNELS];
+    volatile uint32_t intr;
+    volatile uint32_t inte0;
+    volatile uint32_t ints0;
+    volatile uint32_t inte1;
+    volatile uint32_t ints1;
+} dma_hw_t;
+
+extern dma_hw_t hal_host_dma;
+#define dma_hw (&hal_host_dma)
+
+int dma_claim_unused_channel(bool obrigatorio);
+void dma_channel_unclaim(uint canal);
+int dma_claim_unused_timer(bool obrigatorio);
+void dma_timer_set_fraction(uint timer, uint16_t numerador, uint16_t denominador);
+uint dma_get_timer_dreq(uint timer);
+
+dma_channel_config dma_channel_get_default_config(uint canal);
+dma_channel_config dma_get_channel_config(uint canal);
+void channel_config_set_read_increment(dma_channel_config *c, bool incr);
+void channel_config_set_write_increment(dma_channel_config *c, bool incr);
+void channel_config_set_dreq(dma_channel_config *c, uint dreq);
+void channel_config_set_chain_to(dma_channel_config *c, uint canal);
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size tamanho);
+void channel_config_set_ring(dma_channel_config *c, bool escrita, uint bits);
+void channel_config_set_irq_quiet(dma_channel_config *c, bool quieto);
+void channel_config_set_enable(dma_channel_config *c, bool habilitar);
+uint32_t channel_config_get_ctrl_value(const dma_channel_config *c);
+
+void dma_channel_configure(uint canal, const dma_channel_config *c, volatile void *escrita,
+                           const volatile void *leitura, uint contagem, bool disparar);
+void dma_channel_set_config(uint canal, const dma_channel_config *c, bool disparar);
+void dma_channel_set_read_addr(uint canal, const volatile void *leitura, bool disparar);
+void dma_channel_set_write_addr(uint canal, volatile void *escrita, bool disparar);
+void dma_channel_set_trans_count(uint canal, uint32_t contagem, bool disparar);
+void dma_channel_start(uint canal);
+void dma_channel_abort(uint canal);
+bool dma_channel_is_busy(uint canal);
+
+void dma_channel_set_irq0_enabled(uint canal, bool habilitar);
+void dma_channel_set_irq1_enabled(uint canal, bool habilitar);
+bool dma_channel_get_irq0_status(uint canal);
+bool dma_channel_get_irq1_status(uint canal);
+void dma_channel_acknowledge_irq0(uint canal);
+void dma_channel_acknowledge_irq1(uint canal);
+
+#endif // HPR_HOST_HARDWARE_DMA_H
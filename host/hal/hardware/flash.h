@@ -0,0 +1,22 @@
+// hardware/flash.h - HAL simulada (host): flash de 2 MB em RAM
+//
+// XIP_BASE aponta para a copia em RAM, de modo que a leitura "mapeada"
+// funciona como no RP2040. Apagar deixa 0xFF; programar so baixa bits
+// (AND), como na flash de verdade.
+
+#ifndef HPR_HOST_HARDWARE_FLASH_H
+#define HPR_HOST_HARDWARE_FLASH_H
+
+#include "pico/types.h"
+
+#define PICO_FLASH_SIZE_BYTES   (2 * 1024 * 1024)
+#define FLASH_PAGE_SIZE         256u
+#define FLASH_SECTOR_SIZE       4096u
+
+extern uint8_t hal_host_flash[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE                ((uintptr_t)hal_host_flash)
+
+void flash_range_erase(uint32_t offset, size_t n);
+void flash_range_program(uint32_t offset, const uint8_t *dados, size_t n);
+
+#endif // HPR_HOST_HARDWARE_FLASH_H
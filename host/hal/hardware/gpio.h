@@ -0,0 +1,51 @@
+// hardware/gpio.h - HAL simulada (host): pinos com nivel definido pelo roteiro
+//
+// Entradas com pull-up leem 1 ate o roteiro forcar outro nivel; uma mudanca
+// de nivel chama o callback de IRQ se a borda estiver habilitada.
+
+#ifndef HPR_HOST_HARDWARE_GPIO_H
+#define HPR_HOST_HARDWARE_GPIO_H
+
+#include "pico/types.h"
+
+#define NUM_BANK0_GPIOS     30
+
+#define GPIO_IN             false
+#define GPIO_OUT            true
+
+enum gpio_function {
+    GPIO_FUNC_XIP = 0,
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_PWM = 4,
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_PIO0 = 6,
+    GPIO_FUNC_PIO1 = 7,
+    GPIO_FUNC_GPCK = 8,
+    GPIO_FUNC_USB = 9,
+    GPIO_FUNC_NULL = 0x1f,
+};
+
+enum gpio_irq_level {
+    GPIO_IRQ_LEVEL_LOW = 0x1u,
+    GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL = 0x4u,
+    GPIO_IRQ_EDGE_RISE = 0x8u,
+};
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_init(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_set_dir(uint gpio, bool saida);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_disable_pulls(uint gpio);
+bool gpio_get(uint gpio);
+void gpio_put(uint gpio, bool valor);
+void gpio_set_irq_enabled(uint gpio, uint32_t eventos, bool habilitar);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t eventos, bool habilitar,
+                                        gpio_irq_callback_t callback);
+
+#endif // HPR_HOST_HARDWARE_GPIO_H
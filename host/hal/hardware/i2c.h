@@ -0,0 +1,50 @@
+// hardware/i2c.h - HAL simulada (host): I2C que entrega os bytes a um
+// SSD1306 simulado
+//
+// O bloco de registradores so tem o que o firmware usa. A FIFO nunca enche,
+// o barramento fica ocioso assim que a escrita termina e nada e abortado,
+// a nao ser com o barramento travado por hal_host_i2c_travar().
+
+#ifndef HPR_HOST_HARDWARE_I2C_H
+#define HPR_HOST_HARDWARE_I2C_H
+
+#include "pico/types.h"
+
+#define I2C_IC_DATA_CMD_STOP_BITS       0x00000200u
+#define I2C_IC_DATA_CMD_CMD_BITS        0x00000100u
+#define I2C_IC_STATUS_ACTIVITY_BITS     0x00000001u
+#define I2C_IC_STATUS_TFNF_BITS         0x00000002u
+#define I2C_IC_STATUS_TFE_BITS          0x00000004u
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x00000040u
+#define I2C_IC_ENABLE_ENABLE_BITS       0x00000001u
+
+typedef struct {
+    volatile uint32_t tar;
+    volatile uint32_t data_cmd;
+    volatile uint32_t status;
+    volatile uint32_t raw_intr_stat;
+    volatile uint32_t clr_tx_abrt;
+    volatile uint32_t enable;
+} i2c_hw_t;
+
+// O divisor de SCL sai do clk_sys do momento em que a taxa foi pedida, como
+// no RP2040: se o clk_sys muda depois, o SCL muda junto
+// (hal_host_i2c_scl_hz())
+typedef struct i2c_inst {
+    i2c_hw_t hw;
+    uint8_t indice;
+    uint32_t baudrate;
+    uint32_t clk_sys_hz;
+} i2c_inst_t;
+
+extern i2c_inst_t i2c0_inst, i2c1_inst;
+#define i2c0 (&i2c0_inst)
+#define i2c1 (&i2c1_inst)
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate);
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c);
+uint i2c_get_dreq(i2c_inst_t *i2c, bool tx);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+#endif // HPR_HOST_HARDWARE_I2C_H
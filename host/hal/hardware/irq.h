@@ -0,0 +1,19 @@
+// hardware/irq.h - HAL simulada (host): os tratadores sao chamados pela
+// DMA simulada, na mesma thread, quando um canal sinaliza a IRQ
+
+#ifndef HPR_HOST_HARDWARE_IRQ_H
+#define HPR_HOST_HARDWARE_IRQ_H
+
+#include "pico/types.h"
+
+#define DMA_IRQ_0           11
+#define DMA_IRQ_1           12
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t tratador);
+void irq_add_shared_handler(uint num, irq_handler_t tratador, uint8_t prioridade);
+void irq_set_enabled(uint num, bool habilitar);
+
+#endif // HPR_HOST_HARDWARE_IRQ_H
@@ -0,0 +1,25 @@
+// hardware/structs/systick.h - HAL simulada (host): SysTick parado
+//
+// O tempo virtual nao anda durante uma funcao, entao as sondas de perfil
+// medem zero no host; os benchmarks usam o relogio do PC.
+
+#ifndef HPR_HOST_HARDWARE_STRUCTS_SYSTICK_H
+#define HPR_HOST_HARDWARE_STRUCTS_SYSTICK_H
+
+#include "pico/types.h"
+
+#define M0PLUS_SYST_CSR_ENABLE_BITS     0x00000001u
+#define M0PLUS_SYST_CSR_TICKINT_BITS    0x00000002u
+#define M0PLUS_SYST_CSR_CLKSOURCE_BITS  0x00000004u
+
+typedef struct {
+    volatile uint32_t csr;
+    volatile uint32_t rvr;
+    volatile uint32_t cvr;
+    volatile uint32_t calib;
+} systick_hw_t;
+
+extern systick_hw_t hal_host_systick;
+#define systick_hw (&hal_host_systick)
+
+#endif // HPR_HOST_HARDWARE_STRUCTS_SYSTICK_H
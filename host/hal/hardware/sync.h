@@ -0,0 +1,19 @@
+// hardware/sync.h - HAL simulada (host): o host roda tudo numa so thread,
+// entao barreiras e secoes criticas nao tem efeito
+
+#ifndef HPR_HOST_HARDWARE_SYNC_H
+#define HPR_HOST_HARDWARE_SYNC_H
+
+#include "pico/types.h"
+
+static inline void __dmb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __dsb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __isb(void) {}
+static inline void __sev(void) {}
+static inline void __wfe(void) {}
+static inline void __wfi(void) {}
+
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t estado) { (void)estado; }
+
+#endif // HPR_HOST_HARDWARE_SYNC_H
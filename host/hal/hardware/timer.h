@@ -0,0 +1,13 @@
+// hardware/timer.h - HAL simulada (host): leitura do relogio virtual
+
+#ifndef HPR_HOST_HARDWARE_TIMER_H
+#define HPR_HOST_HARDWARE_TIMER_H
+
+#include "pico/types.h"
+
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+void busy_wait_us(uint64_t us);
+void busy_wait_us_32(uint32_t us);
+
+#endif // HPR_HOST_HARDWARE_TIMER_H
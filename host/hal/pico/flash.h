@@ -0,0 +1,18 @@
+// pico/flash.h - HAL simulada (host): nao ha outro nucleo a pausar
+
+#ifndef HPR_HOST_PICO_FLASH_H
+#define HPR_HOST_PICO_FLASH_H
+
+#include "pico/types.h"
+
+#define PICO_OK 0
+
+static inline int flash_safe_execute(void (*fn)(void *), void *param, uint32_t timeout_ms) {
+    (void)timeout_ms;
+    fn(param);
+    return PICO_OK;
+}
+
+static inline bool flash_safe_execute_core_init(void) { return true; }
+
+#endif // HPR_HOST_PICO_FLASH_H
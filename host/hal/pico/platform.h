@@ -0,0 +1,19 @@
+// pico/platform.h - HAL simulada (host): atributos e utilidades de plataforma
+
+#ifndef HPR_HOST_PICO_PLATFORM_H
+#define HPR_HOST_PICO_PLATFORM_H
+
+#include "pico/types.h"
+
+#define __not_in_flash_func(nome)   nome
+#define __time_critical_func(nome)  nome
+#define __not_in_flash(grupo)
+#define __scratch_x(grupo)
+#define __scratch_y(grupo)
+
+static inline void tight_loop_contents(void) {}
+
+// Tudo roda numa thread so, vista como nucleo 0
+static inline uint get_core_num(void) { return 0; }
+
+#endif // HPR_HOST_PICO_PLATFORM_H
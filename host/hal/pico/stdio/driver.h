@@ -0,0 +1,20 @@
+// pico/stdio/driver.h - HAL simulada (host): drivers de stdio nao tem saida
+
+#ifndef HPR_HOST_PICO_STDIO_DRIVER_H
+#define HPR_HOST_PICO_STDIO_DRIVER_H
+
+#include "pico/types.h"
+
+#define PICO_ERROR_NO_DATA  (-3)
+
+typedef struct stdio_driver {
+    void (*out_chars)(const char *buf, int len);
+    int (*in_chars)(char *buf, int len);
+} stdio_driver_t;
+
+static inline void stdio_set_driver_enabled(stdio_driver_t *driver, bool habilitado) {
+    (void)driver;
+    (void)habilitado;
+}
+
+#endif // HPR_HOST_PICO_STDIO_DRIVER_H
@@ -0,0 +1,12 @@
+// pico/stdlib.h - HAL simulada (host)
+
+#ifndef HPR_HOST_PICO_STDLIB_H
+#define HPR_HOST_PICO_STDLIB_H
+
+#include "pico/types.h"
+#include "pico/platform.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include "hardware/timer.h"
+
+#endif // HPR_HOST_PICO_STDLIB_H
@@ -0,0 +1,23 @@
+// pico/time.h - HAL simulada (host): tempo virtual
+//
+// O relogio so anda quando o roteiro manda (hal_host_avancar_us()) ou quando
+// o firmware dorme; as funcoes de espera avancam o relogio em vez de esperar.
+
+#ifndef HPR_HOST_PICO_TIME_H
+#define HPR_HOST_PICO_TIME_H
+
+#include "pico/types.h"
+
+absolute_time_t get_absolute_time(void);
+uint64_t to_us_since_boot(absolute_time_t t);
+absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us);
+absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms);
+absolute_time_t make_timeout_time_us(uint64_t us);
+absolute_time_t make_timeout_time_ms(uint32_t ms);
+int64_t absolute_time_diff_us(absolute_time_t de, absolute_time_t ate);
+bool time_reached(absolute_time_t t);
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+bool best_effort_wfe_or_timeout(absolute_time_t prazo);
+
+#endif // HPR_HOST_PICO_TIME_H
@@ -0,0 +1,15 @@
+// pico/types.h - HAL simulada (host): tipos basicos do SDK
+
+#ifndef HPR_HOST_PICO_TYPES_H
+#define HPR_HOST_PICO_TYPES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+// Como no SDK sem PICO_DEBUG: microssegundos desde o boot
+typedef uint64_t absolute_time_t;
+
+#endif // HPR_HOST_PICO_TYPES_H
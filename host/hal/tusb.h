@@ -0,0 +1,135 @@
+// tusb.h - HAL simulada (host): o minimo do TinyUSB usado pela logica HID
+// e pelo microfone USB
+//
+// Os relatorios enviados vao para o registro de hal_host.h; o roteiro decide
+// se o endpoint esta livre e quando acontece cada SOF. O fluxo de audio pede
+// um pacote por SOF enquanto a interface de streaming esta aberta.
+
+#ifndef HPR_HOST_TUSB_H
+#define HPR_HOST_TUSB_H
+
+#include "pico/types.h"
+
+// Tamanhos dos endpoints vem da configuracao do firmware
+#define CFG_TUSB_MCU 0
+#include "tusb_config.h"
+
+typedef enum {
+    HID_REPORT_TYPE_INVALID = 0,
+    HID_REPORT_TYPE_INPUT,
+    HID_REPORT_TYPE_OUTPUT,
+    HID_REPORT_TYPE_FEATURE,
+} hid_report_type_t;
+
+bool tusb_init(void);
+void tud_task(void);
+bool tud_mounted(void);
+bool tud_suspended(void);
+bool tud_remote_wakeup(void);
+void tud_sof_cb_enable(bool habilitar);
+
+bool tud_hid_n_ready(uint8_t instance);
+bool tud_hid_n_report(uint8_t instance, uint8_t report_id, const void *relatorio, uint16_t len);
+bool tud_hid_ready(void);
+bool tud_hid_report(uint8_t report_id, const void *relatorio, uint16_t len);
+bool tud_hid_mouse_report(uint8_t report_id, uint8_t botoes, int8_t x, int8_t y,
+                          int8_t vertical, int8_t horizontal);
+
+// Teclas e modificadores usados nos atalhos (entrada.c)
+#define KEYBOARD_MODIFIER_LEFTCTRL  0x01
+#define KEYBOARD_MODIFIER_LEFTGUI   0x08
+#define HID_KEY_H                   0x0B
+#define HID_KEY_ENTER               0x28
+
+// =====================
+// Porta serial (CDC)
+// =====================
+// Sempre desconectada: o roteiro nao fala com o console
+static inline bool tud_cdc_connected(void) { return false; }
+static inline uint32_t tud_cdc_available(void) { return 0; }
+static inline uint32_t tud_cdc_read(void *dados, uint32_t len) { (void)dados; (void)len; return 0; }
+static inline uint32_t tud_cdc_write_available(void) { return 0; }
+static inline uint32_t tud_cdc_write(const void *dados, uint32_t len) { (void)dados; (void)len; return 0; }
+static inline uint32_t tud_cdc_write_flush(void) { return 0; }
+
+// =====================
+// Requisicoes de controle e classe de audio (UAC2)
+// =====================
+typedef struct __attribute__((packed)) {
+    uint8_t bmRequestType;
+    uint8_t bRequest;
+    uint16_t wValue;
+    uint16_t wIndex;
+    uint16_t wLength;
+} tusb_control_request_t;
+
+#define tu_u16_low(v)   ((uint8_t)((v) & 0xFF))
+#define tu_u16_high(v)  ((uint8_t)(((v) >> 8) & 0xFF))
+#define tu_htole16(v)   (v)
+#define tu_htole32(v)   (v)
+
+enum {
+    AUDIO_CS_REQ_CUR = 0x01,
+    AUDIO_CS_REQ_RANGE = 0x02,
+};
+
+enum {
+    AUDIO_CS_CTRL_SAM_FREQ = 0x01,
+    AUDIO_CS_CTRL_CLK_VALID = 0x02,
+};
+
+enum {
+    AUDIO_TE_CTRL_CONNECTOR = 0x02,
+};
+
+enum {
+    AUDIO_FU_CTRL_MUTE = 0x01,
+    AUDIO_FU_CTRL_VOLUME = 0x02,
+};
+
+typedef uint32_t audio_channel_config_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t bNrChannels;
+    audio_channel_config_t bmChannelConfig;
+    uint8_t iChannelNames;
+} audio_desc_channel_cluster_t;
+
+typedef struct __attribute__((packed)) { int8_t bCur; } audio_control_cur_1_t;
+typedef struct __attribute__((packed)) { int16_t bCur; } audio_control_cur_2_t;
+typedef struct __attribute__((packed)) { int32_t bCur; } audio_control_cur_4_t;
+
+#define audio_control_range_2_n_t(n) \
+    struct __attribute__((packed)) { \
+        uint16_t wNumSubRanges; \
+        struct __attribute__((packed)) { int16_t bMin, bMax; uint16_t bRes; } subrange[n]; \
+    }
+#define audio_control_range_4_n_t(n) \
+    struct __attribute__((packed)) { \
+        uint16_t wNumSubRanges; \
+        struct __attribute__((packed)) { int32_t bMin, bMax; uint32_t bRes; } subrange[n]; \
+    }
+
+// Copia para a FIFO do endpoint, que sai no proximo SOF; retorna os bytes
+// aceitos (no maximo CFG_TUD_AUDIO_EP_SZ_IN por pacote)
+uint16_t tud_audio_write(const void *dados, uint16_t len);
+bool tud_audio_buffer_and_schedule_control_xfer(uint8_t rhport, tusb_control_request_t const *p_request,
+                                                void *dados, uint16_t len);
+
+// Callbacks implementados pela logica (microfone_usb.c)
+bool tud_audio_tx_done_pre_load_cb(uint8_t rhport, uint8_t itf, uint8_t ep_in, uint8_t cur_alt_setting);
+bool tud_audio_set_itf_cb(uint8_t rhport, tusb_control_request_t const *p_request);
+bool tud_audio_set_itf_close_EP_cb(uint8_t rhport, tusb_control_request_t const *p_request);
+bool tud_audio_get_req_entity_cb(uint8_t rhport, tusb_control_request_t const *p_request);
+bool tud_audio_set_req_entity_cb(uint8_t rhport, tusb_control_request_t const *p_request, uint8_t *pBuff);
+
+// Callbacks implementados pela logica (hid_mouse.c, entrada.c); o de
+// entrega e chamado ja em tud_hid_n_report(), com o relatorio aceito
+void tud_sof_cb(uint32_t frame_count);
+void tud_hid_report_complete_cb(uint8_t instance, uint8_t const *report, uint16_t len);
+uint16_t tud_hid_get_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type,
+                               uint8_t *buffer, uint16_t reqlen);
+void tud_hid_set_report_cb(uint8_t instance, uint8_t report_id, hid_report_type_t report_type,
+                           uint8_t const *buffer, uint16_t bufsize);
+
+#endif // HPR_HOST_TUSB_H
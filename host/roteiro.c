@@ -0,0 +1,786 @@
+// roteiro.c - Executa um roteiro de entradas sobre a logica do firmware no host
+//
+// Monta as mesmas tarefas do HPR.c: as do nucleo 1 (entrada.c: USB,
+// joystick, botoes, microfone, configuracao e energia) e as do nucleo 0 que
+// tocam o display (painel.c), cada nucleo no seu escalonador, intercalados
+// num so relogio virtual sobre a HAL simulada. O roteiro so mexe nas
+// entradas da HAL (ADC, GPIO, USB), na configuracao (config.h) e no traco
+// (entrada.h); LED e buzzer do nucleo 0 ficam de fora. O roteiro e um
+// arquivo de texto, um comando por linha ('#' comenta):
+//
+//   joystick <x> <y>                    leitura do ADC (0..4095)
+//   ruido <amplitude>                   soma ruido uniforme +-amplitude ao joystick
+//   filtro <nenhum|ema|one_euro>        filtro do joystick (joystick.h)
+//   botao <joy|a|b> <pressionar|soltar>
+//   microfone <silencio|voz|ruido>      sinal gerado no canal 2
+//   microfone wav <arquivo>             toca uma gravacao no canal 2 (PCM de
+//                                       16 bits, mono, qualquer taxa; caminho
+//                                       relativo ao roteiro) e volta ao
+//                                       silencio no fim
+//   usb <conectado|desconectado|suspenso>
+//   host <livre|ocupado>                endpoint HID aceita ou nao relatorios
+//   energia <escurecer_s> <desligar_s>  limites do governador (energia.h)
+//   i2c travar <pulsos>                 o alvo prende SDA em baixo e o I2C para;
+//                                       solta depois de tantos pulsos em SCL
+//                                       (0 = so com i2c soltar)
+//   i2c soltar                          solta SDA
+//   audio <aberto|fechado>              interface de streaming do microfone USB
+//                                       (microfone_usb.c); aberto zera as
+//                                       estatisticas dele
+//   adc deriva <ppm>                    relogio do ADC adiantado (ou atrasado,
+//                                       negativo) em relacao ao SOF do host
+//   custo <tarefa> <us>                 cada passo da tarefa do nucleo 1
+//                                       (usb, joystick, botoes, microfone,
+//                                       config, energia) gasta esse tempo
+//                                       simulado, como a CPU do dispositivo;
+//                                       0 = sem custo. As do nucleo 0 rodam
+//                                       em paralelo no dispositivo e aqui
+//                                       nao gastam tempo
+//   reiniciar <x> <y>                   reinicia os dois nucleos com o
+//                                       joystick em repouso nessa posicao,
+//                                       que a calibracao do boot toma como
+//                                       centro; o traco reinicia nela tambem
+//   avancar <ms>                        roda as tarefas pelo tempo pedido
+//   zerar                               zera os acumuladores conferidos e os
+//                                       maximos do escalonador
+//   conferir <grandeza> <min> [max]     falha se o valor sair da faixa
+//   traco gravar                        reinicia a logica e grava as entradas
+//                                       e os relatorios HID (traco.h)
+//   traco parar                         fecha a gravacao
+//   traco salvar|carregar <arquivo>     serializacao binaria do traco, a
+//                                       mesma do despejo do dispositivo
+//   traco reproduzir                    reinicia a logica e injeta o traco
+//                                       pelo entrada.c do firmware, cada
+//                                       entrada no instante exato
+//   traco saida <arquivo>               relatorios HID da ultima reproducao,
+//                                       um por linha com o instante
+//
+// Filtro e limites do governador sao gravados na configuracao (config.h,
+// na flash simulada) e valem tambem depois de cada reinicio, para
+// reproduzir o mesmo traco com outros parametros. Ruido e microfone entram
+// amostra a amostra no anel do ADC (hal_host_adc_fonte()).
+//
+// Grandezas: x, y, roda, pan (soma dos relatorios), x_abs, y_abs (soma dos
+// modulos, que mede o tremor), relatorios, recusados,
+// clique_esquerdo, clique_direito (botoes nos relatorios), duplo_clique
+// (dois cliques esquerdos em relatorios a menos de 50 ms), vad (0/1), vad_ativacoes (desde zerar), vad_ligou_ms e
+// vad_desligou_ms (da ultima troca de sinal do microfone ate a primeira
+// ativacao do VAD e ate a ultima desativacao; -1 sem elas),
+// latencia_max_us, tela (1 se a RAM do SSD1306
+// simulado for igual ao buffer de desenho), contraste e
+// oled_ligado (do SSD1306 simulado), nivel (energia_nivel_t), clk_sys_mhz,
+// despertares, despertar_max_us, acima_limite, descartadas (energia.h),
+// retomadas (pedidos de remote wakeup com o USB suspenso), traco_hid
+// (relatorios na saida da reproducao), traco_diferencas (relatorios da
+// saida diferentes dos gravados, em conteudo ou instante, mais os que
+// sobram de um lado) e traco_desvio_max_us (maior diferenca de instante
+// entre relatorios de mesma ordem), i2c_transacoes, i2c_juntadas,
+// i2c_prazos, i2c_recuperacoes, i2c_presos, i2c_reajustes (i2c_fila.h),
+// i2c_scl_khz (SCL do barramento agora, com o clk_sys atual), erros_i2c
+// (quadros e comandos do SSD1306 com falha), usb_atraso_max_us e
+// usb_exec_max_us (maior atraso entre o prazo e o inicio de tud_task() e
+// maior passo da tarefa USB, do escalonador), audio_pacotes,
+// audio_amostras, audio_subfluxos, audio_perdidas, audio_nivel_min,
+// audio_nivel_max, audio_intervalo_max_us (microfone_usb.h),
+// audio_bytes (que chegaram ao host) e audio_sem_pacote (SOFs sem pacote
+// armado, com a tarefa USB atrasada).
+//
+// Uso: hpr_roteiro <arquivo>; o codigo de saida e o numero de falhas.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "tusb.h"
+#include "hal_host.h"
+#include "scheduler.h"
+#include "i2c_fila.h"
+#include "ssd1306.h"
+#include "joystick.h"
+#include "usb_descriptors.h"
+#include "hid_mouse.h"
+#include "cdc_controle.h"
+#include "config.h"
+#include "energia.h"
+#include "traco.h"
+#include "microfone_usb.h"
+#include "entrada.h"
+#include "painel.h"
+
+// Mesmos pinos do HPR.c
+#define PINO_JOY            22
+#define PINO_A              5
+#define PINO_B              6
+#define PINO_SDA            14
+#define PINO_SCL            15
+#define TAXA_MIC_HZ         16000
+#define DUPLO_CLIQUE_US     50000   // cliques esquerdos mais proximos: um duplo
+
+static const uint8_t pinos_botoes[N_BOTOES] = { PINO_JOY, PINO_A, PINO_B };
+
+// Um escalonador por nucleo, como no HPR.c
+enum { NUCLEO0, NUCLEO1, NUCLEOS };
+static scheduler_t escalonadores[NUCLEOS];
+static int joystick_ruido;
+
+// Custo de CPU simulado de cada passo (custo <tarefa> <us>), por indice de
+// tarefa do nucleo 1. O relogio virtual e um so: um custo no nucleo 0
+// atrasaria o nucleo 1, o que no dispositivo nao acontece.
+static uint32_t custo_us[SCHEDULER_MAX_TAREFAS];
+
+// Traco gravado (ou carregado) e a saida da ultima reproducao
+#define TRACO_BYTES (1u << 20)
+static uint8_t traco_buf[TRACO_BYTES], saida_buf[TRACO_BYTES];
+static traco_t traco, saida;
+
+// =====================
+// Acumuladores conferidos pelo roteiro
+// =====================
+static struct {
+    int64_t x, y, roda, pan;
+    int64_t x_abs, y_abs;               // soma dos modulos: mede o tremor
+    uint32_t relatorios;
+    uint32_t clique_esquerdo, clique_direito;
+    uint32_t duplo_clique;
+    uint32_t vad_ativacoes;
+    uint8_t botoes_anteriores;
+    bool esquerdo_sozinho;              // ultimo clique esquerdo sem par ainda
+    uint32_t esquerdo_us;               // instante dele
+} medido;
+
+static void observar_hid(uint8_t instancia, const uint8_t *relatorio, uint16_t len) {
+    hid_mouse_relatorio_t r;
+    if (instancia != USB_HID_MOUSE || len != sizeof(r))
+        return;
+    memcpy(&r, relatorio, sizeof(r));
+    medido.x += r.x;
+    medido.y += r.y;
+    medido.x_abs += r.x < 0 ? -r.x : r.x;
+    medido.y_abs += r.y < 0 ? -r.y : r.y;
+    medido.roda += r.wheel;
+    medido.pan += r.pan;
+    medido.relatorios++;
+    uint8_t novos = r.botoes & ~medido.botoes_anteriores;
+    if (novos & HID_MOUSE_BOTAO_ESQUERDO) {
+        medido.clique_esquerdo++;
+        uint32_t agora = time_us_32();
+        if (medido.esquerdo_sozinho && agora - medido.esquerdo_us < DUPLO_CLIQUE_US) {
+            medido.duplo_clique++;
+            medido.esquerdo_sozinho = false;
+        } else {
+            medido.esquerdo_sozinho = true;
+            medido.esquerdo_us = agora;
+        }
+    }
+    if (novos & HID_MOUSE_BOTAO_DIREITO)
+        medido.clique_direito++;
+    medido.botoes_anteriores = r.botoes;
+}
+
+// =====================
+// Sinais no ADC
+// =====================
+typedef enum { MIC_SILENCIO, MIC_VOZ, MIC_RUIDO, MIC_WAV } mic_sinal_t;
+static mic_sinal_t mic_sinal = MIC_SILENCIO;
+static uint32_t mic_inicio_us;          // ultima troca de sinal
+static uint64_t mic_inicio_ns;
+
+// Gravacao de microfone wav, tocada na taxa dela (amostra e segura)
+static int16_t *mic_wav;
+static uint32_t mic_wav_n, mic_wav_taxa;
+
+// Transicoes do VAD desde a ultima troca de sinal, em us; -1 = nenhuma
+static int64_t vad_ligou_us, vad_desligou_us;
+static bool vad_anterior;
+
+// Zumbido de rede e um pouco de ruido sempre; voz = harmonicos de 140 Hz
+// com formante em 400-1200 Hz; ruido = chiado de banda larga. A gravacao
+// vai direto para o ADC (16 bits para 12, em torno de 2048), com o fundo
+// que ela tiver, e volta ao silencio no fim.
+static uint16_t mic_amostra(uint64_t t_ns) {
+    if (mic_sinal == MIC_WAV) {
+        uint64_t i = (t_ns - mic_inicio_ns) * mic_wav_taxa / 1000000000u;
+        if (i < mic_wav_n)
+            return (uint16_t)(2048 + mic_wav[i] / 16);
+    }
+    double t = (double)t_ns / 1e9;
+    double s = 2048 + (rand() % 21 - 10) + 300 * sin(2 * M_PI * 60 * t);
+    if (mic_sinal == MIC_VOZ) {
+        for (int h = 1; h < 20; h++) {
+            double f = 140.0 * h;
+            if (f < 4000)
+                s += 60.0 / h * (f > 400 && f < 1200 ? 4 : 1) * sin(2 * M_PI * f * t);
+        }
+    } else if (mic_sinal == MIC_RUIDO) {
+        s += rand() % 401 - 200;
+    }
+    return (uint16_t)s;
+}
+
+// Cada amostra do anel do ADC: joystick com o ruido do roteiro, microfone
+// com o sinal do momento
+static uint16_t adc_fonte(uint entrada, uint64_t t_ns, uint16_t valor) {
+    if (entrada == 2)
+        return mic_amostra(t_ns);
+    if (entrada > 1 || !joystick_ruido)
+        return valor;
+    int v = valor + rand() % (2 * joystick_ruido + 1) - joystick_ruido;
+    return (uint16_t)(v < 0 ? 0 : (v > 4095 ? 4095 : v));
+}
+
+// Antes de trocar um sinal: os quadros ate agora ficam com o anterior
+static void adc_fonte_fechar(void) {
+    hal_host_adc_fonte(adc_fonte);
+}
+
+// Novo sinal no microfone: as medidas do VAD contam daqui
+static void microfone_trocou(mic_sinal_t sinal) {
+    adc_fonte_fechar();
+    mic_sinal = sinal;
+    mic_inicio_us = time_us_32();
+    mic_inicio_ns = hal_host_agora_us() * 1000;
+    vad_ligou_us = vad_desligou_us = -1;
+}
+
+static void observar_vad(void) {
+    bool ativo = vad_ativo(entrada_vad());
+    if (ativo == vad_anterior)
+        return;
+    vad_anterior = ativo;
+    int64_t t = (int64_t)(uint32_t)(time_us_32() - mic_inicio_us);
+    if (ativo) {
+        medido.vad_ativacoes++;
+        if (vad_ligou_us < 0)
+            vad_ligou_us = t;
+    } else {
+        vad_desligou_us = t;
+    }
+}
+
+static uint16_t le16(const uint8_t *p) { return (uint16_t)(p[0] | p[1] << 8); }
+static uint32_t le32(const uint8_t *p) { return le16(p) | (uint32_t)le16(p + 2) << 16; }
+
+// Le um WAV PCM de 16 bits mono para mic_wav; false se nao for um
+static bool wav_carregar(const char *nome) {
+    FILE *f = fopen(nome, "rb");
+    if (!f) {
+        perror(nome);
+        return false;
+    }
+    uint8_t cab[12];
+    bool ok = fread(cab, 1, sizeof(cab), f) == sizeof(cab) &&
+              !memcmp(cab, "RIFF", 4) && !memcmp(cab + 8, "WAVE", 4);
+    uint16_t formato = 0, canais = 0, bits = 0;
+    uint32_t taxa = 0;
+    bool dados = false;
+    while (ok && !dados) {
+        uint8_t pedaco[8];
+        if (fread(pedaco, 1, sizeof(pedaco), f) != sizeof(pedaco)) {
+            ok = false;
+            break;
+        }
+        uint32_t tam = le32(pedaco + 4);
+        if (!memcmp(pedaco, "fmt ", 4) && tam >= 16) {
+            uint8_t fmt[16];
+            ok = fread(fmt, 1, sizeof(fmt), f) == sizeof(fmt);
+            formato = le16(fmt);
+            canais = le16(fmt + 2);
+            taxa = le32(fmt + 4);
+            bits = le16(fmt + 14);
+            fseek(f, (long)(tam - 16 + (tam & 1)), SEEK_CUR);
+        } else if (!memcmp(pedaco, "data", 4)) {
+            ok = formato == 1 && canais == 1 && bits == 16 && taxa != 0;
+            if (!ok)
+                break;
+            uint8_t *bruto = malloc(tam);
+            ok = bruto && fread(bruto, 1, tam, f) == tam;
+            if (ok) {
+                adc_fonte_fechar();
+                free(mic_wav);
+                mic_wav_n = tam / 2;
+                mic_wav = malloc((mic_wav_n ? mic_wav_n : 1) * sizeof(int16_t));
+                for (uint32_t i = 0; i < mic_wav_n; i++)
+                    mic_wav[i] = (int16_t)le16(bruto + 2 * i);
+                mic_wav_taxa = taxa;
+            }
+            free(bruto);
+            dados = true;
+        } else {
+            fseek(f, (long)(tam + (tam & 1)), SEEK_CUR);
+        }
+    }
+    fclose(f);
+    if (!ok || !dados)
+        fprintf(stderr, "%s: WAV PCM de 16 bits mono invalido\n", nome);
+    return ok && dados;
+}
+
+// =====================
+// Passos das tarefas
+// =====================
+// Cada tarefa registrada pelo entrada.c e pelo painel.c passa por um passo
+// que gasta o custo dela antes de chama-la e acompanha o VAD depois
+static scheduler_fn_t tarefa_fn[NUCLEOS][SCHEDULER_MAX_TAREFAS];
+
+static void passo(int nucleo, int i) {
+    if (nucleo == NUCLEO1 && custo_us[i])
+        busy_wait_us_32(custo_us[i]);
+    tarefa_fn[nucleo][i]();
+    observar_vad();
+}
+
+_Static_assert(SCHEDULER_MAX_TAREFAS == 8, "um passo por tarefa");
+#define PASSO(n, i) static void passo_##n##_##i(void) { passo(n, i); }
+#define PASSOS(n) PASSO(n, 0) PASSO(n, 1) PASSO(n, 2) PASSO(n, 3) \
+                  PASSO(n, 4) PASSO(n, 5) PASSO(n, 6) PASSO(n, 7)
+#define PASSOS_FN(n) { passo_##n##_0, passo_##n##_1, passo_##n##_2, passo_##n##_3, \
+                       passo_##n##_4, passo_##n##_5, passo_##n##_6, passo_##n##_7 }
+PASSOS(0)
+PASSOS(1)
+static const scheduler_fn_t passos[NUCLEOS][SCHEDULER_MAX_TAREFAS] = { PASSOS_FN(0), PASSOS_FN(1) };
+
+static void passos_instalar(int nucleo) {
+    scheduler_t *s = &escalonadores[nucleo];
+    for (uint8_t i = 0; i < s->n_tarefas; i++) {
+        tarefa_fn[nucleo][i] = s->tarefas[i].fn;
+        s->tarefas[i].fn = passos[nucleo][i];
+    }
+}
+
+// Nucleo 0: so o display (painel.c)
+static void eventos_tarefa(void) {
+    evento_t evento;
+    while (entrada_ler_evento(&evento))
+        painel_evento(evento);
+}
+
+// Joystick no boot (reiniciar)
+static uint16_t boot_x = JOYSTICK_CENTRO_PADRAO, boot_y = JOYSTICK_CENTRO_PADRAO;
+
+// Boot dos dois nucleos, na ordem do main() e do core1_main() do HPR.c
+static void iniciar(void) {
+    hal_host_reiniciar();
+    energia_relogio_init();
+    hal_host_hid_observar(observar_hid);
+    hal_host_adc_fonte(adc_fonte);
+    hal_host_adc_definir(0, boot_x);
+    hal_host_adc_definir(1, boot_y);
+    microfone_trocou(mic_sinal);
+    vad_anterior = false;
+
+    i2c_fila_init(i2c0, 400 * 1000, PINO_SDA, PINO_SCL);
+    ssd1306_init(0x3C);
+    painel_init();
+    config_init();
+    cdc_controle_init();
+    entrada_eventos_init();
+
+    tusb_init();
+    hid_mouse_init();
+    entrada_init(pinos_botoes);
+    entrada_traco_usar(&traco, &saida);
+
+    scheduler_init(&escalonadores[NUCLEO1]);
+    entrada_registrar(&escalonadores[NUCLEO1]);
+    passos_instalar(NUCLEO1);
+    scheduler_init(&escalonadores[NUCLEO0]);
+    painel_registrar(&escalonadores[NUCLEO0], eventos_tarefa);
+    passos_instalar(NUCLEO0);
+}
+
+// Roda as tarefas dos dois nucleos ate o instante fim exato: a de prazo
+// mais antigo primeiro (empate com o nucleo 1, o da USB); entre dois
+// prazos o relogio para em fim, e as tarefas com prazo em fim ficam para
+// depois, como quando um comando do roteiro chega ao fim de avancar()
+static void avancar_ate_us(uint64_t fim) {
+    while (hal_host_agora_us() < fim) {
+        uint64_t agora = hal_host_agora_us();
+        uint64_t prazo = UINT64_MAX;
+        scheduler_t *proximo = NULL;
+        for (int n = NUCLEO1; n >= NUCLEO0; n--) {
+            scheduler_t *s = &escalonadores[n];
+            uint64_t p = s->acordar ? agora : UINT64_MAX;
+            for (uint8_t i = 0; i < s->n_tarefas; i++) {
+                if (s->tarefas[i].prazo < p)
+                    p = s->tarefas[i].prazo;
+            }
+            if (p < prazo) {
+                prazo = p;
+                proximo = s;
+            }
+        }
+        if (prazo <= agora)
+            scheduler_run_once(proximo);
+        else
+            hal_host_avancar_us((prazo < fim ? prazo : fim) - agora);
+    }
+}
+
+static void avancar(uint32_t ms) {
+    avancar_ate_us(hal_host_agora_us() + (uint64_t)ms * 1000);
+}
+
+// Um passo de 1 us por vez ate a condicao: o pedido e atendido pela tarefa
+// USB, no proximo passo dela
+static void avancar_ate(bool (*condicao)(void)) {
+    while (!condicao())
+        avancar_ate_us(hal_host_agora_us() + 1);
+}
+
+// =====================
+// Traco: gravacao e reproducao exata
+// =====================
+// Gravacao e reproducao comecam do boot, no primeiro passo da tarefa USB,
+// para que a reproducao parta do mesmo estado e da mesma fase dos
+// escalonadores. Os registros entram pelo mesmo entrada.c do firmware;
+// aqui cada um no seu instante exato, entre dois passos.
+static bool traco_atendido(void) {
+    uint32_t t;
+    return entrada_traco_parado() || entrada_traco_proximo_us(&t);
+}
+
+static void traco_gravar(void) {
+    iniciar();
+    traco_init(&traco, traco_buf, TRACO_BYTES);
+    entrada_traco_pedir('g');
+}
+
+static void traco_parar(void) {
+    entrada_traco_pedir('s');
+    avancar_ate(entrada_traco_parado);
+}
+
+static void traco_reproduzir(void) {
+    traco_parar();
+    iniciar();
+    traco_init(&saida, saida_buf, TRACO_BYTES);
+    entrada_traco_pedir('r');
+    avancar_ate(traco_atendido);
+    uint32_t t;
+    while (entrada_traco_proximo_us(&t)) {
+        int32_t falta = (int32_t)(t - time_us_32());
+        if (falta > 0)
+            avancar_ate_us(hal_host_agora_us() + (uint32_t)falta);
+        entrada_traco_injetar();
+    }
+}
+
+static bool traco_proximo_hid(const traco_t *t, traco_cursor_t *c, traco_evento_t *ev) {
+    while (traco_ler(t, c, ev)) {
+        if (ev->tipo == TRACO_HID)
+            return true;
+    }
+    return false;
+}
+
+// Relatorios HID da saida contra os gravados, na ordem
+static void traco_comparar(uint32_t *hid, uint32_t *diferencas, uint32_t *desvio_max_us) {
+    traco_cursor_t cg, cs;
+    traco_evento_t g, s;
+    traco_cursor(&traco, &cg);
+    traco_cursor(&saida, &cs);
+    *hid = *diferencas = *desvio_max_us = 0;
+    while (true) {
+        bool ha_g = traco_proximo_hid(&traco, &cg, &g);
+        bool ha_s = traco_proximo_hid(&saida, &cs, &s);
+        if (!ha_g && !ha_s)
+            break;
+        *hid += ha_s;
+        if (!ha_g || !ha_s) {
+            (*diferencas)++;
+            continue;
+        }
+        uint32_t desvio = g.t_us > s.t_us ? g.t_us - s.t_us : s.t_us - g.t_us;
+        if (desvio > *desvio_max_us)
+            *desvio_max_us = desvio;
+        if (desvio || g.instancia != s.instancia || g.n != s.n || memcmp(g.dados, s.dados, g.n))
+            (*diferencas)++;
+    }
+}
+
+static bool traco_salvar(const char *nome) {
+    FILE *f = fopen(nome, "wb");
+    if (!f)
+        return false;
+    uint8_t bloco[4096];
+    uint32_t offset = 0, n;
+    while ((n = traco_serializar(&traco, offset, bloco, sizeof(bloco))) > 0) {
+        fwrite(bloco, 1, n, f);
+        offset += n;
+    }
+    return fclose(f) == 0;
+}
+
+static bool traco_carregar_arquivo(const char *nome) {
+    FILE *f = fopen(nome, "rb");
+    if (!f)
+        return false;
+    static uint8_t bytes[TRACO_INICIO_BYTES + TRACO_BYTES];
+    size_t n = fread(bytes, 1, sizeof(bytes), f);
+    fclose(f);
+    traco_parar();
+    traco_init(&traco, traco_buf, TRACO_BYTES);
+    return traco_carregar(&traco, bytes, (uint32_t)n);
+}
+
+static bool traco_escrever_saida(const char *nome) {
+    FILE *f = fopen(nome, "w");
+    if (!f)
+        return false;
+    traco_cursor_t c;
+    traco_evento_t ev;
+    traco_cursor(&saida, &c);
+    while (traco_ler(&saida, &c, &ev)) {
+        char linha[96];
+        traco_formatar(&ev, linha, sizeof(linha));
+        fputs(linha, f);
+    }
+    return fclose(f) == 0;
+}
+
+static bool traco_comando(const char *acao, const char *arquivo) {
+    if (!strcmp(acao, "gravar"))
+        traco_gravar();
+    else if (!strcmp(acao, "parar"))
+        traco_parar();
+    else if (!strcmp(acao, "reproduzir"))
+        traco_reproduzir();
+    else if (!strcmp(acao, "salvar") && arquivo)
+        return traco_salvar(arquivo);
+    else if (!strcmp(acao, "carregar") && arquivo)
+        return traco_carregar_arquivo(arquivo);
+    else if (!strcmp(acao, "saida") && arquivo)
+        return traco_escrever_saida(arquivo);
+    else
+        return false;
+    return true;
+}
+
+static bool tela_igual(void) {
+    const uint8_t *ram = hal_host_ssd1306_ram();
+    for (int i = 0; i < SSD1306_BUFFER_SIZE; i++) {
+        if (ram[i] != (uint8_t)ssd1306_buffer[i])
+            return false;
+    }
+    return true;
+}
+
+static int filtro_indice(const char *nome) {
+    if (!strcmp(nome, "nenhum")) return JOYSTICK_FILTRO_NENHUM;
+    if (!strcmp(nome, "ema")) return JOYSTICK_FILTRO_EMA;
+    if (!strcmp(nome, "one_euro")) return JOYSTICK_FILTRO_ONE_EURO;
+    return -1;
+}
+
+static bool grandeza(const char *nome, int64_t *valor) {
+    hal_host_stats_t hs;
+    hid_mouse_stats_t ms;
+    i2c_fila_stats_t is;
+    ssd1306_stats_t ss;
+    microfone_usb_stats_t mus;
+    uint32_t traco_hid, traco_diferencas, traco_desvio;
+    const energia_t *en = entrada_energia();
+    const scheduler_tarefa_t *usb = &escalonadores[NUCLEO1].tarefas[0];
+    hal_host_get_stats(&hs);
+    hid_mouse_get_stats(&ms);
+    i2c_fila_get_stats(&is);
+    ssd1306_get_stats(&ss);
+    microfone_usb_get_stats(&mus);
+    traco_comparar(&traco_hid, &traco_diferencas, &traco_desvio);
+    if (!strcmp(nome, "x")) *valor = medido.x;
+    else if (!strcmp(nome, "y")) *valor = medido.y;
+    else if (!strcmp(nome, "x_abs")) *valor = medido.x_abs;
+    else if (!strcmp(nome, "y_abs")) *valor = medido.y_abs;
+    else if (!strcmp(nome, "roda")) *valor = medido.roda;
+    else if (!strcmp(nome, "pan")) *valor = medido.pan;
+    else if (!strcmp(nome, "relatorios")) *valor = medido.relatorios;
+    else if (!strcmp(nome, "recusados")) *valor = hs.hid_recusados;
+    else if (!strcmp(nome, "clique_esquerdo")) *valor = medido.clique_esquerdo;
+    else if (!strcmp(nome, "clique_direito")) *valor = medido.clique_direito;
+    else if (!strcmp(nome, "duplo_clique")) *valor = medido.duplo_clique;
+    else if (!strcmp(nome, "vad")) *valor = vad_ativo(entrada_vad());
+    else if (!strcmp(nome, "vad_ativacoes")) *valor = medido.vad_ativacoes;
+    else if (!strcmp(nome, "vad_ligou_ms")) *valor = vad_ligou_us < 0 ? -1 : vad_ligou_us / 1000;
+    else if (!strcmp(nome, "vad_desligou_ms")) *valor = vad_desligou_us < 0 ? -1 : vad_desligou_us / 1000;
+    else if (!strcmp(nome, "latencia_max_us")) *valor = ms.latencia_max_us;
+    else if (!strcmp(nome, "tela")) *valor = tela_igual();
+    else if (!strcmp(nome, "contraste")) *valor = hal_host_ssd1306_contraste();
+    else if (!strcmp(nome, "oled_ligado")) *valor = hal_host_ssd1306_ligado();
+    else if (!strcmp(nome, "nivel")) *valor = entrada_energia_nivel();
+    else if (!strcmp(nome, "clk_sys_mhz")) *valor = clock_get_hz(clk_sys) / 1000000;
+    else if (!strcmp(nome, "despertares")) *valor = en->stats.despertares;
+    else if (!strcmp(nome, "despertar_max_us")) *valor = en->stats.latencia_max_us;
+    else if (!strcmp(nome, "acima_limite")) *valor = en->stats.acima_limite;
+    else if (!strcmp(nome, "descartadas")) *valor = en->stats.descartadas;
+    else if (!strcmp(nome, "retomadas")) *valor = hs.usb_retomadas;
+    else if (!strcmp(nome, "traco_hid")) *valor = traco_hid;
+    else if (!strcmp(nome, "traco_diferencas")) *valor = traco_diferencas;
+    else if (!strcmp(nome, "traco_desvio_max_us")) *valor = traco_desvio;
+    else if (!strcmp(nome, "usb_atraso_max_us")) *valor = usb->max_atraso_us;
+    else if (!strcmp(nome, "usb_exec_max_us")) *valor = usb->max_exec_us;
+    else if (!strcmp(nome, "i2c_transacoes")) *valor = is.transacoes;
+    else if (!strcmp(nome, "i2c_juntadas")) *valor = is.juntadas;
+    else if (!strcmp(nome, "i2c_prazos")) *valor = is.prazos;
+    else if (!strcmp(nome, "i2c_recuperacoes")) *valor = is.recuperacoes;
+    else if (!strcmp(nome, "i2c_presos")) *valor = is.presos;
+    else if (!strcmp(nome, "i2c_reajustes")) *valor = is.reajustes;
+    else if (!strcmp(nome, "i2c_scl_khz")) *valor = hal_host_i2c_scl_hz() / 1000;
+    else if (!strcmp(nome, "erros_i2c")) *valor = ss.erros_i2c;
+    else if (!strcmp(nome, "audio_pacotes")) *valor = mus.pacotes;
+    else if (!strcmp(nome, "audio_amostras")) *valor = mus.amostras;
+    else if (!strcmp(nome, "audio_subfluxos")) *valor = mus.subfluxos;
+    else if (!strcmp(nome, "audio_perdidas")) *valor = mus.perdidas;
+    else if (!strcmp(nome, "audio_nivel_min")) *valor = mus.nivel_min;
+    else if (!strcmp(nome, "audio_nivel_max")) *valor = mus.nivel_max;
+    else if (!strcmp(nome, "audio_intervalo_max_us")) *valor = mus.intervalo_max_us;
+    else if (!strcmp(nome, "audio_bytes")) *valor = hs.audio_bytes;
+    else if (!strcmp(nome, "audio_sem_pacote")) *valor = hs.audio_sem_pacote;
+    else return false;
+    return true;
+}
+
+// Arquivo de entrada relativo ao diretorio do roteiro
+static void roteiro_caminho(char *dst, size_t n, const char *roteiro, const char *nome) {
+    const char *barra = strrchr(roteiro, '/');
+    if (nome[0] == '/' || !barra)
+        snprintf(dst, n, "%s", nome);
+    else
+        snprintf(dst, n, "%.*s/%s", (int)(barra - roteiro), roteiro, nome);
+}
+
+// Custo da tarefa do nucleo 1 pelo nome; NULL se nao existir
+static uint32_t *tarefa_custo(const char *nome) {
+    const scheduler_t *s = &escalonadores[NUCLEO1];
+    for (int i = 0; i < s->n_tarefas; i++) {
+        if (!strcmp(s->tarefas[i].nome, nome))
+            return &custo_us[i];
+    }
+    return NULL;
+}
+
+// Grava um campo como o console do HPR.c (config.h) e salva na flash
+// simulada, que sobrevive aos reinicios; vale no proximo passo da tarefa
+// de configuracao
+static bool config_escrever(uint8_t campo, uint32_t valor) {
+    uint8_t cmd[5] = { campo, (uint8_t)valor, (uint8_t)(valor >> 8), (uint8_t)(valor >> 16),
+                       (uint8_t)(valor >> 24) };
+    uint8_t resposta[CONFIG_RESPOSTA_MAX];
+    return config_executar(CONFIG_CMD_ESCREVER, cmd, sizeof(cmd), resposta) == 1 &&
+           resposta[0] == CONFIG_OK &&
+           config_executar(CONFIG_CMD_SALVAR, NULL, 0, resposta) == 1 && resposta[0] == CONFIG_OK;
+}
+
+static int botao_indice(const char *nome) {
+    if (!strcmp(nome, "joy")) return BOTAO_JOY;
+    if (!strcmp(nome, "a")) return BOTAO_A;
+    if (!strcmp(nome, "b")) return BOTAO_B;
+    return -1;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "uso: %s <roteiro>\n", argv[0]);
+        return 2;
+    }
+    FILE *f = fopen(argv[1], "r");
+    if (!f) {
+        perror(argv[1]);
+        return 2;
+    }
+
+    iniciar();
+    int falhas = 0, n_linha = 0;
+    char linha[256];
+    while (fgets(linha, sizeof(linha), f)) {
+        n_linha++;
+        char *c = strchr(linha, '#');
+        if (c)
+            *c = '\0';
+        char cmd[32], a[32], b[32], d[32];
+        int n = sscanf(linha, "%31s %31s %31s %31s", cmd, a, b, d);
+        if (n <= 0)
+            continue;
+
+        bool ok = true;
+        if (!strcmp(cmd, "joystick") && n == 3) {
+            hal_host_adc_definir(0, (uint16_t)atoi(a));
+            hal_host_adc_definir(1, (uint16_t)atoi(b));
+        } else if (!strcmp(cmd, "ruido") && n == 2) {
+            adc_fonte_fechar();
+            joystick_ruido = atoi(a);
+        } else if (!strcmp(cmd, "filtro") && n == 2 && filtro_indice(a) >= 0) {
+            ok = config_escrever(CONFIG_JOY_FILTRO, (uint32_t)filtro_indice(a));
+        } else if (!strcmp(cmd, "botao") && n == 3 && botao_indice(a) >= 0) {
+            // Ativo em nivel baixo
+            hal_host_gpio_definir(pinos_botoes[botao_indice(a)], strcmp(b, "pressionar") != 0);
+        } else if (!strcmp(cmd, "microfone") && n == 3 && !strcmp(a, "wav")) {
+            char caminho[512];
+            roteiro_caminho(caminho, sizeof(caminho), argv[1], b);
+            ok = wav_carregar(caminho);
+            if (ok)
+                microfone_trocou(MIC_WAV);
+        } else if (!strcmp(cmd, "microfone") && n == 2) {
+            microfone_trocou(!strcmp(a, "voz") ? MIC_VOZ : !strcmp(a, "ruido") ? MIC_RUIDO : MIC_SILENCIO);
+        } else if (!strcmp(cmd, "usb") && n == 2) {
+            hal_host_usb_definir(strcmp(a, "desconectado") != 0, !strcmp(a, "suspenso"));
+        } else if (!strcmp(cmd, "host") && n == 2) {
+            hal_host_hid_ocupado(!strcmp(a, "ocupado"));
+        } else if (!strcmp(cmd, "energia") && n == 3) {
+            ok = config_escrever(CONFIG_ENERGIA_ESCURECER_S, (uint32_t)atoi(a)) &&
+                 config_escrever(CONFIG_ENERGIA_DESLIGAR_S, (uint32_t)atoi(b));
+        } else if (!strcmp(cmd, "i2c") && n == 3 && !strcmp(a, "travar")) {
+            hal_host_i2c_travar(PINO_SDA, PINO_SCL, (uint32_t)atoi(b));
+        } else if (!strcmp(cmd, "i2c") && n == 2 && !strcmp(a, "soltar")) {
+            hal_host_i2c_soltar();
+        } else if (!strcmp(cmd, "reiniciar") && n == 3) {
+            boot_x = (uint16_t)atoi(a);
+            boot_y = (uint16_t)atoi(b);
+            iniciar();
+        } else if (!strcmp(cmd, "avancar") && n == 2) {
+            avancar((uint32_t)atoi(a));
+        } else if (!strcmp(cmd, "traco") && n >= 2) {
+            ok = traco_comando(a, n >= 3 ? b : NULL);
+        } else if (!strcmp(cmd, "audio") && n == 2) {
+            if (!strcmp(a, "aberto"))
+                microfone_usb_init();
+            hal_host_audio_abrir(USB_ITF_AUDIO_STREAMING, !strcmp(a, "aberto"));
+        } else if (!strcmp(cmd, "adc") && n == 3 && !strcmp(a, "deriva")) {
+            hal_host_adc_deriva(atoi(b));
+        } else if (!strcmp(cmd, "custo") && n == 3 && tarefa_custo(a)) {
+            *tarefa_custo(a) = (uint32_t)atoi(b);
+        } else if (!strcmp(cmd, "zerar") && n == 1) {
+            memset(&medido, 0, sizeof(medido));
+            for (int k = 0; k < NUCLEOS; k++) {
+                for (int i = 0; i < escalonadores[k].n_tarefas; i++) {
+                    escalonadores[k].tarefas[i].max_atraso_us = 0;
+                    escalonadores[k].tarefas[i].max_exec_us = 0;
+                }
+            }
+        } else if (!strcmp(cmd, "conferir") && n >= 3) {
+            int64_t valor, min = atoll(b), max = n == 4 ? atoll(d) : min;
+            if (!grandeza(a, &valor)) {
+                ok = false;
+            } else if (valor < min || valor > max) {
+                printf("%s:%d: %s = %lld, esperado [%lld, %lld]\n", argv[1], n_linha, a,
+                       (long long)valor, (long long)min, (long long)max);
+                falhas++;
+            }
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            printf("%s:%d: comando invalido\n", argv[1], n_linha);
+            falhas++;
+        }
+    }
+    fclose(f);
+
+    hal_host_stats_t hs;
+    hal_host_get_stats(&hs);
+    printf("%s: %s (%llu ms simulados, %u relatorios HID, %u bytes I2C)\n", argv[1],
+           falhas ? "FALHOU" : "ok", (unsigned long long)(hal_host_agora_us() / 1000),
+           hs.hid_relatorios, hs.i2c_bytes);
+    return falhas > 255 ? 255 : falhas;
+}
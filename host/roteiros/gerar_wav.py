@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+# gerar_wav.py - Gera os WAV de teste do VAD (voz.wav e ruido.wav)
+#
+# Sem gravacao de referencia no repositorio, a fala e sintetizada por
+# formantes: trem de pulsos glotais com jitter e contorno de entonacao,
+# tres ressonadores por vogal, silabas com transicoes e pausas curtas e
+# uma fricativa. O fundo imita o do microfone da placa: chiado baixo e
+# zumbido da rede. O roteiro vad.txt conhece os instantes abaixo; outros
+# WAV (16 bits, mono, qualquer taxa) servem para o comando microfone wav.
+#
+# Uso: python3 gerar_wav.py (escreve ao lado deste arquivo)
+
+import math
+import os
+import random
+import struct
+
+TAXA = 16000
+random.seed(1234)
+
+
+def escrever(nome, amostras):
+    dados = b''.join(struct.pack('<h', max(-32768, min(32767, int(round(s))))) for s in amostras)
+    cab = b'RIFF' + struct.pack('<I', 36 + len(dados)) + b'WAVE'
+    cab += b'fmt ' + struct.pack('<IHHIIHH', 16, 1, 1, TAXA, TAXA * 2, 2, 16)
+    cab += b'data' + struct.pack('<I', len(dados))
+    with open(os.path.join(os.path.dirname(os.path.abspath(__file__)), nome), 'wb') as f:
+        f.write(cab + dados)
+
+
+def fundo(n, chiado, zumbido):
+    # Chiado rosa aproximado (soma de passa-baixas) mais 60 Hz
+    s, b0, b1 = [], 0.0, 0.0
+    for i in range(n):
+        w = random.gauss(0, 1)
+        b0 = 0.97 * b0 + 0.2 * w
+        b1 = 0.6 * b1 + 0.5 * w
+        s.append(chiado * (b0 + b1) + zumbido * math.sin(2 * math.pi * 60 * i / TAXA))
+    return s
+
+
+class Ressonador:
+    def __init__(self):
+        self.y1 = self.y2 = 0.0
+
+    def passo(self, x, f, banda):
+        r = math.exp(-math.pi * banda / TAXA)
+        a1 = 2 * r * math.cos(2 * math.pi * f / TAXA)
+        a2 = -r * r
+        y = (1 - r) * x + a1 * self.y1 + a2 * self.y2
+        self.y2, self.y1 = self.y1, y
+        return y
+
+
+# Vogais (F1, F2, F3) do portugues
+VOGAIS = {
+    'a': (750, 1300, 2500), 'e': (450, 1900, 2600), 'i': (300, 2250, 3000),
+    'o': (450, 900, 2400), 'u': (320, 800, 2300), 'ao': (650, 1100, 2450),
+}
+
+# Frase: (vogal, duracao ms, pausa seguinte ms); 'S' = fricativa
+FRASE = [('ao', 220, 60), ('e', 160, 40), ('e', 180, 90), ('o', 150, 30),
+         ('S', 90, 20), ('o', 200, 70), ('i', 170, 50), ('a', 260, 0)]
+
+
+def fala():
+    s = []
+    ress = [Ressonador(), Ressonador(), Ressonador()]
+    glote = 0.0
+    fase = 0.0
+    total = sum(d + p for _, d, p in FRASE)
+    t_ms = 0.0
+    anterior = VOGAIS['a']
+    for vogal, dur, pausa in FRASE:
+        n = int(dur * TAXA / 1000)
+        seg = []
+        if vogal == 'S':
+            # Fricativa: chiado agudo filtrado
+            r = Ressonador()
+            for i in range(n):
+                env = min(1.0, i / 160, (n - i) / 160)
+                seg.append(env * r.passo(random.gauss(0, 1), 4200, 1500))
+        else:
+            alvo = VOGAIS[vogal]
+            for i in range(n):
+                # Entonacao descendente, jitter de 1%
+                f0 = (150 - 40 * (t_ms + i * 1000 / TAXA) / total) * (1 + 0.01 * random.gauss(0, 1))
+                fase += f0 / TAXA
+                pulso = 0.0
+                if fase >= 1.0:
+                    fase -= 1.0
+                    pulso = 1.0
+                glote = 0.9 * glote + pulso         # inclinacao espectral
+                k = min(1.0, i / (0.04 * TAXA))     # transicao de 40 ms entre vogais
+                fs = [a + (b - a) * k for a, b in zip(anterior, alvo)]
+                y = glote
+                for res, f, bw in zip(ress, fs, (80, 100, 150)):
+                    y = res.passo(y, f, bw) * 4
+                env = min(1.0, i / (0.015 * TAXA), (n - i) / (0.02 * TAXA))
+                seg.append(y * env)
+            anterior = alvo
+        # Nivel RMS por segmento: vogais bem acima do fundo, fricativa fraca
+        rms = math.sqrt(sum(x * x for x in seg) / len(seg))
+        s.extend(x * (600 if vogal == 'S' else 2500) / rms for x in seg)
+        s.extend([0.0] * int(pausa * TAXA / 1000))
+        t_ms += dur + pausa
+    return s
+
+
+def misturar(base, sinal, inicio_ms):
+    i0 = int(inicio_ms * TAXA / 1000)
+    for i, x in enumerate(sinal):
+        base[i0 + i] += x
+    return base
+
+
+if __name__ == '__main__':
+    # voz.wav: 4 s; a fala comeca em 800 ms e dura FRASE (1,78 s)
+    voz = misturar(fundo(4 * TAXA, 60, 300), fala(), 800)
+    escrever('voz.wav', voz)
+
+    # ruido.wav: 4 s de ventilador (chiado mais forte) e teclas batendo
+    ruido = fundo(4 * TAXA, 400, 300)
+    for t_ms in (700, 950, 1400, 1650, 2300, 2500, 3100):
+        i0 = int(t_ms * TAXA / 1000)
+        for i in range(int(0.006 * TAXA)):
+            ruido[i0 + i] += 6000 * math.exp(-i / 20) * random.gauss(0, 1)
+    escrever('ruido.wav', ruido)
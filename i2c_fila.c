@@ -0,0 +1,330 @@
+// i2c_fila.c - Fila de transacoes I2C por DMA, com prazo e recuperacao do barramento
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "quente.h"
+#include "i2c_fila.h"
+
+// Recuperacao: pulsos de SCL para um alvo preso no meio de um byte soltar
+// SDA, com meio periodo de 100 kHz
+#define I2C_FILA_PULSOS     9
+#define I2C_FILA_MEIO_US    5
+
+#define I2C_FILA_SEM_ALVO   0xFF    // forca a escrita de IC_TAR
+
+_Static_assert((I2C_FILA_TRANSACOES & (I2C_FILA_TRANSACOES - 1)) == 0,
+               "fila de transacoes deve ter tamanho potencia de 2");
+
+typedef struct {
+    i2c_fila_bloco_t blocos[I2C_FILA_BLOCOS + 1];   // + bloco nulo do fim
+    uint16_t palavras[I2C_FILA_PALAVRAS];           // escrita copiada
+    uint8_t n_palavras;                             // 0 = transacao por blocos
+    uint8_t addr;
+    uint32_t bytes;
+    i2c_fila_fim_t fim;
+} i2c_fila_transacao_t;
+
+// A cauda e a transacao em curso (ou a proxima); a cabeca, a proxima livre
+static i2c_fila_transacao_t barramento_fila[I2C_FILA_TRANSACOES];
+static volatile uint32_t barramento_cabeca, barramento_cauda;
+static volatile bool barramento_em_curso;
+static bool barramento_drenando;            // ultima transacao saindo da FIFO do I2C
+static uint32_t barramento_prazo_us;
+static uint32_t barramento_us_por_byte;
+static uint8_t barramento_alvo = I2C_FILA_SEM_ALVO;
+
+static i2c_inst_t *barramento_i2c;
+static uint32_t barramento_baudrate;
+static uint32_t barramento_clk_sys_hz;      // clk_sys do divisor de SCL atual
+static uint8_t barramento_sda, barramento_scl;
+static int barramento_dma_canal = -1;       // canal de dados
+static int barramento_dma_controle = -1;    // canal de blocos de controle
+static i2c_fila_stats_t barramento_stats;
+
+static i2c_fila_transacao_t *QUENTE(barramento_transacao)(uint32_t i) {
+    return &barramento_fila[i & (I2C_FILA_TRANSACOES - 1)];
+}
+
+// FIFO de transmissao vazia e nenhum byte no fio
+static bool QUENTE(barramento_livre)(void) {
+    uint32_t status = i2c_get_hw(barramento_i2c)->status;
+    return (status & I2C_IC_STATUS_TFE_BITS) && !(status & I2C_IC_STATUS_ACTIVITY_BITS);
+}
+
+// Um NAK do alvo aborta a transmissao e descarta a FIFO do I2C; o DMA nao
+// percebe e termina normalmente, entao o aborto e conferido no fim
+static bool QUENTE(barramento_abortou)(void) {
+    i2c_hw_t *hw = i2c_get_hw(barramento_i2c);
+    if (!(hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS))
+        return false;
+    (void)hw->clr_tx_abrt;
+    barramento_stats.abortos++;
+    return true;
+}
+
+// Taxa efetiva devolvida por i2c_init()/i2c_set_baudrate(), tomada com o
+// clk_sys do momento; 9 bits por byte (8 + ACK)
+static void barramento_taxa(uint32_t efetivo) {
+    if (efetivo == 0)
+        efetivo = barramento_baudrate;
+    barramento_us_por_byte = (9u * 1000000u + efetivo - 1) / efetivo;
+    barramento_clk_sys_hz = clock_get_hz(clk_sys);
+}
+
+// O I2C conta SCL em ciclos do clk_sys, que o governador de ociosidade
+// divide e restaura no nucleo 1 (energia_relogio()). A troca e vista aqui,
+// no nucleo dono do barramento, e o divisor refeito entre transacoes:
+// i2c_set_baudrate() desabilita o bloco, o que descartaria a FIFO. Retorna
+// false com bytes ainda saindo; i2c_fila_tarefa() tenta de novo.
+static bool barramento_acompanhar_relogio(void) {
+    if (clock_get_hz(clk_sys) == barramento_clk_sys_hz)
+        return true;
+    if (barramento_em_curso || !barramento_livre())
+        return false;
+    barramento_taxa(i2c_set_baudrate(barramento_i2c, barramento_baudrate));
+    barramento_stats.reajustes++;
+    return true;
+}
+
+// Inicia a transacao da cauda, se houver uma esperando
+static void QUENTE(barramento_iniciar)(void) {
+    if (barramento_em_curso || barramento_cabeca == barramento_cauda)
+        return;
+    if (!barramento_acompanhar_relogio())
+        return;
+    i2c_fila_transacao_t *t = barramento_transacao(barramento_cauda);
+    if (t->addr != barramento_alvo) {
+        // IC_TAR so muda com o I2C desabilitado, o que descartaria a FIFO:
+        // com bytes ainda saindo, i2c_fila_tarefa() tenta de novo
+        if (!barramento_livre())
+            return;
+        i2c_hw_t *hw = i2c_get_hw(barramento_i2c);
+        hw->enable = 0;
+        hw->tar = t->addr;
+        hw->enable = I2C_IC_ENABLE_ENABLE_BITS;
+        barramento_alvo = t->addr;
+    }
+    barramento_abortou();   // da transacao anterior, depois do fim dela
+
+    barramento_em_curso = true;
+    barramento_drenando = false;
+    barramento_prazo_us = time_us_32() + 2 * t->bytes * barramento_us_por_byte + I2C_FILA_MARGEM_US;
+    barramento_stats.transacoes++;
+    barramento_stats.bytes += t->bytes;
+    dma_channel_set_read_addr(barramento_dma_controle, t->blocos, true);
+}
+
+// Encerra a transacao em curso e passa para a proxima
+static void QUENTE(barramento_concluir)(bool ok) {
+    i2c_fila_fim_t fim = barramento_transacao(barramento_cauda)->fim;
+    barramento_em_curso = false;
+    barramento_cauda++;
+    barramento_drenando = true;
+    if (fim)
+        fim(ok);
+    barramento_iniciar();
+}
+
+static void QUENTE(barramento_dma_irq)(void) {
+    if (!dma_channel_get_irq0_status(barramento_dma_canal))
+        return;
+    dma_channel_acknowledge_irq0(barramento_dma_canal);
+    barramento_concluir(!barramento_abortou());
+}
+
+// Para o DMA, solta o barramento e reinicia o I2C. Custa no maximo
+// ~(I2C_FILA_PULSOS + 2) periodos de SCL a 100 kHz.
+static void barramento_recuperar(void) {
+    barramento_stats.recuperacoes++;
+    dma_channel_set_irq0_enabled(barramento_dma_canal, false);
+    dma_channel_abort(barramento_dma_controle);
+    dma_channel_abort(barramento_dma_canal);
+    dma_channel_acknowledge_irq0(barramento_dma_canal);
+    dma_channel_set_irq0_enabled(barramento_dma_canal, true);
+
+    // Dreno aberto pelo SIO: saida em 0 puxa a linha, entrada a solta para
+    // o pull-up. Cada pulso de SCL anda um bit do alvo que segura SDA.
+    gpio_init(barramento_sda);
+    gpio_init(barramento_scl);
+    for (int i = 0; i < I2C_FILA_PULSOS && !gpio_get(barramento_sda); i++) {
+        gpio_set_dir(barramento_scl, GPIO_OUT);
+        busy_wait_us_32(I2C_FILA_MEIO_US);
+        gpio_set_dir(barramento_scl, GPIO_IN);
+        busy_wait_us_32(I2C_FILA_MEIO_US);
+    }
+    // STOP: SDA sobe com SCL alto
+    gpio_set_dir(barramento_scl, GPIO_OUT);
+    gpio_set_dir(barramento_sda, GPIO_OUT);
+    busy_wait_us_32(I2C_FILA_MEIO_US);
+    gpio_set_dir(barramento_scl, GPIO_IN);
+    busy_wait_us_32(I2C_FILA_MEIO_US);
+    gpio_set_dir(barramento_sda, GPIO_IN);
+    busy_wait_us_32(I2C_FILA_MEIO_US);
+    if (!gpio_get(barramento_sda))
+        barramento_stats.presos++;
+
+    // O reset do bloco limpa a FIFO, o aborto e o alvo; o divisor sai do
+    // clk_sys de agora
+    barramento_taxa(i2c_init(barramento_i2c, barramento_baudrate));
+    gpio_set_function(barramento_sda, GPIO_FUNC_I2C);
+    gpio_set_function(barramento_scl, GPIO_FUNC_I2C);
+    barramento_alvo = I2C_FILA_SEM_ALVO;
+}
+
+void i2c_fila_init(i2c_inst_t *i2c, uint32_t baudrate, uint8_t pino_sda, uint8_t pino_scl) {
+    barramento_i2c = i2c;
+    barramento_baudrate = baudrate;
+    barramento_sda = pino_sda;
+    barramento_scl = pino_scl;
+    barramento_taxa(i2c_init(i2c, baudrate));
+    gpio_set_function(pino_sda, GPIO_FUNC_I2C);
+    gpio_set_function(pino_scl, GPIO_FUNC_I2C);
+    gpio_pull_up(pino_sda);
+    gpio_pull_up(pino_scl);
+
+    barramento_cabeca = barramento_cauda = 0;
+    barramento_em_curso = false;
+    barramento_drenando = false;
+    barramento_alvo = I2C_FILA_SEM_ALVO;
+    memset(&barramento_stats, 0, sizeof(barramento_stats));
+
+    // Canal de dados: palavras de 16 bits direto para IC_DATA_CMD, no ritmo
+    // da DREQ de transmissao do I2C. IRQ so no bloco nulo do fim da lista.
+    barramento_dma_canal = dma_claim_unused_channel(true);
+    barramento_dma_controle = dma_claim_unused_channel(true);
+
+    dma_channel_config c = dma_channel_get_default_config(barramento_dma_canal);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, i2c_get_dreq(i2c, true));
+    channel_config_set_chain_to(&c, barramento_dma_controle);
+    channel_config_set_irq_quiet(&c, true);
+    dma_channel_configure(barramento_dma_canal, &c, &i2c_get_hw(i2c)->data_cmd, NULL, 0, false);
+
+    // Canal de controle: copia um bloco (2 palavras) para al3_transfer_count
+    // e al3_read_addr_trig; o anel de 8 bytes volta ao inicio a cada bloco
+    dma_channel_config cc = dma_channel_get_default_config(barramento_dma_controle);
+    channel_config_set_transfer_data_size(&cc, DMA_SIZE_32);
+    channel_config_set_read_increment(&cc, true);
+    channel_config_set_write_increment(&cc, true);
+    channel_config_set_ring(&cc, true, 3);
+    dma_channel_configure(barramento_dma_controle, &cc,
+                          &dma_hw->ch[barramento_dma_canal].al3_transfer_count,
+                          NULL, 2, false);
+
+    dma_channel_set_irq0_enabled(barramento_dma_canal, true);
+    irq_add_shared_handler(DMA_IRQ_0, barramento_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+}
+
+static i2c_fila_transacao_t *QUENTE(barramento_nova)(uint8_t addr, i2c_fila_fim_t fim) {
+    if (barramento_cabeca - barramento_cauda >= I2C_FILA_TRANSACOES) {
+        barramento_stats.recusadas++;
+        return NULL;
+    }
+    i2c_fila_transacao_t *t = barramento_transacao(barramento_cabeca);
+    t->addr = addr;
+    t->fim = fim;
+    t->n_palavras = 0;
+    t->bytes = 0;
+    return t;
+}
+
+bool QUENTE(i2c_fila_blocos)(uint8_t addr, const i2c_fila_bloco_t *blocos, uint8_t n, i2c_fila_fim_t fim) {
+    if (n == 0 || n > I2C_FILA_BLOCOS)
+        return false;
+    uint32_t estado = save_and_disable_interrupts();
+    i2c_fila_transacao_t *t = barramento_nova(addr, fim);
+    if (t) {
+        for (uint8_t i = 0; i < n; i++) {
+            t->blocos[i] = blocos[i];
+            t->bytes += blocos[i].len;
+        }
+        t->blocos[n].len = 0;
+        t->blocos[n].read_addr = NULL;
+        barramento_cabeca++;
+        barramento_iniciar();
+    }
+    restore_interrupts(estado);
+    return t != NULL;
+}
+
+bool i2c_fila_escrever(uint8_t addr, uint8_t controle, const uint8_t *dados, uint8_t n, i2c_fila_fim_t fim) {
+    if (n == 0 || n >= I2C_FILA_PALAVRAS)
+        return false;
+    uint32_t estado = save_and_disable_interrupts();
+
+    // A ultima transacao da fila, se ainda nao comecou e for do mesmo tipo,
+    // recebe os bytes no fim
+    i2c_fila_transacao_t *t = NULL;
+    bool nova = false;
+    if (barramento_cabeca - barramento_cauda > (barramento_em_curso ? 1u : 0u)) {
+        i2c_fila_transacao_t *u = barramento_transacao(barramento_cabeca - 1);
+        if (u->n_palavras && u->addr == addr && u->palavras[0] == controle && u->fim == fim &&
+            u->n_palavras + n <= I2C_FILA_PALAVRAS) {
+            t = u;
+            t->palavras[t->n_palavras - 1] &= 0xFF;     // o STOP passa para o fim
+            barramento_stats.juntadas++;
+        }
+    }
+    if (!t) {
+        t = barramento_nova(addr, fim);
+        if (t) {
+            t->palavras[0] = controle;
+            t->n_palavras = 1;
+            t->blocos[1].len = 0;
+            t->blocos[1].read_addr = NULL;
+            nova = true;
+        }
+    }
+    if (t) {
+        for (uint8_t i = 0; i < n; i++)
+            t->palavras[t->n_palavras++] = dados[i];
+        t->palavras[t->n_palavras - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+        t->blocos[0].len = t->n_palavras;
+        t->blocos[0].read_addr = t->palavras;
+        t->bytes = t->n_palavras;
+        if (nova) {
+            barramento_cabeca++;
+            barramento_iniciar();
+        }
+    }
+    restore_interrupts(estado);
+    return t != NULL;
+}
+
+bool QUENTE(i2c_fila_livre)(void) {
+    return barramento_cabeca - barramento_cauda < I2C_FILA_TRANSACOES;
+}
+
+bool QUENTE(i2c_fila_ocupada)(void) {
+    return barramento_cabeca != barramento_cauda || !barramento_livre();
+}
+
+void QUENTE(i2c_fila_tarefa)(void) {
+    uint32_t estado = save_and_disable_interrupts();
+    bool livre = barramento_livre();
+    if (barramento_drenando && livre)
+        barramento_drenando = false;
+    bool vencido = (int32_t)(time_us_32() - barramento_prazo_us) > 0;
+    if (vencido && (barramento_em_curso || barramento_drenando)) {
+        barramento_stats.prazos++;
+        barramento_recuperar();
+        barramento_drenando = false;
+        if (barramento_em_curso)
+            barramento_concluir(false);
+    }
+    barramento_acompanhar_relogio();
+    barramento_iniciar();
+    restore_interrupts(estado);
+}
+
+void i2c_fila_get_stats(i2c_fila_stats_t *stats) {
+    *stats = barramento_stats;
+}
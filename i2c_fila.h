@@ -0,0 +1,78 @@
+// i2c_fila.h - Fila de transacoes I2C por DMA, com prazo e recuperacao do barramento
+//
+// Dono do barramento I2C: ninguem mais escreve nele nem espera por ele. Cada
+// transacao e uma escrita num alvo, descrita por blocos de palavras no
+// formato do registrador IC_DATA_CMD (byte nos 8 bits baixos, STOP no bit
+// 9). O DMA percorre os blocos por uma lista de blocos de controle e a IRQ
+// do fim inicia a proxima transacao da fila, sem a CPU no meio.
+//
+// Escritas de bytes (i2c_fila_escrever) sao copiadas para a fila; as que
+// chegam enquanto a anterior ainda espera a vez, com o mesmo alvo e o mesmo
+// byte de controle, entram na mesma transacao. Assim uma rajada de comandos
+// do SSD1306 vira um unico stream de comandos no barramento.
+//
+// Toda transacao tem um prazo, proporcional aos bytes (o dobro do tempo no
+// barramento, mais I2C_FILA_MARGEM_US). i2c_fila_tarefa() confere o prazo:
+// estourado, o DMA e abortado, o barramento recuperado (ate 9 pulsos em SCL
+// pelo SIO, ate o alvo soltar SDA, e um STOP) e o I2C reiniciado; a
+// transacao termina com falha e a fila segue. Uma falha no barramento custa
+// no maximo o prazo e a recuperacao, e nunca trava quem enfileira.
+
+#ifndef I2C_FILA_H
+#define I2C_FILA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/i2c.h"
+
+#define I2C_FILA_TRANSACOES 8       // transacoes na fila, a em curso inclusa
+#define I2C_FILA_BLOCOS     10      // blocos por transacao (i2c_fila_blocos)
+#define I2C_FILA_PALAVRAS   40      // bytes por escrita copiada, controle incluso
+#define I2C_FILA_MARGEM_US  2000
+
+// Bloco de palavras IC_DATA_CMD; a ultima palavra da transacao leva o STOP
+typedef struct {
+    uint32_t len;
+    const volatile void *read_addr;
+} i2c_fila_bloco_t;
+
+// Chamada ao fim de cada transacao (IRQ do DMA ou i2c_fila_tarefa())
+typedef void (*i2c_fila_fim_t)(bool ok);
+
+typedef struct {
+    uint32_t transacoes;        // iniciadas no barramento
+    uint32_t juntadas;          // escritas que entraram numa transacao ja na fila
+    uint32_t bytes;
+    uint32_t abortos;           // NAK ou perda de arbitragem (TX_ABRT)
+    uint32_t prazos;            // prazos estourados (transacao ou fim da FIFO)
+    uint32_t recuperacoes;      // recuperacoes do barramento
+    uint32_t presos;            // recuperacoes que nao liberaram SDA
+    uint32_t recusadas;         // fila cheia
+    uint32_t reajustes;         // divisor de SCL refeito apos troca do clk_sys
+} i2c_fila_stats_t;
+
+// Inicializa o I2C, os pinos (com pull-up) e os canais de DMA. Deve ser
+// chamada no nucleo que vai atender a IRQ do DMA e chamar i2c_fila_tarefa().
+void i2c_fila_init(i2c_inst_t *i2c, uint32_t baudrate, uint8_t pino_sda, uint8_t pino_scl);
+
+// Enfileira uma transacao por blocos (copiados; as palavras nao, e devem
+// ficar intactas ate fim). Retorna false com a fila cheia.
+bool i2c_fila_blocos(uint8_t addr, const i2c_fila_bloco_t *blocos, uint8_t n, i2c_fila_fim_t fim);
+
+// Enfileira o byte de controle seguido de n bytes, copiados. Retorna false
+// com a fila cheia ou n grande demais.
+bool i2c_fila_escrever(uint8_t addr, uint8_t controle, const uint8_t *dados, uint8_t n, i2c_fila_fim_t fim);
+
+// Ha lugar para mais uma transacao
+bool i2c_fila_livre(void);
+
+// true com transacoes na fila ou bytes ainda saindo da FIFO do I2C
+bool i2c_fila_ocupada(void);
+
+// Confere o prazo da transacao em curso e inicia uma que tenha ficado
+// esperando. Chamar periodicamente.
+void i2c_fila_tarefa(void);
+
+void i2c_fila_get_stats(i2c_fila_stats_t *stats);
+
+#endif // I2C_FILA_H
@@ -0,0 +1,252 @@
+// joystick.c - Mapeamento do joystick analogico para movimento do mouse
+
+#include "quente.h"
+#include "joystick.h"
+
+// Desvio maximo aceito do centro nominal na calibracao do boot
+#define JOYSTICK_CALIB_DESVIO_MAX   400
+
+// dt fora disso (primeira chamada, tarefa atrasada) e truncado
+#define JOYSTICK_DT_MIN_US          100
+#define JOYSTICK_DT_MAX_US          50000
+
+// Curso inicial de cada lado, antes de o aprendizado ver o curso real.
+// Menor que o de qualquer joystick: ate la a deflexao total so satura antes.
+#define JOYSTICK_ALCANCE_INICIAL    1600
+
+// Acompanhamento da deriva do centro: so com a deflexao abaixo de metade da
+// zona morta, com constante de tempo de 2^10 chamadas (~1 s a 1 kHz), ate
+// JOYSTICK_DERIVA_MAX do centro calibrado
+#define JOYSTICK_DERIVA_SHIFT       10
+#define JOYSTICK_DERIVA_MAX         400
+
+// Filtro: tau = 1 / (2 pi fc); com fc em 1/16 Hz, tau_us = 2546479 / fc_q4
+#define JOYSTICK_TAU_Q4_US          2546479u
+#define JOYSTICK_FC_MAX_Q4          (250 * 16)
+#define JOYSTICK_VEL_MAX_Q4         32767   // mantem beta * velocidade em 32 bits
+
+#define JOYSTICK_ACUMULO_MAX_Q      (JOYSTICK_ACUMULO_MAX << JOYSTICK_FRACAO_BITS)
+
+// v = 4 + 380 * (i / 16)^2, em 1/256 pixel por ms
+static const uint16_t joystick_curva_padrao[JOYSTICK_CURVA_PONTOS] = {
+    4, 5, 10, 17, 28, 41, 57, 77, 99, 124, 152, 184, 218, 255, 295, 338, 384
+};
+
+static void joystick_eixo_init(joystick_eixo_t *e, uint16_t centro) {
+    e->centro_q4 = (int32_t)centro << 4;
+    e->calibrado_q4 = e->centro_q4;
+    e->deriva_resto = 0;
+    e->pos_q4 = e->centro_q4;
+    e->vel_q4 = 0;
+    for (int lado = 0; lado < 2; lado++) {
+        e->alcance[lado] = JOYSTICK_ALCANCE_INICIAL;
+        e->escala[lado] = ((uint32_t)JOYSTICK_FUNDO_ESCALA << 16) / JOYSTICK_ALCANCE_INICIAL;
+    }
+}
+
+void joystick_init(joystick_t *j) {
+    j->zona_morta = 100;
+    j->raio_max = 2000;
+    joystick_set_curva(j, joystick_curva_padrao);
+    j->filtro = JOYSTICK_FILTRO_ONE_EURO;
+    j->fc_min_q4 = 24;          // 1,5 Hz: o ruido em repouso nao passa
+    j->beta_q4 = 24;            // +1,5 Hz por unidade/ms: ~30 Hz num movimento rapido
+    j->fc_derivada_q4 = 80;     // 5 Hz
+    joystick_eixo_init(&j->eixo[0], JOYSTICK_CENTRO_PADRAO);
+    joystick_eixo_init(&j->eixo[1], JOYSTICK_CENTRO_PADRAO);
+    j->filtro_iniciado = false;
+    j->acum_x = 0;
+    j->acum_y = 0;
+    j->ativo = false;
+}
+
+bool joystick_calibrar_centro(joystick_t *j, uint16_t adc_x, uint16_t adc_y) {
+    int dx = (int)adc_x - JOYSTICK_CENTRO_PADRAO;
+    int dy = (int)adc_y - JOYSTICK_CENTRO_PADRAO;
+    if (dx < -JOYSTICK_CALIB_DESVIO_MAX || dx > JOYSTICK_CALIB_DESVIO_MAX ||
+        dy < -JOYSTICK_CALIB_DESVIO_MAX || dy > JOYSTICK_CALIB_DESVIO_MAX)
+        return false;
+    joystick_eixo_init(&j->eixo[0], adc_x);
+    joystick_eixo_init(&j->eixo[1], adc_y);
+    j->filtro_iniciado = false;
+    return true;
+}
+
+void joystick_set_curva(joystick_t *j, const uint16_t curva[JOYSTICK_CURVA_PONTOS]) {
+    for (int i = 0; i < JOYSTICK_CURVA_PONTOS; i++)
+        j->curva[i] = curva[i];
+}
+
+// Raiz quadrada inteira, bit a bit (o M0+ nao tem FPU)
+static uint32_t QUENTE(joystick_isqrt)(uint32_t v) {
+    uint32_t r = 0;
+    uint32_t bit = 1u << 30;
+    while (bit > v)
+        bit >>= 2;
+    while (bit) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return r;
+}
+
+static int32_t QUENTE(joystick_limitar)(int32_t v) {
+    if (v > JOYSTICK_ACUMULO_MAX_Q)
+        return JOYSTICK_ACUMULO_MAX_Q;
+    if (v < -JOYSTICK_ACUMULO_MAX_Q)
+        return -JOYSTICK_ACUMULO_MAX_Q;
+    return v;
+}
+
+// Coeficiente do passa-baixas de corte fc_q4 para um passo de dt_us, Q15
+static uint32_t QUENTE(joystick_alfa)(uint32_t fc_q4, uint32_t dt_us) {
+    uint32_t tau_us = JOYSTICK_TAU_Q4_US / (fc_q4 ? fc_q4 : 1);
+    return (dt_us << 15) / (dt_us + tau_us);
+}
+
+static int32_t QUENTE(joystick_passo)(int32_t diferenca, uint32_t alfa_q15) {
+    return (int32_t)(((int64_t)diferenca * alfa_q15) >> 15);
+}
+
+static void QUENTE(joystick_filtrar)(const joystick_t *j, joystick_eixo_t *e, uint16_t adc, uint32_t dt_us) {
+    int32_t amostra = (int32_t)adc << 4;
+    if (j->filtro == JOYSTICK_FILTRO_NENHUM || !j->filtro_iniciado) {
+        e->pos_q4 = amostra;
+        e->vel_q4 = 0;
+        return;
+    }
+
+    uint32_t fc = j->fc_min_q4;
+    if (j->filtro == JOYSTICK_FILTRO_ONE_EURO) {
+        // Velocidade em relacao a posicao filtrada, ela propria suavizada
+        int32_t vel = (amostra - e->pos_q4) * 1000 / (int32_t)dt_us;
+        e->vel_q4 += joystick_passo(vel - e->vel_q4, joystick_alfa(j->fc_derivada_q4, dt_us));
+        uint32_t v = (uint32_t)(e->vel_q4 < 0 ? -e->vel_q4 : e->vel_q4);
+        if (v > JOYSTICK_VEL_MAX_Q4)
+            v = JOYSTICK_VEL_MAX_Q4;
+        fc += (j->beta_q4 * v) >> 4;
+        if (fc > JOYSTICK_FC_MAX_Q4)
+            fc = JOYSTICK_FC_MAX_Q4;
+    }
+    e->pos_q4 += joystick_passo(amostra - e->pos_q4, joystick_alfa(fc, dt_us));
+}
+
+// Deflexao do eixo em unidades do ADC
+static int32_t QUENTE(joystick_deflexao)(const joystick_eixo_t *e) {
+    return (e->pos_q4 - e->centro_q4) / 16;
+}
+
+// Deflexao em unidades de fundo de escala; o curso de cada lado so cresce,
+// e a escala e recalculada apenas quando ele muda
+static int32_t QUENTE(joystick_normalizar)(joystick_eixo_t *e, int32_t d) {
+    int lado = d < 0;
+    uint32_t m = (uint32_t)(lado ? -d : d);
+    if (m > e->alcance[lado]) {
+        e->alcance[lado] = (uint16_t)m;
+        e->escala[lado] = ((uint32_t)JOYSTICK_FUNDO_ESCALA << 16) / m;
+    }
+    int32_t n = (int32_t)((m * e->escala[lado]) >> 16);
+    return lado ? -n : n;
+}
+
+// Centro segue a posicao em repouso, a ate JOYSTICK_DERIVA_MAX do centro
+// calibrado no boot (e nao do nominal: um joystick calibrado longe de 2048
+// ainda deriva para os dois lados). A fracao do passo fica no resto para a
+// proxima chamada: so com o deslocamento, abaixo de 2^10 / 16 = 64 unidades
+// ele sairia zero (e -1 para baixo), e o centro nunca subiria.
+static void QUENTE(joystick_seguir_centro)(joystick_eixo_t *e) {
+    const int32_t min = e->calibrado_q4 - (JOYSTICK_DERIVA_MAX << 4);
+    const int32_t max = e->calibrado_q4 + (JOYSTICK_DERIVA_MAX << 4);
+    e->deriva_resto += e->pos_q4 - e->centro_q4;
+    int32_t passo = e->deriva_resto / (1 << JOYSTICK_DERIVA_SHIFT);
+    e->deriva_resto -= passo * (1 << JOYSTICK_DERIVA_SHIFT);
+    int32_t c = e->centro_q4 + passo;
+    if (c < min || c > max) {
+        c = c < min ? min : max;
+        e->deriva_resto = 0;
+    }
+    e->centro_q4 = c;
+}
+
+bool QUENTE(joystick_atualizar)(joystick_t *j, uint16_t adc_x, uint16_t adc_y, uint32_t dt_us) {
+    if (dt_us > JOYSTICK_DT_MAX_US)
+        dt_us = JOYSTICK_DT_MAX_US;
+    else if (dt_us < JOYSTICK_DT_MIN_US)
+        dt_us = JOYSTICK_DT_MIN_US;
+
+    joystick_filtrar(j, &j->eixo[0], adc_x, dt_us);
+    joystick_filtrar(j, &j->eixo[1], adc_y, dt_us);
+    j->filtro_iniciado = true;
+
+    // A zona morta vale em unidades do ADC: antes de o curso ser aprendido
+    // a escala amplia a deflexao, e um centro torto sairia da zona morta
+    int32_t x = joystick_deflexao(&j->eixo[0]);
+    int32_t y = joystick_deflexao(&j->eixo[1]);
+    uint32_t r = joystick_isqrt((uint32_t)(x * x + y * y));
+
+    if (r <= j->zona_morta) {
+        if (2 * r <= j->zona_morta) {
+            joystick_seguir_centro(&j->eixo[0]);
+            joystick_seguir_centro(&j->eixo[1]);
+        }
+        // Descarta a fracao pendente para o cursor nao "escorregar" um
+        // pixel depois que o joystick volta ao centro
+        j->acum_x = 0;
+        j->acum_y = 0;
+        j->ativo = false;
+        return false;
+    }
+    j->ativo = true;
+
+    x = joystick_normalizar(&j->eixo[0], x);
+    y = joystick_normalizar(&j->eixo[1], y);
+    r = joystick_isqrt((uint32_t)(x * x + y * y));
+    if (r <= j->zona_morta)
+        r = j->zona_morta + 1;  // curso ainda maior que 2048: fica no inicio da curva
+
+    // Deflexao apos a zona morta em 1/256 de segmento da curva
+    uint32_t faixa = j->raio_max > j->zona_morta ? j->raio_max - j->zona_morta : 1;
+    uint32_t d = (r - j->zona_morta) * ((JOYSTICK_CURVA_PONTOS - 1) << 8) / faixa;
+    uint32_t v;
+    if (d >= (JOYSTICK_CURVA_PONTOS - 1) << 8) {
+        v = j->curva[JOYSTICK_CURVA_PONTOS - 1];
+    } else {
+        uint32_t i = d >> 8, f = d & 0xFF;
+        v = (j->curva[i] * (256 - f) + j->curva[i + 1] * f) >> 8;
+    }
+
+    // Deslocamento no intervalo (1/256 px), repartido entre os eixos na
+    // direcao da deflexao
+    uint32_t passo = v * dt_us / 1000;
+    if (passo > 2 * JOYSTICK_ACUMULO_MAX_Q)
+        passo = 2 * JOYSTICK_ACUMULO_MAX_Q;
+    j->acum_x = joystick_limitar(j->acum_x + (int32_t)passo * x / (int32_t)r);
+    j->acum_y = joystick_limitar(j->acum_y + (int32_t)passo * y / (int32_t)r);
+    return true;
+}
+
+bool QUENTE(joystick_pendente)(const joystick_t *j) {
+    const int32_t um = 1 << JOYSTICK_FRACAO_BITS;
+    return j->acum_x >= um || j->acum_x <= -um ||
+           j->acum_y >= um || j->acum_y <= -um;
+}
+
+static int8_t QUENTE(joystick_extrair_eixo)(int32_t *acum) {
+    int32_t px = *acum / (1 << JOYSTICK_FRACAO_BITS);  // trunca para zero
+    if (px > 127)
+        px = 127;
+    else if (px < -127)
+        px = -127;
+    *acum -= px * (1 << JOYSTICK_FRACAO_BITS);
+    return (int8_t)px;
+}
+
+void QUENTE(joystick_extrair)(joystick_t *j, int8_t *dx, int8_t *dy) {
+    *dx = joystick_extrair_eixo(&j->acum_x);
+    *dy = joystick_extrair_eixo(&j->acum_y);
+}
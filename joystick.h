@@ -0,0 +1,99 @@
+// joystick.h - Mapeamento do joystick analogico para movimento do mouse
+//
+// Converte a deflexao do joystick (amostras de 12 bits do ADC, ja com a
+// media de sobreamostragem feita pelo chamador) em velocidade do cursor e
+// integra essa velocidade no tempo em ponto fixo:
+//   1. filtra cada eixo: One-Euro (passa-baixas cujo corte sobe com a
+//      velocidade: em repouso o ruido some, em movimento rapido o atraso e
+//      minimo), passa-baixas de corte fixo ou nada;
+//   2. desconta o centro calibrado no boot, que depois acompanha devagar a
+//      deriva mecanica enquanto o joystick esta bem no meio da zona morta;
+//   3. aplica uma zona morta radial (circular, sem cantos travados), em
+//      unidades do ADC;
+//   4. normaliza cada lado de cada eixo pelo maior curso ja visto nele
+//      (aprendido durante o uso), para que um joystick assimetrico chegue
+//      ao fundo de escala, JOYSTICK_FUNDO_ESCALA, nas quatro direcoes;
+//   5. consulta a curva de aceleracao, uma tabela de velocidades
+//      interpolada linearmente;
+//   6. acumula o deslocamento em 1/256 de pixel, de modo que deflexoes
+//      pequenas ainda movem o cursor, so que mais devagar.
+// O deslocamento inteiro e retirado do acumulador apenas quando um relatorio
+// HID pode ser enviado, limitado a int8; o que sobra fica para o proximo.
+// O modulo so faz contas: a leitura do ADC e o envio ficam com o chamador.
+
+#ifndef JOYSTICK_H
+#define JOYSTICK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define JOYSTICK_CURVA_PONTOS   17      // 16 segmentos de deflexao
+#define JOYSTICK_FRACAO_BITS    8       // acumulador em 1/256 de pixel
+#define JOYSTICK_CENTRO_PADRAO  2048
+#define JOYSTICK_FUNDO_ESCALA   2048    // deflexao maxima apos a normalizacao
+
+// Deslocamento maximo guardado no acumulador, em pixels. Limita o "arrasto"
+// do cursor quando o host demora a pedir relatorios.
+#define JOYSTICK_ACUMULO_MAX    254
+
+typedef enum {
+    JOYSTICK_FILTRO_NENHUM,
+    JOYSTICK_FILTRO_EMA,        // passa-baixas de corte fixo (fc_min)
+    JOYSTICK_FILTRO_ONE_EURO,   // corte fc_min + beta * velocidade
+} joystick_filtro_t;
+
+// Estado de um eixo; posicoes em 1/16 de unidade do ADC
+typedef struct {
+    int32_t centro_q4;
+    int32_t calibrado_q4;       // centro do boot; a deriva fica a +-400 dele
+    int32_t deriva_resto;       // fracao do passo da deriva ainda nao aplicada
+    int32_t pos_q4;             // posicao filtrada
+    int32_t vel_q4;             // velocidade filtrada, por ms
+    uint16_t alcance[2];        // maior curso visto do centro: [0] = +, [1] = -
+    uint32_t escala[2];         // JOYSTICK_FUNDO_ESCALA / alcance, Q16
+} joystick_eixo_t;
+
+typedef struct {
+    // Parametros
+    uint16_t zona_morta;        // raio em unidades do ADC
+    uint16_t raio_max;          // raio da deflexao total, em unidades de fundo de escala
+    // Velocidade em 1/256 pixel por ms para deflexoes de 0 a 100%, em passos
+    // iguais apos a zona morta
+    uint16_t curva[JOYSTICK_CURVA_PONTOS];
+    // Filtro (joystick_filtro_t); cortes em 1/16 Hz, beta em 1/16 Hz por
+    // unidade do ADC/ms de velocidade
+    uint8_t filtro;
+    uint16_t fc_min_q4;
+    uint16_t beta_q4;
+    uint16_t fc_derivada_q4;    // corte do filtro da velocidade (One-Euro)
+
+    // Estado
+    joystick_eixo_t eixo[2];    // x, y
+    bool filtro_iniciado;       // primeira amostra ja carregada no filtro
+    int32_t acum_x;             // 1/256 pixel
+    int32_t acum_y;
+    bool ativo;                 // fora da zona morta na ultima amostra
+} joystick_t;
+
+// Parametros padrao: centro em 2048, zona morta de 100, curva quadratica de
+// ~16 px/s ate 1500 px/s e One-Euro com corte de 1,5 Hz em repouso
+void joystick_init(joystick_t *j);
+
+// Define o centro a partir da media das leituras em repouso e recomeca o
+// aprendizado do curso. Se a leitura estiver longe demais do centro nominal
+// (joystick tocado no boot), mantem o centro padrao e retorna false.
+bool joystick_calibrar_centro(joystick_t *j, uint16_t adc_x, uint16_t adc_y);
+
+void joystick_set_curva(joystick_t *j, const uint16_t curva[JOYSTICK_CURVA_PONTOS]);
+
+// Filtra a leitura e integra dt_us microssegundos de movimento com a
+// deflexao resultante. Retorna true se o joystick esta fora da zona morta.
+bool joystick_atualizar(joystick_t *j, uint16_t adc_x, uint16_t adc_y, uint32_t dt_us);
+
+// true se ha pelo menos um pixel inteiro acumulado em algum eixo
+bool joystick_pendente(const joystick_t *j);
+
+// Retira do acumulador a parte inteira do deslocamento, limitada a int8
+void joystick_extrair(joystick_t *j, int8_t *dx, int8_t *dy);
+
+#endif // JOYSTICK_H
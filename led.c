@@ -0,0 +1,56 @@
+// led.c - Indicadores no LED RGB da BitDogLab por PIO, sem custo de CPU
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/pio.h"
+#include "blink.pio.h"
+#include "led.h"
+
+// Um tique de blink.pio (1 ms) sao 10 ciclos da maquina de estados
+#define LED_TIQUE_HZ        1000
+#define LED_CICLOS_TIQUE    10
+
+#define LED_PIO             pio0
+
+static uint led_sm[LED_CORES];
+static uint led_offset;
+static uint32_t led_atual[LED_CORES];
+
+void led_init(uint8_t pino_vermelho, uint8_t pino_verde) {
+    const uint8_t pinos[LED_CORES] = {
+        [LED_VERMELHO] = pino_vermelho,
+        [LED_VERDE] = pino_verde,
+    };
+    led_offset = pio_add_program(LED_PIO, &blink_program);
+    for (int i = 0; i < LED_CORES; i++) {
+        led_sm[i] = (uint)pio_claim_unused_sm(LED_PIO, true);
+        blink_program_init(LED_PIO, led_sm[i], led_offset, pinos[i]);
+        led_atual[i] = 0;   // palavra 0: o pino fica como esta (apagado)
+    }
+    led_ajustar_relogio();
+    for (int i = 0; i < LED_CORES; i++)
+        pio_sm_set_enabled(LED_PIO, led_sm[i], true);
+}
+
+void led_ajustar_relogio(void) {
+    float div = (float)clock_get_hz(clk_sys) / (LED_TIQUE_HZ * LED_CICLOS_TIQUE);
+    for (int i = 0; i < LED_CORES; i++)
+        pio_sm_set_clkdiv(LED_PIO, led_sm[i], div);
+}
+
+void led_padrao(uint8_t cor, uint32_t padrao) {
+    if (cor >= LED_CORES || padrao == led_atual[cor])
+        return;
+    led_atual[cor] = padrao;
+
+    // Com a maquina parada nao ha corrida com o pull do fim da rajada: a
+    // palavra entra na FIFO vazia e o programa recomeca do inicio, onde ela
+    // e lida. O padrao antigo nao espera a rajada acabar.
+    uint sm = led_sm[cor];
+    pio_sm_set_enabled(LED_PIO, sm, false);
+    pio_sm_clear_fifos(LED_PIO, sm);
+    pio_sm_restart(LED_PIO, sm);
+    pio_sm_put(LED_PIO, sm, padrao);
+    pio_sm_exec(LED_PIO, sm, pio_encode_jmp(led_offset));
+    pio_sm_set_enabled(LED_PIO, sm, true);
+}
@@ -0,0 +1,42 @@
+// led.h - Indicadores no LED RGB da BitDogLab por PIO, sem custo de CPU
+//
+// Cada cor e uma maquina de estados do PIO rodando blink.pio, que repete
+// sozinha um padrao: tempo aceso e apagado, pulsos por rajada e pausa
+// entre rajadas. Trocar de padrao e escrever uma palavra na FIFO (e
+// reiniciar a maquina, para valer na hora); a CPU nao participa do piscar.
+//
+// So vermelho (GPIO 13) e verde (GPIO 11): o azul da BitDogLab (GPIO 12) e
+// o pino do buzzer neste projeto.
+
+#ifndef LED_H
+#define LED_H
+
+#include <stdint.h>
+
+#define LED_VERMELHO    0
+#define LED_VERDE       1
+#define LED_CORES       2
+
+// Palavra de padrao de blink.pio: aceso e apagado em ms (0 a 1023; 0 pula a
+// fase), pulsos por rajada (1 a 64) e pausa depois da rajada em unidades de
+// ~100 ms (0 a 63)
+#define LED_PADRAO(aceso_ms, apagado_ms, pulsos, pausa) \
+    ((uint32_t)(aceso_ms) | ((uint32_t)(apagado_ms) << 10) | \
+     ((uint32_t)((pulsos) - 1) << 20) | ((uint32_t)(pausa) << 26))
+
+#define LED_APAGADO     LED_PADRAO(0, 1, 1, 0)
+#define LED_ACESO       LED_PADRAO(1, 0, 1, 0)
+
+// Carrega blink.pio no PIO0 e reserva uma maquina por cor, com o LED
+// apagado
+void led_init(uint8_t pino_vermelho, uint8_t pino_verde);
+
+// Troca o padrao de uma cor; nada acontece se ja for o atual. Chamar
+// sempre do mesmo nucleo.
+void led_padrao(uint8_t cor, uint32_t padrao);
+
+// O tique vem do clk_sys: chamar depois de muda-lo (energia.c). Mexe so no
+// divisor das maquinas e pode ser chamada do outro nucleo.
+void led_ajustar_relogio(void);
+
+#endif // LED_H
@@ -0,0 +1,227 @@
+// microfone_usb.c - Microfone (ADC canal 2) como dispositivo de audio USB
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "tusb.h"
+#include "adc_stream.h"
+#include "usb_descriptors.h"
+#include "microfone_usb.h"
+
+// Entidades do TUD_AUDIO_MIC_ONE_CH_DESCRIPTOR (usb_descriptors.c)
+#define MIC_ENTIDADE_TERMINAL   0x01
+#define MIC_ENTIDADE_FEATURE    0x02
+#define MIC_ENTIDADE_RELOGIO    0x04
+
+// Maior decimacao atendida: ADC a 128 kS/s por canal para 16 kHz
+#define MIC_DECIMACAO_MAX       8
+
+// Consumo atrasado demais (tarefa USB parada): volta para a reserva
+#define MIC_NIVEL_MAX           (MICROFONE_USB_RESERVA + 4 * MICROFONE_USB_NOMINAL)
+
+_Static_assert(MICROFONE_USB_TAXA_HZ % 1000 == 0, "pacotes de 1 ms precisam de amostras inteiras");
+_Static_assert(CFG_TUD_AUDIO_EP_SZ_IN >= MICROFONE_USB_AMOSTRAS_MAX * 2,
+               "endpoint de audio menor que o maior pacote");
+
+static volatile bool mic_ativo;
+static uint32_t mic_cursor;             // quadros do adc_stream ja consumidos
+static int32_t mic_dc_q8;               // nivel DC do ADC, Q8
+static uint32_t mic_ultimo_us;
+static bool mic_mudo;
+static microfone_usb_stats_t mic_stats;
+
+// Amostras brutas de um pacote; o PCM e escrito por cima, no mesmo lugar
+static uint16_t mic_pacote[MICROFONE_USB_AMOSTRAS_MAX * MIC_DECIMACAO_MAX];
+
+// Quantos quadros do ADC formam uma amostra do fluxo; 0 com o ADC lento
+// demais (OCIOSO ainda nao desfeito), quando o pacote sai em silencio
+static uint32_t mic_decimacao(void) {
+    uint32_t d = (adc_stream_taxa_hz() + MICROFONE_USB_TAXA_HZ / 2) / MICROFONE_USB_TAXA_HZ;
+    return d <= MIC_DECIMACAO_MAX ? d : 0;
+}
+
+static void mic_abrir(void) {
+    if (mic_ativo)
+        return;
+    // Comeca com a reserva e um pacote ja capturados
+    uint32_t d = mic_decimacao();
+    mic_cursor = adc_stream_quadros() - (MICROFONE_USB_RESERVA + MICROFONE_USB_NOMINAL) * d;
+    mic_dc_q8 = (int32_t)adc_stream_ultima(ADC_STREAM_MIC) << 8;
+    mic_ultimo_us = 0;
+    mic_ativo = true;
+}
+
+// Monta o proximo pacote em mic_pacote; retorna o numero de amostras
+static uint32_t mic_montar(void) {
+    uint32_t d = mic_decimacao();
+    if (d == 0) {
+        memset(mic_pacote, 0, MICROFONE_USB_NOMINAL * 2);
+        mic_cursor = adc_stream_quadros();
+        return MICROFONE_USB_NOMINAL;
+    }
+
+    uint32_t nivel = (adc_stream_quadros() - mic_cursor) / d;
+    if (nivel > MIC_NIVEL_MAX) {
+        mic_stats.perdidas += nivel - MICROFONE_USB_RESERVA - MICROFONE_USB_NOMINAL;
+        mic_cursor = adc_stream_quadros() - (MICROFONE_USB_RESERVA + MICROFONE_USB_NOMINAL) * d;
+        nivel = MICROFONE_USB_RESERVA + MICROFONE_USB_NOMINAL;
+    }
+
+    // Uma amostra a mais ou a menos segura o nivel perto da reserva
+    uint32_t n = MICROFONE_USB_NOMINAL;
+    if (nivel > MICROFONE_USB_RESERVA + 2 * MICROFONE_USB_NOMINAL)
+        n++;
+    else if (nivel < MICROFONE_USB_RESERVA)
+        n--;
+    if (nivel < n) {
+        mic_stats.subfluxos++;
+        n = nivel;
+    }
+
+    uint32_t perdidas = 0;
+    n = adc_stream_ler(ADC_STREAM_MIC, &mic_cursor, mic_pacote, n * d, &perdidas) / d;
+    mic_stats.perdidas += perdidas;
+
+    // Media de d amostras, sem o nivel DC (passa-altas de ~2 Hz a 16 kHz),
+    // 12 bits do ADC em 16 com sinal
+    int16_t *pcm = (int16_t *)mic_pacote;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t soma = 0;
+        for (uint32_t k = 0; k < d; k++)
+            soma += mic_pacote[i * d + k];
+        int32_t v = (int32_t)((soma << 8) / d);
+        mic_dc_q8 += (v - mic_dc_q8) >> 10;
+        int32_t s = (v - mic_dc_q8) >> 4;
+        pcm[i] = mic_mudo ? 0 : (int16_t)(s > INT16_MAX ? INT16_MAX : s < INT16_MIN ? INT16_MIN : s);
+    }
+
+    nivel -= n;
+    mic_stats.nivel_ultimo = nivel;
+    if (nivel < mic_stats.nivel_min)
+        mic_stats.nivel_min = nivel;
+    if (nivel > mic_stats.nivel_max)
+        mic_stats.nivel_max = nivel;
+    return n;
+}
+
+void microfone_usb_init(void) {
+    mic_ativo = false;
+    mic_mudo = false;
+    memset(&mic_stats, 0, sizeof(mic_stats));
+    mic_stats.nivel_min = UINT32_MAX;
+}
+
+bool microfone_usb_ativo(void) {
+    return mic_ativo;
+}
+
+void microfone_usb_get_stats(microfone_usb_stats_t *stats) {
+    *stats = mic_stats;
+    if (stats->pacotes == 0)
+        stats->nivel_min = 0;
+}
+
+// =====================
+// Callbacks do TinyUSB (tud_task, nucleo 1)
+// =====================
+// Chamado quando o pacote anterior saiu: o proximo vai para a FIFO do
+// endpoint e segue no quadro seguinte
+bool tud_audio_tx_done_pre_load_cb(uint8_t rhport, uint8_t itf, uint8_t ep_in, uint8_t cur_alt_setting) {
+    (void)rhport; (void)itf; (void)ep_in; (void)cur_alt_setting;
+    mic_abrir();
+
+    uint32_t agora = time_us_32();
+    if (mic_ultimo_us != 0 && agora - mic_ultimo_us > mic_stats.intervalo_max_us)
+        mic_stats.intervalo_max_us = agora - mic_ultimo_us;
+    mic_ultimo_us = agora;
+
+    uint32_t n = mic_montar();
+    if (n != 0)
+        tud_audio_write(mic_pacote, (uint16_t)(n * 2));
+    mic_stats.pacotes++;
+    mic_stats.amostras += n;
+    return true;
+}
+
+bool tud_audio_set_itf_cb(uint8_t rhport, tusb_control_request_t const *p_request) {
+    (void)rhport;
+    if (tu_u16_low(p_request->wIndex) == USB_ITF_AUDIO_STREAMING && tu_u16_low(p_request->wValue) != 0)
+        mic_abrir();
+    return true;
+}
+
+bool tud_audio_set_itf_close_EP_cb(uint8_t rhport, tusb_control_request_t const *p_request) {
+    (void)rhport;
+    if (tu_u16_low(p_request->wIndex) == USB_ITF_AUDIO_STREAMING)
+        mic_ativo = false;
+    return true;
+}
+
+bool tud_audio_get_req_entity_cb(uint8_t rhport, tusb_control_request_t const *p_request) {
+    uint8_t controle = tu_u16_high(p_request->wValue);
+    uint8_t entidade = tu_u16_high(p_request->wIndex);
+
+    if (entidade == MIC_ENTIDADE_TERMINAL && controle == AUDIO_TE_CTRL_CONNECTOR) {
+        audio_desc_channel_cluster_t cluster = {
+            .bNrChannels = 1,
+            .bmChannelConfig = (audio_channel_config_t)0,
+            .iChannelNames = 0,
+        };
+        return tud_audio_buffer_and_schedule_control_xfer(rhport, p_request, &cluster, sizeof(cluster));
+    }
+
+    if (entidade == MIC_ENTIDADE_FEATURE) {
+        if (controle == AUDIO_FU_CTRL_MUTE) {
+            audio_control_cur_1_t mudo = { .bCur = mic_mudo };
+            return tud_audio_buffer_and_schedule_control_xfer(rhport, p_request, &mudo, sizeof(mudo));
+        }
+        if (controle == AUDIO_FU_CTRL_VOLUME && p_request->bRequest == AUDIO_CS_REQ_CUR) {
+            audio_control_cur_2_t volume = { .bCur = 0 };   // 0 dB, sem ganho
+            return tud_audio_buffer_and_schedule_control_xfer(rhport, p_request, &volume, sizeof(volume));
+        }
+        if (controle == AUDIO_FU_CTRL_VOLUME && p_request->bRequest == AUDIO_CS_REQ_RANGE) {
+            audio_control_range_2_n_t(1) faixa = {
+                .wNumSubRanges = tu_htole16(1),
+                .subrange[0] = { .bMin = 0, .bMax = 0, .bRes = tu_htole16(256) },
+            };
+            return tud_audio_buffer_and_schedule_control_xfer(rhport, p_request, &faixa, sizeof(faixa));
+        }
+        return false;
+    }
+
+    if (entidade == MIC_ENTIDADE_RELOGIO) {
+        if (controle == AUDIO_CS_CTRL_SAM_FREQ && p_request->bRequest == AUDIO_CS_REQ_CUR) {
+            audio_control_cur_4_t taxa = { .bCur = (int32_t)tu_htole32(MICROFONE_USB_TAXA_HZ) };
+            return tud_audio_buffer_and_schedule_control_xfer(rhport, p_request, &taxa, sizeof(taxa));
+        }
+        if (controle == AUDIO_CS_CTRL_SAM_FREQ && p_request->bRequest == AUDIO_CS_REQ_RANGE) {
+            audio_control_range_4_n_t(1) faixa = {
+                .wNumSubRanges = tu_htole16(1),
+                .subrange[0] = { .bMin = (int32_t)tu_htole32(MICROFONE_USB_TAXA_HZ),
+                                 .bMax = (int32_t)tu_htole32(MICROFONE_USB_TAXA_HZ),
+                                 .bRes = 0 },
+            };
+            return tud_audio_buffer_and_schedule_control_xfer(rhport, p_request, &faixa, sizeof(faixa));
+        }
+        if (controle == AUDIO_CS_CTRL_CLK_VALID) {
+            audio_control_cur_1_t valido = { .bCur = 1 };
+            return tud_audio_buffer_and_schedule_control_xfer(rhport, p_request, &valido, sizeof(valido));
+        }
+    }
+    return false;
+}
+
+bool tud_audio_set_req_entity_cb(uint8_t rhport, tusb_control_request_t const *p_request, uint8_t *pBuff) {
+    (void)rhport;
+    uint8_t controle = tu_u16_high(p_request->wValue);
+    uint8_t entidade = tu_u16_high(p_request->wIndex);
+    if (entidade != MIC_ENTIDADE_FEATURE || p_request->bRequest != AUDIO_CS_REQ_CUR)
+        return false;
+    if (controle == AUDIO_FU_CTRL_MUTE) {
+        mic_mudo = ((audio_control_cur_1_t *)pBuff)->bCur != 0;
+        return true;
+    }
+    if (controle == AUDIO_FU_CTRL_VOLUME) {
+        return true;    // a faixa anunciada e so 0 dB: nada a mudar
+    }
+    return false;
+}
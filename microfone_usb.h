@@ -0,0 +1,58 @@
+// microfone_usb.h - Microfone (ADC canal 2) como dispositivo de audio USB
+//
+// Interface de captura da classe de audio do TinyUSB (UAC2, a unica do
+// TinyUSB do SDK), com um canal PCM de 16 bits a MICROFONE_USB_TAXA_HZ num
+// endpoint isocrono assincrono. Nao ha fila de audio propria: cada pacote
+// e montado numa so passada a partir do anel do DMA do ADC (adc_stream.h),
+// em PCM com sinal, sem o nivel DC e decimado se o ADC amostrar mais
+// rapido, e o TinyUSB o copia inteiro para a RAM do endpoint.
+//
+// O caminho e da CPU, nao DMA direto para o endpoint: a decimacao e o
+// passa-altas do DC precisam dela de qualquer forma, e a classe de audio
+// do TinyUSB e dona do buffer do endpoint. Sao 16 amostras (x decimacao)
+// por quadro de 1 ms e uma copia de 34 bytes, dentro do passo da tarefa
+// USB. O roteiro host/roteiros/audio.txt roda este modulo no host com o
+// relogio do ADC desviado do SOF e sob carga e confere os subfluxos.
+//
+// O consumo fica MICROFONE_USB_RESERVA amostras atras do DMA, para
+// absorver o atraso da tarefa USB. Cada pacote leva a taxa nominal por
+// quadro, uma amostra a mais ou a menos quando o nivel se afasta da
+// reserva: assim o relogio do ADC e o do host nao precisam ser iguais.
+// Pacote sem amostras suficientes no anel e um subfluxo; o nivel (amostras
+// prontas depois de cada pacote) e o intervalo entre pacotes vao nas
+// estatisticas, que mostram a margem real contra subfluxos.
+//
+// Roda no nucleo do TinyUSB (nucleo 1), o mesmo do adc_stream.
+
+#ifndef MICROFONE_USB_H
+#define MICROFONE_USB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MICROFONE_USB_TAXA_HZ       16000   // 8000 ou 16000; divisor da taxa do ADC
+#define MICROFONE_USB_NOMINAL       (MICROFONE_USB_TAXA_HZ / 1000)  // amostras por quadro
+#define MICROFONE_USB_AMOSTRAS_MAX  (MICROFONE_USB_NOMINAL + 1)
+#define MICROFONE_USB_RESERVA       (2 * MICROFONE_USB_NOMINAL)     // 2 ms
+
+typedef struct {
+    uint32_t pacotes;               // pacotes isocronos preparados
+    uint32_t amostras;              // amostras enviadas
+    uint32_t subfluxos;             // pacotes sem amostras suficientes no anel
+    uint32_t perdidas;              // amostras puladas (o anel do ADC deu a volta)
+    uint32_t intervalo_max_us;      // maior intervalo entre dois pacotes
+    uint32_t nivel_ultimo;          // amostras prontas no anel depois do pacote
+    uint32_t nivel_min;
+    uint32_t nivel_max;
+} microfone_usb_stats_t;
+
+// Chamar no nucleo 1, depois de adc_stream_init()
+void microfone_usb_init(void);
+
+// O host abriu o fluxo (interface de streaming na alternativa 1); enquanto
+// isso o ADC precisa ficar numa taxa multipla de MICROFONE_USB_TAXA_HZ
+bool microfone_usb_ativo(void);
+
+void microfone_usb_get_stats(microfone_usb_stats_t *stats);
+
+#endif // MICROFONE_USB_H
@@ -0,0 +1,141 @@
+// painel.c - Eventos de entrada no display, do lado do nucleo 0
+
+#include "pico/stdlib.h"
+#include "i2c_fila.h"
+#include "ssd1306.h"
+#include "ui.h"
+#include "painel.h"
+
+// Periodos das tarefas do nucleo 0 (us), e em OCIOSO (energia.h)
+#define PERIODO_EVENTOS_US          5000
+#define PERIODO_DISPLAY_US         10000
+#define PERIODO_EVENTOS_OCIOSO_US  20000
+#define PERIODO_DISPLAY_OCIOSO_US 100000
+
+// Contraste do OLED ativo e escurecido
+#define DISPLAY_CONTRASTE         0xFF
+#define DISPLAY_CONTRASTE_ESCURO  0x08
+
+// =====================
+// Status no display (tarefa nao bloqueante)
+// =====================
+// O texto base vem do joystick ("Em uso"/"Aguardando"); os botoes A/B exibem
+// mensagens temporarias por cima dele. A mensagem vai para o campo principal
+// da camada de UI (ui.c), que junto com os campos de estado (modo, joystick,
+// microfone, USB) redesenha so o que mudou e envia um quadro por vez, por DMA
+// em segundo plano.
+static const char *status_base;
+static const char *status_temp;
+static bool status_temp_expira;
+static absolute_time_t status_temp_fim;
+
+static void exibir_status(const char *texto) {
+    status_base = texto;
+}
+
+// duracao_ms == 0: mensagem permanece ate limpar_status_temporario()
+static void exibir_status_temporario(const char *texto, uint32_t duracao_ms) {
+    status_temp = texto;
+    status_temp_expira = duracao_ms > 0;
+    status_temp_fim = make_timeout_time_ms(duracao_ms);
+}
+
+static void limpar_status_temporario(void) {
+    status_temp = NULL;
+}
+
+static void display_tarefa(void) {
+    // O prazo das transacoes I2C e conferido no ritmo do display, o unico
+    // usuario do barramento
+    i2c_fila_tarefa();
+    if (status_temp && status_temp_expira && time_reached(status_temp_fim))
+        status_temp = NULL;
+    ui_definir(UI_STATUS, status_temp ? status_temp : status_base);
+    ui_tarefa();
+}
+
+void painel_init(void) {
+    status_base = "Aguardando";
+    status_temp = NULL;
+    ui_init();
+    ui_definir(UI_MODO, "Modo: cursor");
+    ui_definir(UI_JOYSTICK, "Joystick: parado");
+    ui_definir(UI_MICROFONE, "Microfone: silencio");
+    ui_definir(UI_USB, "USB: desconectado");
+}
+
+// =====================
+// Governador de ociosidade (nucleo 1) no nucleo 0
+// =====================
+// Contraste e painel do display e ritmo das tarefas deste nucleo conforme o
+// nivel
+static scheduler_t *scheduler_nucleo0;
+static int tarefa_eventos, tarefa_display;
+
+void painel_registrar(scheduler_t *s, scheduler_fn_t eventos_tarefa) {
+    scheduler_nucleo0 = s;
+    tarefa_eventos = scheduler_add_task(s, "eventos", eventos_tarefa, PERIODO_EVENTOS_US);
+    tarefa_display = scheduler_add_task(s, "display", display_tarefa, PERIODO_DISPLAY_US);
+}
+
+static void display_energia(energia_nivel_t nivel) {
+    bool ocioso = nivel == ENERGIA_OCIOSO;
+    ssd1306_set_contraste(nivel == ENERGIA_ATIVO ? DISPLAY_CONTRASTE : DISPLAY_CONTRASTE_ESCURO);
+    ssd1306_ligar(!ocioso);
+    scheduler_set_period(scheduler_nucleo0, tarefa_eventos,
+                         ocioso ? PERIODO_EVENTOS_OCIOSO_US : PERIODO_EVENTOS_US);
+    scheduler_set_period(scheduler_nucleo0, tarefa_display,
+                         ocioso ? PERIODO_DISPLAY_OCIOSO_US : PERIODO_DISPLAY_US);
+}
+
+void painel_evento(evento_t evento) {
+    switch (evento) {
+    case EVENTO_STATUS_EM_USO:
+        exibir_status("Em uso");
+        ui_definir(UI_JOYSTICK, "Joystick: em uso");
+        break;
+    case EVENTO_STATUS_AGUARDANDO:
+        exibir_status("Aguardando");
+        ui_definir(UI_JOYSTICK, "Joystick: parado");
+        break;
+    case EVENTO_TRANSCREVER:
+        exibir_status_temporario("Transcrevendo tela", PAINEL_TRANSCREVER_MS);
+        break;
+    case EVENTO_STATUS_OUVINDO:
+        exibir_status_temporario("Ouvindo", 0);
+        break;
+    case EVENTO_STATUS_PRONTO_OUVIR:
+        exibir_status_temporario("Pronto pra ouvir", 0);
+        break;
+    case EVENTO_STATUS_ROLAGEM:
+        exibir_status_temporario("Rolagem", 0);
+        ui_definir(UI_MODO, "Modo: rolagem");
+        break;
+    case EVENTO_LIMPAR_TEMPORARIO:
+        limpar_status_temporario();
+        break;
+    case EVENTO_MODO_CURSOR:
+        ui_definir(UI_MODO, "Modo: cursor");
+        break;
+    case EVENTO_MIC_VOZ:
+        ui_definir(UI_MICROFONE, "Microfone: voz");
+        break;
+    case EVENTO_MIC_SILENCIO:
+        ui_definir(UI_MICROFONE, "Microfone: silencio");
+        break;
+    case EVENTO_USB_CONECTADO:
+        ui_definir(UI_USB, "USB: conectado");
+        break;
+    case EVENTO_USB_DESCONECTADO:
+        ui_definir(UI_USB, "USB: desconectado");
+        break;
+    case EVENTO_USB_SUSPENSO:
+        ui_definir(UI_USB, "USB: suspenso");
+        break;
+    case EVENTO_ENERGIA_ATIVO:
+    case EVENTO_ENERGIA_ESCURO:
+    case EVENTO_ENERGIA_OCIOSO:
+        display_energia((energia_nivel_t)(evento - EVENTO_ENERGIA_ATIVO));
+        break;
+    }
+}
@@ -0,0 +1,30 @@
+// painel.h - Eventos de entrada no display, do lado do nucleo 0
+//
+// Aplica os eventos publicados pelo nucleo 1 (entrada.h) ao display: o
+// texto principal (base do joystick e mensagens temporarias dos botoes),
+// os campos de estado da camada de UI (ui.c), o contraste e o painel do
+// SSD1306 conforme o nivel do governador de ociosidade, e o ritmo das
+// tarefas deste nucleo. O firmware (HPR.c) e o build de host
+// (host/roteiro.c) usam o mesmo painel; LED e buzzer ficam com o HPR.c.
+
+#ifndef PAINEL_H
+#define PAINEL_H
+
+#include <stdint.h>
+#include "scheduler.h"
+#include "entrada.h"
+
+// "Transcrevendo tela" fica na tela pelo tempo do som do botao A
+#define PAINEL_TRANSCREVER_MS   5000
+
+// Depois de ssd1306_init(): camada de UI com os campos no estado de boot
+void painel_init(void);
+
+// Registra as tarefas do nucleo 0: "eventos", com a funcao do chamador
+// (que passa cada evento de entrada_ler_evento() a painel_evento() e trata
+// o que mais depender dele), e "display"
+void painel_registrar(scheduler_t *s, scheduler_fn_t eventos_tarefa);
+
+void painel_evento(evento_t evento);
+
+#endif // PAINEL_H
@@ -0,0 +1,181 @@
+// perfil.c - Sondas de tempo com histograma fixo
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "quente.h"
+#include "perfil.h"
+
+#define PERFIL_LINEARES         16
+#define PERFIL_SUB_BITS         2       // 4 baldes por oitava
+
+_Static_assert(PERFIL_LINEARES + (24 - 4) * (1 << PERFIL_SUB_BITS) == PERFIL_BALDES,
+               "baldes nao cobrem os 24 bits do SysTick");
+
+static perfil_sonda_t sondas[PERFIL_NUCLEOS][PERFIL_SONDAS_NUCLEO];
+static uint8_t n_sondas[PERFIL_NUCLEOS];
+
+void perfil_init_nucleo(void) {
+    // Recarga maxima, relogio do processador, sem interrupcao
+    systick_hw->rvr = PERFIL_CICLOS_MASCARA;
+    systick_hw->cvr = 0;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+}
+
+perfil_sonda_t *perfil_sonda(const char *nome) {
+    uint nucleo = get_core_num();
+    if (n_sondas[nucleo] >= PERFIL_SONDAS_NUCLEO)
+        return NULL;
+    perfil_sonda_t *s = &sondas[nucleo][n_sondas[nucleo]++];
+    memset(s, 0, sizeof(*s));
+    s->nome = nome;
+    s->min = UINT32_MAX;
+    return s;
+}
+
+static uint32_t QUENTE(perfil_balde)(uint32_t ciclos) {
+    if (ciclos < PERFIL_LINEARES)
+        return ciclos;
+    uint32_t oitava = 31 - __builtin_clz(ciclos);    // >= 4
+    uint32_t sub = (ciclos >> (oitava - PERFIL_SUB_BITS)) & ((1u << PERFIL_SUB_BITS) - 1);
+    uint32_t b = PERFIL_LINEARES + ((oitava - 4) << PERFIL_SUB_BITS) + sub;
+    return b < PERFIL_BALDES ? b : PERFIL_BALDES - 1;
+}
+
+// Maior duracao que cai no balde
+static uint32_t perfil_limite(uint32_t b) {
+    if (b < PERFIL_LINEARES)
+        return b;
+    b -= PERFIL_LINEARES;
+    uint32_t oitava = 4 + (b >> PERFIL_SUB_BITS);
+    uint32_t sub = b & ((1u << PERFIL_SUB_BITS) - 1);
+    return (1u << oitava) + ((sub + 1) << (oitava - PERFIL_SUB_BITS)) - 1;
+}
+
+void QUENTE(perfil_registrar)(perfil_sonda_t *s, uint32_t ciclos) {
+    if (!s)
+        return;
+    s->n++;
+    s->soma += ciclos;
+    if (ciclos < s->min)
+        s->min = ciclos;
+    if (ciclos > s->max)
+        s->max = ciclos;
+    s->baldes[perfil_balde(ciclos)]++;
+}
+
+void QUENTE(perfil_terminar)(perfil_sonda_t *s, const perfil_marca_t *m) {
+    uint32_t ciclos = perfil_ciclos();
+#if HPR_PERFIL_XIP
+    uint32_t acessos = xip_ctrl_hw->ctr_acc;
+    uint32_t acertos = xip_ctrl_hw->ctr_hit;
+#endif
+    if (!s)
+        return;
+    perfil_registrar(s, perfil_decorrido(m->ciclos, ciclos));
+#if HPR_PERFIL_XIP
+    // Zerados no meio da medida (pelo outro nucleo): a medida se perde
+    if (acessos < m->xip_acessos || acertos < m->xip_acertos)
+        return;
+    uint32_t a = acessos - m->xip_acessos;
+    uint32_t h = acertos - m->xip_acertos;
+    s->xip_acessos += a;
+    s->xip_falhas += a > h ? a - h : 0;     // as duas leituras nao sao atomicas
+    if (acessos >= PERFIL_XIP_ZERAR) {
+        xip_ctrl_hw->ctr_acc = 0;
+        xip_ctrl_hw->ctr_hit = 0;
+    }
+#endif
+}
+
+uint32_t perfil_percentil(const perfil_sonda_t *s, uint32_t permil) {
+    if (!s->n)
+        return 0;
+    // Posicao da amostra pedida, arredondada para cima (p99 de 10 = 10a)
+    uint64_t alvo = ((uint64_t)s->n * permil + 999) / 1000;
+    if (alvo == 0)
+        alvo = 1;
+    uint64_t acum = 0;
+    for (uint32_t b = 0; b < PERFIL_BALDES; b++) {
+        acum += s->baldes[b];
+        if (acum >= alvo) {
+            uint32_t v = perfil_limite(b);
+            return v > s->max ? s->max : v;
+        }
+    }
+    return s->max;
+}
+
+const perfil_sonda_t *perfil_sonda_n(uint8_t nucleo, uint8_t i) {
+    if (nucleo >= PERFIL_NUCLEOS || i >= n_sondas[nucleo])
+        return NULL;
+    return &sondas[nucleo][i];
+}
+
+void perfil_zerar(void) {
+    for (int c = 0; c < PERFIL_NUCLEOS; c++) {
+        for (int i = 0; i < n_sondas[c]; i++) {
+            perfil_sonda_t *s = &sondas[c][i];
+            const char *nome = s->nome;
+            memset(s, 0, sizeof(*s));
+            s->nome = nome;
+            s->min = UINT32_MAX;
+        }
+    }
+}
+
+uint32_t perfil_decimos_us(uint32_t ciclos) {
+    uint32_t mhz = clock_get_hz(clk_sys) / 1000000;
+    return mhz ? (uint32_t)((uint64_t)ciclos * 10 / mhz) : 0;
+}
+
+int perfil_formatar(const perfil_sonda_t *s, uint8_t nucleo, char *buf, int max) {
+    uint32_t min = s->n ? s->min : 0;
+    uint32_t media = s->n ? (uint32_t)(s->soma / s->n) : 0;
+    uint32_t v[5] = {
+        perfil_decimos_us(min),
+        perfil_decimos_us(perfil_percentil(s, 500)),
+        perfil_decimos_us(perfil_percentil(s, 990)),
+        perfil_decimos_us(s->max),
+        perfil_decimos_us(media),
+    };
+    int n = snprintf(buf, max, "%u %-12s n=%-8lu min=%lu.%lu p50=%lu.%lu p99=%lu.%lu max=%lu.%lu media=%lu.%lu us",
+                     nucleo, s->nome, (unsigned long)s->n,
+                     (unsigned long)v[0] / 10, (unsigned long)v[0] % 10,
+                     (unsigned long)v[1] / 10, (unsigned long)v[1] % 10,
+                     (unsigned long)v[2] / 10, (unsigned long)v[2] % 10,
+                     (unsigned long)v[3] / 10, (unsigned long)v[3] % 10,
+                     (unsigned long)v[4] / 10, (unsigned long)v[4] % 10);
+    if (n < 0 || n >= max)
+        return n;
+#if HPR_PERFIL_XIP
+    // Acessos por chamada e falhas em decimos de %
+    uint32_t por_chamada = s->n ? (uint32_t)(s->xip_acessos / s->n) : 0;
+    uint32_t falhas = s->xip_acessos ? (uint32_t)(s->xip_falhas * 1000 / s->xip_acessos) : 0;
+    n += snprintf(buf + n, max - n, " xip=%lu/chamada falhas=%lu.%lu%%",
+                  (unsigned long)por_chamada, (unsigned long)falhas / 10, (unsigned long)falhas % 10);
+    if (n >= max)
+        return n;
+#endif
+    n += snprintf(buf + n, max - n, "\n");
+    return n;
+}
+
+static void perfil_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+void perfil_serializar(const perfil_sonda_t *s, uint8_t nucleo, uint8_t buf[PERFIL_REGISTRO_BIN]) {
+    memset(buf, 0, PERFIL_REGISTRO_BIN);
+    buf[0] = nucleo;
+    strncpy((char *)&buf[1], s->nome, 11);
+    perfil_u32(&buf[12], s->n);
+    perfil_u32(&buf[16], s->n ? s->min : 0);
+    perfil_u32(&buf[20], perfil_percentil(s, 500));
+    perfil_u32(&buf[24], perfil_percentil(s, 990));
+    perfil_u32(&buf[28], s->max);
+}
@@ -0,0 +1,108 @@
+// perfil.h - Sondas de tempo com histograma fixo, para medir o firmware em uso
+//
+// Cada sonda acumula duracoes em ciclos do processador (SysTick do nucleo,
+// 24 bits: medidas de ate ~134 ms a 125 MHz) num histograma de tamanho fixo:
+// 16 baldes lineares de 1 ciclo e, acima disso, 4 baldes por oitava. Os
+// percentis saem do histograma com erro de ate 25% do valor (o limite
+// superior do balde); minimo, maximo e media sao exatos.
+//
+// Cada nucleo tem o proprio conjunto de sondas e so ele registra nelas; a
+// leitura do outro nucleo pode ver uma amostra pela metade, o que e
+// aceitavel para estatistica.
+//
+// Com HPR_PERFIL_XIP (opcao do CMake), perfil_iniciar()/perfil_terminar()
+// tambem leem os contadores de acessos e acertos do cache XIP, e a sonda
+// acumula os acessos a flash e as falhas no cache durante a medida. Os
+// contadores sao do cache, nao do nucleo: o que o outro nucleo e o DMA
+// leem da flash no mesmo intervalo entra na conta. Os contadores saturam
+// em 32 bits; passada a metade, perfil_terminar() os zera, e a medida do
+// outro nucleo que pegar a zeragem no meio e descartada.
+
+#ifndef PERFIL_H
+#define PERFIL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/structs/systick.h"
+#if HPR_PERFIL_XIP
+#include "hardware/structs/xip_ctrl.h"
+#endif
+
+#define PERFIL_NUCLEOS          2
+#define PERFIL_SONDAS_NUCLEO    10
+#define PERFIL_BALDES           96      // 16 lineares + 20 oitavas x 4
+#define PERFIL_CICLOS_MASCARA   0xFFFFFFu
+#define PERFIL_XIP_ZERAR        0x80000000u
+
+typedef struct {
+    const char *nome;
+    uint32_t n;
+    uint32_t min;
+    uint32_t max;
+    uint64_t soma;
+    uint32_t baldes[PERFIL_BALDES];
+    uint64_t xip_acessos;       // leituras da flash pelo cache (HPR_PERFIL_XIP)
+    uint64_t xip_falhas;        // das quais falharam no cache
+} perfil_sonda_t;
+
+// Liga o SysTick do nucleo que chama; chamar uma vez em cada nucleo
+void perfil_init_nucleo(void);
+
+// Cria uma sonda no nucleo que chama; NULL se as sondas dele acabaram
+perfil_sonda_t *perfil_sonda(const char *nome);
+
+// Contador de ciclos do nucleo (decrescente, 24 bits)
+static inline uint32_t perfil_ciclos(void) {
+    return systick_hw->cvr;
+}
+
+// Ciclos entre duas leituras de perfil_ciclos()
+static inline uint32_t perfil_decorrido(uint32_t inicio, uint32_t fim) {
+    return (inicio - fim) & PERFIL_CICLOS_MASCARA;
+}
+
+// Registra uma duracao; sonda NULL e ignorada
+void perfil_registrar(perfil_sonda_t *s, uint32_t ciclos);
+
+// Inicio de uma medida com perfil_iniciar(), registrada por perfil_terminar()
+typedef struct {
+    uint32_t ciclos;
+#if HPR_PERFIL_XIP
+    uint32_t xip_acessos;
+    uint32_t xip_acertos;
+#endif
+} perfil_marca_t;
+
+static inline void perfil_iniciar(perfil_marca_t *m) {
+#if HPR_PERFIL_XIP
+    m->xip_acertos = xip_ctrl_hw->ctr_hit;
+    m->xip_acessos = xip_ctrl_hw->ctr_acc;
+#endif
+    m->ciclos = perfil_ciclos();
+}
+
+// Registra a duracao (e o cache XIP) desde perfil_iniciar(); sonda NULL e
+// ignorada
+void perfil_terminar(perfil_sonda_t *s, const perfil_marca_t *m);
+
+// Duracao abaixo da qual ficam permil/1000 das amostras (500 = p50)
+uint32_t perfil_percentil(const perfil_sonda_t *s, uint32_t permil);
+
+// Sonda i do nucleo (NULL se nao existir) e zeragem de todas
+const perfil_sonda_t *perfil_sonda_n(uint8_t nucleo, uint8_t i);
+void perfil_zerar(void);
+
+// Ciclos -> decimos de microssegundo, com o clk_sys atual
+uint32_t perfil_decimos_us(uint32_t ciclos);
+
+// Uma linha de texto com a sonda (n, min, p50, p99, max e media em us e,
+// com HPR_PERFIL_XIP, acessos a flash por chamada e a taxa de falhas do
+// cache); retorna o tamanho escrito
+int perfil_formatar(const perfil_sonda_t *s, uint8_t nucleo, char *buf, int max);
+
+// Registro binario de uma sonda, em ciclos e little-endian:
+//   nucleo u8, nome char[11] (com zeros), n, min, p50, p99, max (u32 cada)
+#define PERFIL_REGISTRO_BIN     32
+void perfil_serializar(const perfil_sonda_t *s, uint8_t nucleo, uint8_t buf[PERFIL_REGISTRO_BIN]);
+
+#endif // PERFIL_H
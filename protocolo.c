@@ -0,0 +1,77 @@
+// protocolo.c - Quadros binarios na stdio (UART e porta serial USB)
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "protocolo.h"
+
+enum {
+    PROTOCOLO_LIVRE,
+    PROTOCOLO_TIPO,
+    PROTOCOLO_TAMANHO,
+    PROTOCOLO_DADOS,
+    PROTOCOLO_SOMA,
+};
+
+void protocolo_init(protocolo_t *p) {
+    p->estado = PROTOCOLO_LIVRE;
+    p->erros = 0;
+}
+
+protocolo_resultado_t protocolo_receber(protocolo_t *p, uint8_t c, uint32_t agora_us) {
+    if (p->estado != PROTOCOLO_LIVRE && agora_us - p->ultimo_us > PROTOCOLO_TIMEOUT_US) {
+        p->estado = PROTOCOLO_LIVRE;
+        p->erros++;
+    }
+    p->ultimo_us = agora_us;
+
+    switch (p->estado) {
+    case PROTOCOLO_LIVRE:
+        if (c != PROTOCOLO_MARCA) {
+            p->tipo = c;
+            return PROTOCOLO_CARACTERE;
+        }
+        p->estado = PROTOCOLO_TIPO;
+        break;
+    case PROTOCOLO_TIPO:
+        p->tipo = c;
+        p->estado = PROTOCOLO_TAMANHO;
+        break;
+    case PROTOCOLO_TAMANHO:
+        if (c > PROTOCOLO_DADOS_MAX) {
+            p->estado = PROTOCOLO_LIVRE;
+            p->erros++;
+            break;
+        }
+        p->n = c;
+        p->i = 0;
+        p->soma = 0;
+        p->estado = c ? PROTOCOLO_DADOS : PROTOCOLO_SOMA;
+        break;
+    case PROTOCOLO_DADOS:
+        p->dados[p->i++] = c;
+        p->soma += c;
+        if (p->i == p->n)
+            p->estado = PROTOCOLO_SOMA;
+        break;
+    case PROTOCOLO_SOMA:
+        p->estado = PROTOCOLO_LIVRE;
+        if (c != p->soma) {
+            p->erros++;
+            break;
+        }
+        return PROTOCOLO_QUADRO;
+    }
+    return PROTOCOLO_NADA;
+}
+
+void protocolo_enviar(uint8_t tipo, const uint8_t *dados, uint8_t n) {
+    uint8_t soma = 0;
+    putchar_raw(PROTOCOLO_MARCA);
+    putchar_raw(tipo);
+    putchar_raw(n);
+    for (uint8_t i = 0; i < n; i++) {
+        putchar_raw(dados[i]);
+        soma += dados[i];
+    }
+    putchar_raw(soma);
+}
@@ -0,0 +1,45 @@
+// protocolo.h - Quadros binarios na stdio (UART e porta serial USB)
+//
+// Quadro: PROTOCOLO_MARCA, tipo, tamanho, dados, soma dos dados (8 bits).
+// O mesmo formato serve aos registros do relatorio de perfil (saida) e aos
+// comandos recebidos (config.h). Fora de um quadro, cada byte recebido e
+// um comando de um caractere ('p', 'b', 'z'...), entao os dois convivem no
+// mesmo canal. Um quadro que para no meio e abandonado depois de
+// PROTOCOLO_TIMEOUT_US sem bytes; soma errada descarta o quadro.
+
+#ifndef PROTOCOLO_H
+#define PROTOCOLO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PROTOCOLO_MARCA         0xA5
+#define PROTOCOLO_DADOS_MAX     64      // maior quadro recebido
+#define PROTOCOLO_TIMEOUT_US    100000
+
+typedef enum {
+    PROTOCOLO_NADA,                     // byte consumido, nada pronto
+    PROTOCOLO_CARACTERE,                // comando de um caractere em 'tipo'
+    PROTOCOLO_QUADRO,                   // quadro completo em tipo/dados/n
+} protocolo_resultado_t;
+
+typedef struct {
+    uint8_t estado;
+    uint8_t tipo;
+    uint8_t n;
+    uint8_t i;
+    uint8_t soma;
+    uint32_t ultimo_us;
+    uint32_t erros;                     // quadros descartados
+    uint8_t dados[PROTOCOLO_DADOS_MAX];
+} protocolo_t;
+
+void protocolo_init(protocolo_t *p);
+
+// Alimenta um byte recebido no instante agora_us
+protocolo_resultado_t protocolo_receber(protocolo_t *p, uint8_t c, uint32_t agora_us);
+
+// Escreve um quadro na stdio, sem traducao de fim de linha
+void protocolo_enviar(uint8_t tipo, const uint8_t *dados, uint8_t n);
+
+#endif // PROTOCOLO_H
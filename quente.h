@@ -0,0 +1,28 @@
+// quente.h - Caminho quente na SRAM, fora do cache XIP (build HPR_RAM_QUENTE)
+//
+// O RP2040 executa da flash QSPI pelo cache XIP de 16 KB; uma falha no
+// cache custa dezenas de ciclos, e o TinyUSB e a stdio expulsam dele as
+// funcoes que rodam a cada 1 ms. Com a opcao HPR_RAM_QUENTE do CMake, as
+// funcoes marcadas com QUENTE() e as tabelas marcadas com QUENTE_DADOS()
+// vao para as secoes .time_critical do SDK, copiadas para a SRAM no boot;
+// sem ela as marcas nao fazem nada.
+//
+// Marcados: joystick -> relatorio HID (nucleo 1), desenho e envio do
+// display com a fonte (nucleo 0), o escalonador e as sondas de perfil.h.
+// O TinyUSB continua na flash. HPR_PERFIL_XIP (perfil.h) mede o efeito:
+// acessos e falhas do cache XIP em cada sonda, nas duas variantes.
+
+#ifndef QUENTE_H
+#define QUENTE_H
+
+#include "pico/platform.h"
+
+#if HPR_RAM_QUENTE
+#define QUENTE(nome)        __not_in_flash_func(nome)
+#define QUENTE_DADOS(grupo) __not_in_flash(grupo)
+#else
+#define QUENTE(nome)        nome
+#define QUENTE_DADOS(grupo)
+#endif
+
+#endif // QUENTE_H
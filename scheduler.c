@@ -0,0 +1,103 @@
+// scheduler.c - Escalonador cooperativo por prazos (deadlines) para o HPR
+
+#include "scheduler.h"
+#include "hardware/timer.h"
+#include "hardware/sync.h"
+#include "quente.h"
+
+void scheduler_init(scheduler_t *s) {
+    s->n_tarefas = 0;
+    s->acordar = 0;
+}
+
+int scheduler_add_task(scheduler_t *s, const char *nome, scheduler_fn_t fn, uint32_t periodo_us) {
+    if (s->n_tarefas >= SCHEDULER_MAX_TAREFAS)
+        return -1;
+    scheduler_tarefa_t *t = &s->tarefas[s->n_tarefas];
+    t->nome = nome;
+    t->fn = fn;
+    t->periodo_us = periodo_us;
+    t->prazo = get_absolute_time();
+    t->execucoes = 0;
+    t->max_exec_us = 0;
+    t->max_atraso_us = 0;
+    t->sonda = perfil_sonda(nome);
+    return s->n_tarefas++;
+}
+
+void scheduler_set_period(scheduler_t *s, int id, uint32_t periodo_us) {
+    if (id < 0 || id >= s->n_tarefas)
+        return;
+    s->tarefas[id].periodo_us = periodo_us;
+}
+
+void scheduler_acordar(scheduler_t *s, int id) {
+    if (id < 0 || id >= SCHEDULER_MAX_TAREFAS)
+        return;
+    uint32_t estado = save_and_disable_interrupts();
+    s->acordar |= 1u << id;
+    restore_interrupts(estado);
+    __sev();  // sai do WFE mesmo que a chamada nao venha de uma IRQ
+}
+
+void QUENTE(scheduler_run_once)(scheduler_t *s) {
+    if (s->n_tarefas == 0)
+        return;
+
+    // Pedidos de scheduler_acordar(): o prazo vira agora. O prazo so e
+    // escrito aqui, fora da IRQ, porque absolute_time_t tem 64 bits.
+    if (s->acordar) {
+        uint32_t estado = save_and_disable_interrupts();
+        uint32_t pedidos = s->acordar;
+        s->acordar = 0;
+        restore_interrupts(estado);
+        absolute_time_t agora = get_absolute_time();
+        for (uint8_t i = 0; i < s->n_tarefas; i++) {
+            if ((pedidos & (1u << i)) && absolute_time_diff_us(agora, s->tarefas[i].prazo) > 0)
+                s->tarefas[i].prazo = agora;
+        }
+    }
+
+    // Tarefa com o prazo mais antigo; empate favorece o menor indice
+    scheduler_tarefa_t *proxima = &s->tarefas[0];
+    for (uint8_t i = 1; i < s->n_tarefas; i++) {
+        if (absolute_time_diff_us(s->tarefas[i].prazo, proxima->prazo) > 0)
+            proxima = &s->tarefas[i];
+    }
+
+    absolute_time_t agora = get_absolute_time();
+    int64_t falta = absolute_time_diff_us(agora, proxima->prazo);
+    if (falta > 0) {
+        // Dorme ate o prazo usando um alarme do alarm pool padrao; qualquer
+        // interrupcao (USB, GPIO...) tambem acorda o nucleo antes disso.
+        best_effort_wfe_or_timeout(proxima->prazo);
+        return;
+    }
+
+    uint32_t atraso = (uint32_t)(-falta);
+    if (atraso > proxima->max_atraso_us)
+        proxima->max_atraso_us = atraso;
+
+    uint32_t inicio = time_us_32();
+    perfil_marca_t marca;
+    perfil_iniciar(&marca);
+    proxima->fn();
+    perfil_terminar(proxima->sonda, &marca);
+    uint32_t duracao = time_us_32() - inicio;
+    if (duracao > proxima->max_exec_us)
+        proxima->max_exec_us = duracao;
+    proxima->execucoes++;
+
+    // Proximo prazo relativo ao anterior para manter a cadencia; se a tarefa
+    // ficou mais de um periodo atrasada, reancora no instante atual em vez
+    // de executar uma rajada de passos acumulados.
+    proxima->prazo = delayed_by_us(proxima->prazo, proxima->periodo_us);
+    if (absolute_time_diff_us(get_absolute_time(), proxima->prazo) < 0)
+        proxima->prazo = delayed_by_us(agora, proxima->periodo_us);
+}
+
+void scheduler_run(scheduler_t *s) {
+    while (true) {
+        scheduler_run_once(s);
+    }
+}
@@ -0,0 +1,64 @@
+// scheduler.h - Escalonador cooperativo por prazos (deadlines) para o HPR
+//
+// Cada subsistema (USB, joystick, botoes, display, buzzer) e registrado como
+// uma tarefa com periodo proprio. As tarefas sao maquinas de estado que nunca
+// bloqueiam: executam um passo curto e retornam. Entre prazos o nucleo dorme
+// em WFE ate o proximo vencimento, acordado pelo alarm pool do pico_time.
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/time.h"
+#include "perfil.h"
+
+#define SCHEDULER_MAX_TAREFAS 8
+
+typedef void (*scheduler_fn_t)(void);
+
+typedef struct {
+    const char *nome;
+    scheduler_fn_t fn;
+    uint32_t periodo_us;
+    absolute_time_t prazo;      // proximo vencimento
+
+    // Estatisticas de execucao
+    uint32_t execucoes;
+    uint32_t max_exec_us;       // maior duracao de um passo da tarefa
+    uint32_t max_atraso_us;     // maior atraso entre o prazo e o inicio
+    perfil_sonda_t *sonda;      // histograma da duracao dos passos (perfil.h)
+} scheduler_tarefa_t;
+
+typedef struct {
+    scheduler_tarefa_t tarefas[SCHEDULER_MAX_TAREFAS];
+    uint8_t n_tarefas;
+    volatile uint32_t acordar;  // bit i: tarefa i pedida por scheduler_acordar()
+} scheduler_t;
+
+_Static_assert(SCHEDULER_MAX_TAREFAS <= 32, "mascara de scheduler_acordar() tem 32 bits");
+
+void scheduler_init(scheduler_t *s);
+
+// Registra uma tarefa. Em caso de prazos empatados, a tarefa registrada
+// primeiro tem prioridade. Retorna o indice da tarefa ou -1 se nao houver espaco.
+// Cria uma sonda de perfil com o nome da tarefa no nucleo que chama, que
+// deve ser o mesmo que vai rodar o escalonador.
+int scheduler_add_task(scheduler_t *s, const char *nome, scheduler_fn_t fn, uint32_t periodo_us);
+
+// Altera o periodo de uma tarefa; o novo periodo vale a partir do proximo prazo.
+void scheduler_set_period(scheduler_t *s, int id, uint32_t periodo_us);
+
+// Antecipa o proximo prazo de uma tarefa para agora; dali em diante a
+// cadencia segue a partir desse passo. Pode ser chamada de uma IRQ do
+// nucleo que roda o escalonador, que e acordado se estiver dormindo.
+void scheduler_acordar(scheduler_t *s, int id);
+
+// Executa a tarefa vencida com o prazo mais antigo ou, se nenhuma venceu,
+// dorme ate o proximo prazo (ou ate algum evento/interrupcao).
+void scheduler_run_once(scheduler_t *s);
+
+// Laco principal do escalonador; nunca retorna.
+void scheduler_run(scheduler_t *s);
+
+#endif // SCHEDULER_H
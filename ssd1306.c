@@ -0,0 +1,592 @@
+// ssd1306.c - Driver do display OLED SSD1306 via I2C com envio por DMA
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "perfil.h"
+#include "i2c_fila.h"
+#include "quente.h"
+#include "ssd1306.h"
+
+// Envio por regiao suja: desenhar marca o retangulo (paginas x colunas)
+// alterado desde o ultimo envio. No envio, esse retangulo e reduzido ao que
+// realmente difere do quadro anterior e so ele e transmitido: a janela 0x21/
+// 0x22 e ajustada para o retangulo e o DMA percorre as linhas de pagina por
+// uma transacao de blocos na fila do I2C (i2c_fila.h). Sem diferencas, nada
+// vai para o I2C.
+//
+// Comandos avulsos tambem passam pela fila, como stream de comandos (0x00);
+// os que chegam antes do anterior sair vao na mesma transacao.
+#define SSD1306_CABECALHO_LEN 8
+#define SSD1306_MAX_BLOCOS    (1 + SSD1306_PAGES)
+
+_Static_assert(SSD1306_MAX_BLOCOS <= I2C_FILA_BLOCOS, "quadro nao cabe numa transacao da fila");
+
+static uint16_t ssd1306_quadros[2][SSD1306_BUFFER_SIZE];
+static uint8_t ssd1306_tras = 0;            // indice do quadro de desenho
+uint16_t *ssd1306_buffer = ssd1306_quadros[0];
+
+// Cabecalho do envio em curso: janela de enderecamento como stream de
+// comandos terminado em STOP, seguida do controle 0x40 que abre os dados
+static uint16_t ssd1306_cabecalho[SSD1306_CABECALHO_LEN];
+static i2c_fila_bloco_t ssd1306_blocos[SSD1306_MAX_BLOCOS];
+
+// Retangulo sujo do buffer de tras; vazio quando col_min > col_max
+static uint8_t sujo_col_min = SSD1306_WIDTH, sujo_col_max = 0;
+static uint8_t sujo_pag_min = SSD1306_PAGES, sujo_pag_max = 0;
+
+static ssd1306_stats_t ssd1306_stats;
+static int ssd1306_stop_pos = -1;           // palavra com STOP no quadro da frente
+
+static uint8_t ssd1306_addr;
+static volatile bool ssd1306_quadro_pendente = false;  // na fila do I2C
+static volatile bool ssd1306_invalido = false;  // quadro perdido: RAM do display desconhecida
+static void (*ssd1306_callback)(void) = NULL;
+
+// Sondas de perfil: CPU gasta em ssd1306_update() e duracao de cada quadro
+// na fila e no barramento (do envio ate o fim da transacao)
+static perfil_sonda_t *ssd1306_sonda_update;
+static perfil_sonda_t *ssd1306_sonda_i2c;
+static uint32_t ssd1306_envio_ciclos;
+
+// Fonte 5x7 em colunas: um byte por coluna, bit 0 = linha de cima. A linha 7
+// so e usada pela cedilha. Os glifos ficam em flash (const), ou na SRAM com
+// HPR_RAM_QUENTE (quente.h); os indices 0-94 sao o ASCII de ' ' a '~' e os
+// seguintes, os caracteres Latin-1 listados em fonte_latin1 (acentos do
+// portugues e alguns simbolos).
+#define FONTE_LARGURA       5
+#define FONTE_ALTURA        8
+#define FONTE_ESPACO        1
+#define FONTE_ASCII_FIM     0x7E
+#define FONTE_SEM_GLIFO     ('?' - ' ')
+
+static const uint8_t QUENTE_DADOS("fonte_glifos") fonte_glifos[][FONTE_LARGURA] = {
+    {0x00,0x00,0x00,0x00,0x00}, // ' ' (32)
+    {0x00,0x00,0x5F,0x00,0x00}, // '!' (33)
+    {0x00,0x07,0x00,0x07,0x00}, // '"' (34)
+    {0x14,0x7F,0x14,0x7F,0x14}, // '#' (35)
+    {0x24,0x2A,0x7F,0x2A,0x12}, // '$' (36)
+    {0x23,0x13,0x08,0x64,0x62}, // '%' (37)
+    {0x36,0x49,0x55,0x22,0x50}, // '&' (38)
+    {0x00,0x05,0x03,0x00,0x00}, // '\'' (39)
+    {0x00,0x1C,0x22,0x41,0x00}, // '(' (40)
+    {0x00,0x41,0x22,0x1C,0x00}, // ')' (41)
+    {0x14,0x08,0x3E,0x08,0x14}, // '*' (42)
+    {0x08,0x08,0x3E,0x08,0x08}, // '+' (43)
+    {0x00,0x50,0x30,0x00,0x00}, // ',' (44)
+    {0x08,0x08,0x08,0x08,0x08}, // '-' (45)
+    {0x00,0x60,0x60,0x00,0x00}, // '.' (46)
+    {0x20,0x10,0x08,0x04,0x02}, // '/' (47)
+    {0x3E,0x51,0x49,0x45,0x3E}, // '0' (48)
+    {0x00,0x42,0x7F,0x40,0x00}, // '1' (49)
+    {0x42,0x61,0x51,0x49,0x46}, // '2' (50)
+    {0x21,0x41,0x45,0x4B,0x31}, // '3' (51)
+    {0x18,0x14,0x12,0x7F,0x10}, // '4' (52)
+    {0x27,0x45,0x45,0x45,0x39}, // '5' (53)
+    {0x3C,0x4A,0x49,0x49,0x30}, // '6' (54)
+    {0x01,0x71,0x09,0x05,0x03}, // '7' (55)
+    {0x36,0x49,0x49,0x49,0x36}, // '8' (56)
+    {0x06,0x49,0x49,0x29,0x1E}, // '9' (57)
+    {0x00,0x36,0x36,0x00,0x00}, // ':' (58)
+    {0x00,0x56,0x36,0x00,0x00}, // ';' (59)
+    {0x08,0x14,0x22,0x41,0x00}, // '<' (60)
+    {0x14,0x14,0x14,0x14,0x14}, // '=' (61)
+    {0x00,0x41,0x22,0x14,0x08}, // '>' (62)
+    {0x02,0x01,0x51,0x09,0x06}, // '?' (63)
+    {0x32,0x49,0x79,0x41,0x3E}, // '@' (64)
+    {0x7E,0x11,0x11,0x11,0x7E}, // 'A' (65)
+    {0x7F,0x49,0x49,0x49,0x36}, // 'B' (66)
+    {0x3E,0x41,0x41,0x41,0x22}, // 'C' (67)
+    {0x7F,0x41,0x41,0x22,0x1C}, // 'D' (68)
+    {0x7F,0x49,0x49,0x49,0x41}, // 'E' (69)
+    {0x7F,0x09,0x09,0x01,0x01}, // 'F' (70)
+    {0x3E,0x41,0x41,0x51,0x32}, // 'G' (71)
+    {0x7F,0x08,0x08,0x08,0x7F}, // 'H' (72)
+    {0x00,0x41,0x7F,0x41,0x00}, // 'I' (73)
+    {0x20,0x40,0x41,0x3F,0x01}, // 'J' (74)
+    {0x7F,0x08,0x14,0x22,0x41}, // 'K' (75)
+    {0x7F,0x40,0x40,0x40,0x40}, // 'L' (76)
+    {0x7F,0x02,0x04,0x02,0x7F}, // 'M' (77)
+    {0x7F,0x04,0x08,0x10,0x7F}, // 'N' (78)
+    {0x3E,0x41,0x41,0x41,0x3E}, // 'O' (79)
+    {0x7F,0x09,0x09,0x09,0x06}, // 'P' (80)
+    {0x3E,0x41,0x51,0x21,0x5E}, // 'Q' (81)
+    {0x7F,0x09,0x19,0x29,0x46}, // 'R' (82)
+    {0x46,0x49,0x49,0x49,0x31}, // 'S' (83)
+    {0x01,0x01,0x7F,0x01,0x01}, // 'T' (84)
+    {0x3F,0x40,0x40,0x40,0x3F}, // 'U' (85)
+    {0x1F,0x20,0x40,0x20,0x1F}, // 'V' (86)
+    {0x7F,0x20,0x18,0x20,0x7F}, // 'W' (87)
+    {0x63,0x14,0x08,0x14,0x63}, // 'X' (88)
+    {0x03,0x04,0x78,0x04,0x03}, // 'Y' (89)
+    {0x61,0x51,0x49,0x45,0x43}, // 'Z' (90)
+    {0x00,0x7F,0x41,0x41,0x00}, // '[' (91)
+    {0x02,0x04,0x08,0x10,0x20}, // '\\' (92)
+    {0x00,0x41,0x41,0x7F,0x00}, // ']' (93)
+    {0x04,0x02,0x01,0x02,0x04}, // '^' (94)
+    {0x40,0x40,0x40,0x40,0x40}, // '_' (95)
+    {0x00,0x01,0x02,0x04,0x00}, // '`' (96)
+    {0x20,0x54,0x54,0x54,0x78}, // 'a' (97)
+    {0x7F,0x48,0x44,0x44,0x38}, // 'b' (98)
+    {0x38,0x44,0x44,0x44,0x20}, // 'c' (99)
+    {0x38,0x44,0x44,0x48,0x7F}, // 'd' (100)
+    {0x38,0x54,0x54,0x54,0x18}, // 'e' (101)
+    {0x08,0x7E,0x09,0x01,0x02}, // 'f' (102)
+    {0x0C,0x52,0x52,0x52,0x3E}, // 'g' (103)
+    {0x7F,0x08,0x04,0x04,0x78}, // 'h' (104)
+    {0x00,0x44,0x7D,0x40,0x00}, // 'i' (105)
+    {0x20,0x40,0x44,0x3D,0x00}, // 'j' (106)
+    {0x00,0x7F,0x10,0x28,0x44}, // 'k' (107)
+    {0x00,0x41,0x7F,0x40,0x00}, // 'l' (108)
+    {0x7C,0x04,0x18,0x04,0x78}, // 'm' (109)
+    {0x7C,0x08,0x04,0x04,0x78}, // 'n' (110)
+    {0x38,0x44,0x44,0x44,0x38}, // 'o' (111)
+    {0x7C,0x14,0x14,0x14,0x08}, // 'p' (112)
+    {0x08,0x14,0x14,0x18,0x7C}, // 'q' (113)
+    {0x7C,0x08,0x04,0x04,0x08}, // 'r' (114)
+    {0x48,0x54,0x54,0x54,0x20}, // 's' (115)
+    {0x04,0x3F,0x44,0x40,0x20}, // 't' (116)
+    {0x3C,0x40,0x40,0x20,0x7C}, // 'u' (117)
+    {0x1C,0x20,0x40,0x20,0x1C}, // 'v' (118)
+    {0x3C,0x40,0x30,0x40,0x3C}, // 'w' (119)
+    {0x44,0x28,0x10,0x28,0x44}, // 'x' (120)
+    {0x0C,0x50,0x50,0x50,0x3C}, // 'y' (121)
+    {0x44,0x64,0x54,0x4C,0x44}, // 'z' (122)
+    {0x00,0x08,0x36,0x41,0x00}, // '{' (123)
+    {0x00,0x00,0x7F,0x00,0x00}, // '|' (124)
+    {0x00,0x41,0x36,0x08,0x00}, // '}' (125)
+    {0x08,0x04,0x08,0x10,0x08}, // '~' (126)
+    {0x00,0x00,0x00,0x00,0x00}, // U+00A0 no-break space
+    {0x00,0x00,0x7D,0x00,0x00}, // U+00A1 inverted exclamation mark
+    {0x18,0x24,0x66,0x24,0x00}, // U+00A2 cent sign
+    {0x48,0x7E,0x49,0x41,0x42}, // U+00A3 pound sign
+    {0x00,0x4A,0x55,0x29,0x00}, // U+00A7 section sign
+    {0x3E,0x5D,0x55,0x41,0x3E}, // U+00A9 copyright sign
+    {0x00,0x26,0x29,0x2F,0x00}, // U+00AA feminine ordinal indicator
+    {0x08,0x14,0x2A,0x14,0x22}, // U+00AB left-pointing double angle quotation mark
+    {0x00,0x06,0x09,0x06,0x00}, // U+00B0 degree sign
+    {0x44,0x44,0x5F,0x44,0x44}, // U+00B1 plus-minus sign
+    {0x00,0x19,0x15,0x12,0x00}, // U+00B2 superscript two
+    {0x00,0x11,0x15,0x0A,0x00}, // U+00B3 superscript three
+    {0x7C,0x20,0x40,0x20,0x7C}, // U+00B5 micro sign
+    {0x00,0x00,0x08,0x00,0x00}, // U+00B7 middle dot
+    {0x00,0x26,0x29,0x26,0x00}, // U+00BA masculine ordinal indicator
+    {0x22,0x14,0x2A,0x14,0x08}, // U+00BB right-pointing double angle quotation mark
+    {0x30,0x48,0x45,0x40,0x20}, // U+00BF inverted question mark
+    {0x78,0x15,0x16,0x14,0x78}, // U+00C0 latin capital letter a with grave
+    {0x78,0x14,0x16,0x15,0x78}, // U+00C1 latin capital letter a with acute
+    {0x78,0x16,0x15,0x16,0x78}, // U+00C2 latin capital letter a with circumflex
+    {0x7A,0x15,0x15,0x16,0x79}, // U+00C3 latin capital letter a with tilde
+    {0x78,0x15,0x14,0x15,0x78}, // U+00C4 latin capital letter a with diaeresis
+    {0x78,0x15,0x16,0x15,0x78}, // U+00C5 latin capital letter a with ring above
+    {0x78,0x14,0x7C,0x54,0x44}, // U+00C6 latin capital letter ae
+    {0x3E,0x41,0xC1,0xC1,0x22}, // U+00C7 latin capital letter c with cedilla
+    {0x7C,0x55,0x56,0x54,0x44}, // U+00C8 latin capital letter e with grave
+    {0x7C,0x54,0x56,0x55,0x44}, // U+00C9 latin capital letter e with acute
+    {0x7C,0x56,0x55,0x56,0x44}, // U+00CA latin capital letter e with circumflex
+    {0x7C,0x55,0x54,0x55,0x44}, // U+00CB latin capital letter e with diaeresis
+    {0x00,0x45,0x7E,0x44,0x00}, // U+00CC latin capital letter i with grave
+    {0x00,0x44,0x7E,0x45,0x00}, // U+00CD latin capital letter i with acute
+    {0x00,0x46,0x7D,0x46,0x00}, // U+00CE latin capital letter i with circumflex
+    {0x00,0x45,0x7C,0x45,0x00}, // U+00CF latin capital letter i with diaeresis
+    {0x7F,0x49,0x49,0x22,0x1C}, // U+00D0 latin capital letter eth
+    {0x7C,0x0A,0x11,0x22,0x7D}, // U+00D1 latin capital letter n with tilde
+    {0x38,0x45,0x46,0x44,0x38}, // U+00D2 latin capital letter o with grave
+    {0x38,0x44,0x46,0x45,0x38}, // U+00D3 latin capital letter o with acute
+    {0x38,0x46,0x45,0x46,0x38}, // U+00D4 latin capital letter o with circumflex
+    {0x3A,0x45,0x45,0x46,0x39}, // U+00D5 latin capital letter o with tilde
+    {0x38,0x45,0x44,0x45,0x38}, // U+00D6 latin capital letter o with diaeresis
+    {0x22,0x14,0x08,0x14,0x22}, // U+00D7 multiplication sign
+    {0x5E,0x31,0x49,0x46,0x3D}, // U+00D8 latin capital letter o with stroke
+    {0x3C,0x41,0x42,0x40,0x3C}, // U+00D9 latin capital letter u with grave
+    {0x3C,0x40,0x42,0x41,0x3C}, // U+00DA latin capital letter u with acute
+    {0x3C,0x42,0x41,0x42,0x3C}, // U+00DB latin capital letter u with circumflex
+    {0x3C,0x41,0x40,0x41,0x3C}, // U+00DC latin capital letter u with diaeresis
+    {0x04,0x08,0x72,0x09,0x04}, // U+00DD latin capital letter y with acute
+    {0x3F,0x0A,0x0A,0x0A,0x04}, // U+00DE latin capital letter thorn
+    {0x7E,0x01,0x49,0x56,0x20}, // U+00DF latin small letter sharp s
+    {0x20,0x55,0x56,0x54,0x78}, // U+00E0 latin small letter a with grave
+    {0x20,0x54,0x56,0x55,0x78}, // U+00E1 latin small letter a with acute
+    {0x20,0x56,0x55,0x56,0x78}, // U+00E2 latin small letter a with circumflex
+    {0x22,0x55,0x55,0x56,0x79}, // U+00E3 latin small letter a with tilde
+    {0x20,0x55,0x54,0x55,0x78}, // U+00E4 latin small letter a with diaeresis
+    {0x20,0x55,0x56,0x55,0x78}, // U+00E5 latin small letter a with ring above
+    {0x20,0x54,0x78,0x54,0x58}, // U+00E6 latin small letter ae
+    {0x38,0x44,0xC4,0xC4,0x20}, // U+00E7 latin small letter c with cedilla
+    {0x38,0x55,0x56,0x54,0x18}, // U+00E8 latin small letter e with grave
+    {0x38,0x54,0x56,0x55,0x18}, // U+00E9 latin small letter e with acute
+    {0x38,0x56,0x55,0x56,0x18}, // U+00EA latin small letter e with circumflex
+    {0x38,0x55,0x54,0x55,0x18}, // U+00EB latin small letter e with diaeresis
+    {0x00,0x45,0x7E,0x40,0x00}, // U+00EC latin small letter i with grave
+    {0x00,0x44,0x7E,0x41,0x00}, // U+00ED latin small letter i with acute
+    {0x00,0x46,0x7D,0x42,0x00}, // U+00EE latin small letter i with circumflex
+    {0x00,0x45,0x7C,0x41,0x00}, // U+00EF latin small letter i with diaeresis
+    {0x38,0x45,0x45,0x47,0x3C}, // U+00F0 latin small letter eth
+    {0x7C,0x0A,0x05,0x06,0x79}, // U+00F1 latin small letter n with tilde
+    {0x38,0x45,0x46,0x44,0x38}, // U+00F2 latin small letter o with grave
+    {0x38,0x44,0x46,0x45,0x38}, // U+00F3 latin small letter o with acute
+    {0x38,0x46,0x45,0x46,0x38}, // U+00F4 latin small letter o with circumflex
+    {0x3A,0x45,0x45,0x46,0x39}, // U+00F5 latin small letter o with tilde
+    {0x38,0x45,0x44,0x45,0x38}, // U+00F6 latin small letter o with diaeresis
+    {0x08,0x08,0x2A,0x08,0x08}, // U+00F7 division sign
+    {0x58,0x64,0x54,0x4C,0x34}, // U+00F8 latin small letter o with stroke
+    {0x3C,0x41,0x42,0x20,0x7C}, // U+00F9 latin small letter u with grave
+    {0x3C,0x40,0x42,0x21,0x7C}, // U+00FA latin small letter u with acute
+    {0x3C,0x42,0x41,0x22,0x7C}, // U+00FB latin small letter u with circumflex
+    {0x3C,0x41,0x40,0x21,0x7C}, // U+00FC latin small letter u with diaeresis
+    {0x0C,0x50,0x52,0x51,0x3C}, // U+00FD latin small letter y with acute
+    {0x7F,0x14,0x22,0x22,0x1C}, // U+00FE latin small letter thorn
+    {0x0C,0x51,0x50,0x51,0x3C}, // U+00FF latin small letter y with diaeresis
+};
+
+// Indice em fonte_glifos para U+00A0 a U+00FF; 0 = sem glifo
+static const uint8_t QUENTE_DADOS("fonte_latin1") fonte_latin1[96] = {
+     95,  96,  97,  98,   0,   0,   0,  99,   0, 100, 101, 102,   0,   0,   0,   0,
+    103, 104, 105, 106,   0, 107,   0, 108,   0,   0, 109, 110,   0,   0,   0, 111,
+    112, 113, 114, 115, 116, 117, 118, 119, 120, 121, 122, 123, 124, 125, 126, 127,
+    128, 129, 130, 131, 132, 133, 134, 135, 136, 137, 138, 139, 140, 141, 142, 143,
+    144, 145, 146, 147, 148, 149, 150, 151, 152, 153, 154, 155, 156, 157, 158, 159,
+    160, 161, 162, 163, 164, 165, 166, 167, 168, 169, 170, 171, 172, 173, 174, 175,
+};
+
+// Fim de um quadro na fila do I2C (IRQ do DMA ou i2c_fila_tarefa())
+static void QUENTE(ssd1306_fim_quadro)(bool ok) {
+    perfil_registrar(ssd1306_sonda_i2c, perfil_decorrido(ssd1306_envio_ciclos, perfil_ciclos()));
+    // O STOP nao pode ficar no quadro, que volta a ser buffer de desenho
+    ssd1306_quadros[ssd1306_tras ^ 1][ssd1306_stop_pos] &= 0xFF;
+    if (!ok) {
+        // Nao se sabe quanto do quadro chegou: o proximo reenvia a tela toda
+        ssd1306_stats.erros_i2c++;
+        ssd1306_invalido = true;
+    }
+    ssd1306_quadro_pendente = false;
+    if (ssd1306_callback)
+        ssd1306_callback();
+}
+
+static void ssd1306_fim_comandos(bool ok) {
+    if (!ok)
+        ssd1306_stats.erros_i2c++;
+}
+
+// Enfileira um stream de comandos
+static void ssd1306_comandos(const uint8_t *cmds, uint8_t n) {
+    if (!i2c_fila_escrever(ssd1306_addr, 0x00, cmds, n, ssd1306_fim_comandos))
+        ssd1306_stats.erros_i2c++;
+}
+
+static inline void ssd1306_marcar(int col_min, int col_max, int pag_min, int pag_max) {
+    if (col_min < sujo_col_min) sujo_col_min = col_min;
+    if (col_max > sujo_col_max) sujo_col_max = col_max;
+    if (pag_min < sujo_pag_min) sujo_pag_min = pag_min;
+    if (pag_max > sujo_pag_max) sujo_pag_max = pag_max;
+}
+
+static inline void ssd1306_limpar_sujo(void) {
+    sujo_col_min = SSD1306_WIDTH;
+    sujo_col_max = 0;
+    sujo_pag_min = SSD1306_PAGES;
+    sujo_pag_max = 0;
+}
+
+void ssd1306_get_stats(ssd1306_stats_t *stats) {
+    *stats = ssd1306_stats;
+}
+
+bool ssd1306_busy(void) {
+    return ssd1306_quadro_pendente || i2c_fila_ocupada();
+}
+
+void ssd1306_set_update_callback(void (*callback)(void)) {
+    ssd1306_callback = callback;
+}
+
+void ssd1306_command(uint8_t cmd) {
+    ssd1306_comandos(&cmd, 1);
+}
+
+void ssd1306_set_contraste(uint8_t contraste) {
+    const uint8_t cmds[] = { 0x81, contraste };
+    ssd1306_comandos(cmds, sizeof(cmds));
+}
+
+void ssd1306_ligar(bool ligado) {
+    ssd1306_command(ligado ? 0xAF : 0xAE);
+}
+
+// Configuracao inicial, numa unica transacao
+static const uint8_t ssd1306_config[] = {
+    0xAE,       // Display off
+    0x20, 0x00, // Memory addressing mode: horizontal
+    0xB0,       // Page start address
+    0xC8,       // COM output scan direction remapped
+    0x00,       // Low column address
+    0x10,       // High column address
+    0x40,       // Start line address
+    0x81, 0xFF, // Contrast
+    0xA1,       // Segment re-map
+    0xA6,       // Normal display
+    0xA8, 0x3F, // Multiplex ratio
+    0xA4,       // Output follows RAM content
+    0xD3, 0x00, // Display offset
+    0xD5, 0xF0, // Display clock divide ratio/oscillator frequency
+    0xD9, 0x22, // Pre-charge period
+    0xDA, 0x12, // COM pins hardware configuration
+    0xDB, 0x20, // VCOMH deselect level
+    0x8D, 0x14, // Charge pump
+    0xAF,       // Display ON
+};
+
+void ssd1306_init(uint8_t addr) {
+    ssd1306_addr = addr;
+    ssd1306_sonda_update = perfil_sonda("ssd1306_upd");
+    ssd1306_sonda_i2c = perfil_sonda("i2c_quadro");
+
+    sleep_ms(100);
+    ssd1306_comandos(ssd1306_config, sizeof(ssd1306_config));
+
+    // O conteudo da RAM do display e desconhecido apos o reset: o primeiro
+    // quadro vai inteiro
+    ssd1306_quadro_pendente = false;
+    ssd1306_invalido = true;
+
+    // Atualiza display para mostrar tela limpa
+    ssd1306_clear();
+    ssd1306_update();
+}
+
+// Reduz o retangulo sujo ao que de fato difere do ultimo quadro enviado.
+// Retorna false se nao houver nenhuma diferenca.
+static bool QUENTE(ssd1306_recortar_sujo)(const uint16_t *tras, const uint16_t *frente) {
+    int col_min = SSD1306_WIDTH, col_max = -1;
+    int pag_min = SSD1306_PAGES, pag_max = -1;
+    for (int pag = sujo_pag_min; pag <= sujo_pag_max; pag++) {
+        const uint16_t *t = &tras[pag * SSD1306_WIDTH];
+        const uint16_t *f = &frente[pag * SSD1306_WIDTH];
+        for (int col = sujo_col_min; col <= sujo_col_max; col++) {
+            if ((t[col] ^ f[col]) & 0xFF) {
+                if (col < col_min) col_min = col;
+                if (col > col_max) col_max = col;
+                if (pag < pag_min) pag_min = pag;
+                pag_max = pag;
+            }
+        }
+    }
+    if (col_max < 0)
+        return false;
+    sujo_col_min = col_min;
+    sujo_col_max = col_max;
+    sujo_pag_min = pag_min;
+    sujo_pag_max = pag_max;
+    return true;
+}
+
+static bool QUENTE(ssd1306_enviar)(void) {
+    if (ssd1306_quadro_pendente || !i2c_fila_livre())
+        return false;
+
+    uint16_t *tras = ssd1306_quadros[ssd1306_tras];
+    uint16_t *frente = ssd1306_quadros[ssd1306_tras ^ 1];
+    if (ssd1306_invalido) {
+        // Tudo diferente do quadro de tras: a tela inteira e reenviada
+        ssd1306_invalido = false;
+        for (int i = 0; i < SSD1306_BUFFER_SIZE; i++)
+            frente[i] = (tras[i] & 0xFF) ^ 0xFF;
+        ssd1306_marcar(0, SSD1306_WIDTH - 1, 0, SSD1306_PAGES - 1);
+    }
+    if (sujo_col_min > sujo_col_max || !ssd1306_recortar_sujo(tras, frente)) {
+        ssd1306_stats.quadros_ignorados++;
+        ssd1306_limpar_sujo();
+        return true;
+    }
+
+    int colunas = sujo_col_max - sujo_col_min + 1;
+    int paginas = sujo_pag_max - sujo_pag_min + 1;
+
+    ssd1306_cabecalho[0] = 0x00;                    // Co = 0, D/C = 0: stream de comandos
+    ssd1306_cabecalho[1] = 0x21;                    // Column address
+    ssd1306_cabecalho[2] = sujo_col_min;
+    ssd1306_cabecalho[3] = sujo_col_max;
+    ssd1306_cabecalho[4] = 0x22;                    // Page address
+    ssd1306_cabecalho[5] = sujo_pag_min;
+    ssd1306_cabecalho[6] = sujo_pag_max | I2C_IC_DATA_CMD_STOP_BITS;
+    ssd1306_cabecalho[7] = 0x40;                    // Co = 0, D/C = 1: stream de dados
+
+    int n = 0;
+    ssd1306_blocos[n].len = SSD1306_CABECALHO_LEN;
+    ssd1306_blocos[n++].read_addr = ssd1306_cabecalho;
+    const uint16_t *inicio = &tras[sujo_pag_min * SSD1306_WIDTH + sujo_col_min];
+    if (colunas == SSD1306_WIDTH) {
+        // Largura total: as paginas sao contiguas no framebuffer
+        ssd1306_blocos[n].len = paginas * SSD1306_WIDTH;
+        ssd1306_blocos[n++].read_addr = inicio;
+    } else {
+        for (int p = 0; p < paginas; p++) {
+            ssd1306_blocos[n].len = colunas;
+            ssd1306_blocos[n++].read_addr = inicio + p * SSD1306_WIDTH;
+        }
+    }
+
+    // A ultima palavra de dados encerra a transacao I2C
+    ssd1306_stop_pos = sujo_pag_max * SSD1306_WIDTH + sujo_col_max;
+    tras[ssd1306_stop_pos] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    ssd1306_stats.quadros_enviados++;
+    ssd1306_stats.bytes_enviados += SSD1306_CABECALHO_LEN + colunas * paginas;
+
+    // O quadro desenhado passa a ser o da frente. O novo buffer de tras so
+    // difere dele no retangulo enviado: copia apenas esse retangulo.
+    ssd1306_tras ^= 1;
+    for (int p = 0; p < paginas; p++) {
+        int base = (sujo_pag_min + p) * SSD1306_WIDTH + sujo_col_min;
+        memcpy(&frente[base], &tras[base], colunas * sizeof(uint16_t));
+    }
+    frente[ssd1306_stop_pos] &= 0xFF;
+    ssd1306_buffer = frente;
+
+    ssd1306_limpar_sujo();
+    ssd1306_quadro_pendente = true;
+    ssd1306_envio_ciclos = perfil_ciclos();
+    i2c_fila_blocos(ssd1306_addr, ssd1306_blocos, (uint8_t)n, ssd1306_fim_quadro);
+    return true;
+}
+
+bool QUENTE(ssd1306_update)(void) {
+    perfil_marca_t marca;
+    perfil_iniciar(&marca);
+    bool enviado = ssd1306_enviar();
+    perfil_terminar(ssd1306_sonda_update, &marca);
+    return enviado;
+}
+
+void ssd1306_clear(void) {
+    // Apaga e marca apenas as palavras que tinham pixels acesos
+    for (int pag = 0; pag < SSD1306_PAGES; pag++) {
+        uint16_t *linha = &ssd1306_buffer[pag * SSD1306_WIDTH];
+        for (int col = 0; col < SSD1306_WIDTH; col++) {
+            if (linha[col]) {
+                linha[col] = 0;
+                ssd1306_marcar(col, col, pag, pag);
+            }
+        }
+    }
+}
+
+void QUENTE(ssd1306_set_pixel)(int x, int y, bool on) {
+    if (x < 0 || x >= SSD1306_WIDTH || y < 0 || y >= SSD1306_HEIGHT)
+        return;
+    int page = y / 8;
+    int index = x + page * SSD1306_WIDTH;
+    uint8_t mask = 1 << (y % 8);
+    uint16_t antes = ssd1306_buffer[index];
+    if (on)
+        ssd1306_buffer[index] |= mask;
+    else
+        ssd1306_buffer[index] &= ~mask;
+    if (ssd1306_buffer[index] != antes)
+        ssd1306_marcar(x, x, page, page);
+}
+
+void QUENTE(ssd1306_clear_area)(int x, int y, int largura, int altura) {
+    int x_fim = x + largura, y_fim = y + altura;
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x_fim > SSD1306_WIDTH) x_fim = SSD1306_WIDTH;
+    if (y_fim > SSD1306_HEIGHT) y_fim = SSD1306_HEIGHT;
+    if (x >= x_fim || y >= y_fim)
+        return;
+    // Uma mascara por pagina: as paginas do meio sao apagadas inteiras
+    int pag_fim = (y_fim - 1) / 8;
+    for (int pag = y / 8; pag <= pag_fim; pag++) {
+        int linha_ini = pag * 8 > y ? 0 : y - pag * 8;
+        int linha_fim = pag * 8 + 8 < y_fim ? 8 : y_fim - pag * 8;
+        uint16_t mascara = (uint16_t)(((0xFFu << linha_ini) & (0xFFu >> (8 - linha_fim))) & 0xFF);
+        uint16_t *linha = &ssd1306_buffer[pag * SSD1306_WIDTH];
+        for (int col = x; col < x_fim; col++)
+            linha[col] &= ~mascara;
+    }
+    ssd1306_marcar(x, x_fim - 1, y / 8, pag_fim);
+}
+
+static const uint8_t *QUENTE(ssd1306_glifo)(uint32_t c) {
+    if (c >= ' ' && c <= FONTE_ASCII_FIM)
+        return fonte_glifos[c - ' '];
+    if (c >= 0xA0 && c <= 0xFF && fonte_latin1[c - 0xA0])
+        return fonte_glifos[fonte_latin1[c - 0xA0]];
+    return fonte_glifos[FONTE_SEM_GLIFO];
+}
+
+// Le um caractere UTF-8 e avanca a string; sequencia invalida vira U+FFFD
+static uint32_t QUENTE(ssd1306_utf8_proximo)(const char **str) {
+    const uint8_t *p = (const uint8_t *)*str;
+    uint32_t c = *p++;
+    if (c >= 0x80) {
+        int extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0;
+        if (extra == 0)
+            c = 0xFFFD;  // byte de continuacao solto
+        else
+            c &= 0x3F >> extra;
+        for (; extra > 0; extra--) {
+            // O terminador nunca e byte de continuacao: a leitura para nele
+            if ((*p & 0xC0) != 0x80) {
+                c = 0xFFFD;
+                break;
+            }
+            c = (c << 6) | (*p++ & 0x3F);
+        }
+    }
+    *str = (const char *)p;
+    return c;
+}
+
+// Copia o glifo coluna a coluna: cada coluna e um byte que cai inteiro numa
+// pagina quando y e multiplo de 8, ou se divide entre duas paginas
+// (deslocado para baixo na de cima, para cima na de baixo). A coluna de
+// espaco apaga a caixa do caractere, como antes.
+void QUENTE(ssd1306_draw_char)(uint32_t c, int x, int y) {
+    if (c < ' ')
+        return;
+    if (x <= -(FONTE_LARGURA + FONTE_ESPACO) || x >= SSD1306_WIDTH ||
+        y <= -FONTE_ALTURA || y >= SSD1306_HEIGHT)
+        return;
+    const uint8_t *glifo = ssd1306_glifo(c);
+
+    int pag = (y + 8) / 8 - 1;  // divisao arredondada para baixo (y > -8)
+    int desloc = y - pag * 8;
+    uint16_t *cima = pag >= 0 ? &ssd1306_buffer[pag * SSD1306_WIDTH] : NULL;
+    uint16_t *baixo = desloc && pag + 1 < SSD1306_PAGES ? &ssd1306_buffer[(pag + 1) * SSD1306_WIDTH] : NULL;
+
+    int col_ini = x < 0 ? -x : 0;
+    int col_fim = FONTE_LARGURA + FONTE_ESPACO;
+    if (x + col_fim > SSD1306_WIDTH)
+        col_fim = SSD1306_WIDTH - x;
+    // Marca a caixa do caractere de uma vez
+    ssd1306_marcar(x + col_ini, x + col_fim - 1, cima ? pag : pag + 1, baixo ? pag + 1 : pag);
+
+    for (int col = col_ini; col < col_fim; col++) {
+        if (col < FONTE_LARGURA) {
+            uint16_t bits = glifo[col];
+            if (cima)
+                cima[x + col] |= (bits << desloc) & 0xFF;
+            if (baixo)
+                baixo[x + col] |= bits >> (8 - desloc);
+        } else {
+            if (cima)
+                cima[x + col] &= ~((0xFFu << desloc) & 0xFF);
+            if (baixo)
+                baixo[x + col] &= ~(0xFFu >> (8 - desloc));
+        }
+    }
+}
+
+// Desenha a string (UTF-8) apenas no framebuffer, sem enviar ao display
+void QUENTE(ssd1306_render_string)(const char *str, int x, int y) {
+    while (*str) {
+        ssd1306_draw_char(ssd1306_utf8_proximo(&str), x, y);
+        x += FONTE_LARGURA + FONTE_ESPACO;
+    }
+}
+
+void QUENTE(ssd1306_draw_string)(const char *str, int x, int y) {
+    ssd1306_render_string(str, x, y);
+    ssd1306_update();
+}
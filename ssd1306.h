@@ -0,0 +1,85 @@
+// ssd1306.h - Driver do display OLED SSD1306 via I2C com envio por DMA
+//
+// O framebuffer e duplo: desenha-se sempre no buffer de tras
+// (ssd1306_buffer) enquanto o quadro anterior ainda e transmitido pelo DMA.
+// Cada posicao do framebuffer e uma palavra de 16 bits no formato do
+// registrador IC_DATA_CMD do I2C: o byte de pixels fica nos 8 bits baixos e
+// os bits altos carregam as flags de controle (STOP). Assim o DMA da fila do
+// I2C (i2c_fila.h) alimenta o barramento direto do framebuffer, sem copias
+// intermediarias. Nada aqui espera pelo barramento.
+//
+// As funcoes de desenho marcam o retangulo alterado; ssd1306_update() envia
+// so a parte que difere do quadro anterior, ou nada se nao houver mudanca.
+
+#ifndef SSD1306_H
+#define SSD1306_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Display OLED: dimensoes
+#define SSD1306_WIDTH       128
+#define SSD1306_HEIGHT      64
+#define SSD1306_PAGES       (SSD1306_HEIGHT / 8)
+#define SSD1306_BUFFER_SIZE (SSD1306_WIDTH * SSD1306_HEIGHT / 8)
+
+// Contadores de envio
+typedef struct {
+    uint32_t quadros_enviados;
+    uint32_t quadros_ignorados;  // ssd1306_update() sem nenhuma mudanca
+    uint32_t bytes_enviados;     // bytes no barramento I2C, cabecalhos inclusos
+    uint32_t erros_i2c;          // quadros e comandos com falha (NAK, prazo, fila cheia)
+} ssd1306_stats_t;
+
+// Buffer de desenho (de tras); indice = x + pagina * SSD1306_WIDTH
+extern uint16_t *ssd1306_buffer;
+
+// Configura o display, com todos os comandos numa unica transacao; a fila
+// do I2C ja deve estar inicializada (i2c_fila_init())
+void ssd1306_init(uint8_t addr);
+
+// Enfileira um comando e retorna. Comandos seguidos que ainda nao sairam
+// vao na mesma transacao, depois do quadro que estiver na frente deles.
+void ssd1306_command(uint8_t cmd);
+
+// Contraste (0x00 a 0xFF; ssd1306_init() usa 0xFF)
+void ssd1306_set_contraste(uint8_t contraste);
+
+// Liga ou desliga o painel. Desligado, o controlador segue aceitando
+// quadros na RAM, que reaparecem ao religar.
+void ssd1306_ligar(bool ligado);
+
+void ssd1306_clear(void);
+void ssd1306_set_pixel(int x, int y, bool on);
+
+// Apaga o retangulo (recortado aos limites da tela)
+void ssd1306_clear_area(int x, int y, int largura, int altura);
+
+// Desenha um caractere (codigo Unicode) com a fonte 5x7 a partir do canto
+// superior esquerdo (x, y), fazendo OR dos pixels. ASCII imprimivel e os
+// acentos Latin-1 (U+00A0 a U+00FF) tem glifo; o resto sai como '?'.
+void ssd1306_draw_char(uint32_t c, int x, int y);
+
+// Desenha a string (UTF-8) apenas no framebuffer, sem enviar ao display;
+// cada caractere ocupa 6 colunas
+void ssd1306_render_string(const char *str, int x, int y);
+
+// Desenha e ja dispara o envio do quadro. Para varios textos por quadro,
+// use ssd1306_render_string() e um unico ssd1306_update() (ou ui.h).
+void ssd1306_draw_string(const char *str, int x, int y);
+
+// Poe na fila do I2C as mudancas do buffer de tras e retorna imediatamente.
+// Retorna false se o quadro anterior ainda nao saiu ou a fila estiver cheia;
+// nesse caso nada e enviado e o chamador deve tentar de novo mais tarde.
+bool ssd1306_update(void);
+
+// true enquanto houver quadro ou comando na fila do I2C ou bytes no fio
+bool ssd1306_busy(void);
+
+void ssd1306_get_stats(ssd1306_stats_t *stats);
+
+// Funcao chamada ao fim de cada envio (na IRQ do DMA, ou em
+// i2c_fila_tarefa() se o prazo estourou)
+void ssd1306_set_update_callback(void (*callback)(void));
+
+#endif // SSD1306_H
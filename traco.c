@@ -0,0 +1,239 @@
+// traco.c - Traco binario das entradas (ADC e botoes) e dos relatorios HID
+
+#include <stdio.h>
+#include <string.h>
+#include "hardware/sync.h"
+#include "traco.h"
+
+#define TRACO_CABECALHO     3       // tipo e intervalo
+#define TRACO_DT_MAX        0xFFFFu
+#define TRACO_REGISTRO_MAX  (TRACO_CABECALHO + 2 + TRACO_HID_MAX)
+
+static uint8_t traco_byte(const traco_t *t, uint32_t i) {
+    return t->buf[i & (t->capacidade - 1)];
+}
+
+static uint16_t traco_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static void traco_escrever_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+// Tamanho do registro que comeca em i; 0 se o tipo for invalido
+static uint32_t traco_tamanho(const traco_t *t, uint32_t i) {
+    switch (traco_byte(t, i)) {
+    case TRACO_ADC:   return TRACO_CABECALHO + 4;
+    case TRACO_BORDA: return TRACO_CABECALHO + 1;
+    case TRACO_PAUSA: return TRACO_CABECALHO;
+    case TRACO_HID: {
+        uint8_t n = traco_byte(t, i + TRACO_CABECALHO + 1);
+        return n <= TRACO_HID_MAX ? TRACO_CABECALHO + 2 + n : 0;
+    }
+    default:          return 0;
+    }
+}
+
+// Descarta o registro mais antigo, levando o estado dele para o INICIO
+static void traco_descartar(traco_t *t) {
+    uint32_t i = t->cauda;
+    uint8_t r[TRACO_CABECALHO + 4];
+    for (uint32_t k = 0; k < sizeof(r); k++)
+        r[k] = traco_byte(t, i + k);
+    t->inicio_us += traco_u16(&r[1]);
+    if (r[0] == TRACO_ADC) {
+        t->inicio_x = traco_u16(&r[3]);
+        t->inicio_y = traco_u16(&r[5]);
+    } else if (r[0] == TRACO_BORDA) {
+        uint8_t bit = 1u << (r[3] & 0x07);
+        t->inicio_niveis = (r[3] & 0x80) ? t->inicio_niveis | bit : t->inicio_niveis & ~bit;
+    }
+    t->cauda += traco_tamanho(t, i);
+    t->descartados++;
+}
+
+static void traco_gravar(traco_t *t, const uint8_t *r, uint32_t n) {
+    while (t->capacidade - (t->cabeca - t->cauda) < n)
+        traco_descartar(t);
+    for (uint32_t k = 0; k < n; k++)
+        t->buf[(t->cabeca + k) & (t->capacidade - 1)] = r[k];
+    t->cabeca += n;
+}
+
+// Cabecalho do proximo registro em t_us; gaps longos viram pausas antes dele
+static void traco_cabecalho(traco_t *t, uint8_t *r, uint8_t tipo, uint32_t t_us) {
+    uint32_t dt = 0;
+    if ((int32_t)(t_us - t->ultimo_us) > 0) {
+        dt = t_us - t->ultimo_us;
+        t->ultimo_us = t_us;
+    }
+    while (dt > TRACO_DT_MAX) {
+        uint8_t pausa[TRACO_CABECALHO] = { TRACO_PAUSA, 0xFF, 0xFF };
+        traco_gravar(t, pausa, sizeof(pausa));
+        dt -= TRACO_DT_MAX;
+    }
+    r[0] = tipo;
+    traco_escrever_u16(&r[1], (uint16_t)dt);
+}
+
+void traco_init(traco_t *t, uint8_t *buf, uint32_t capacidade) {
+    t->buf = buf;
+    t->capacidade = capacidade;
+    traco_iniciar(t, 0, 0, 0, 0xFF);
+}
+
+void traco_iniciar(traco_t *t, uint32_t agora_us, uint16_t x, uint16_t y, uint8_t niveis) {
+    uint32_t estado = save_and_disable_interrupts();
+    t->cabeca = t->cauda = 0;
+    t->ultimo_us = agora_us;
+    t->descartados = 0;
+    t->inicio_us = agora_us;
+    t->inicio_x = x;
+    t->inicio_y = y;
+    t->inicio_niveis = niveis;
+    t->x = x;
+    t->y = y;
+    t->adc_gravado = false;
+    restore_interrupts(estado);
+}
+
+void traco_adc(traco_t *t, uint32_t t_us, uint16_t x, uint16_t y) {
+    if (t->adc_gravado && x == t->x && y == t->y)
+        return;
+    uint32_t estado = save_and_disable_interrupts();
+    uint8_t r[TRACO_CABECALHO + 4];
+    traco_cabecalho(t, r, TRACO_ADC, t_us);
+    traco_escrever_u16(&r[3], x);
+    traco_escrever_u16(&r[5], y);
+    traco_gravar(t, r, sizeof(r));
+    t->x = x;
+    t->y = y;
+    t->adc_gravado = true;
+    restore_interrupts(estado);
+}
+
+void traco_borda(traco_t *t, uint32_t t_us, uint8_t botao, bool nivel) {
+    uint32_t estado = save_and_disable_interrupts();
+    uint8_t r[TRACO_CABECALHO + 1];
+    traco_cabecalho(t, r, TRACO_BORDA, t_us);
+    r[3] = (uint8_t)((botao & 0x7F) | (nivel ? 0x80 : 0));
+    traco_gravar(t, r, sizeof(r));
+    restore_interrupts(estado);
+}
+
+void traco_hid(traco_t *t, uint32_t t_us, uint8_t instancia, const uint8_t *relatorio, uint16_t n) {
+    if (n > TRACO_HID_MAX)
+        n = TRACO_HID_MAX;
+    uint32_t estado = save_and_disable_interrupts();
+    uint8_t r[TRACO_REGISTRO_MAX];
+    traco_cabecalho(t, r, TRACO_HID, t_us);
+    r[3] = instancia;
+    r[4] = (uint8_t)n;
+    memcpy(&r[5], relatorio, n);
+    traco_gravar(t, r, TRACO_CABECALHO + 2 + n);
+    restore_interrupts(estado);
+}
+
+void traco_fechar(traco_t *t, uint32_t agora_us) {
+    uint32_t estado = save_and_disable_interrupts();
+    uint8_t r[TRACO_CABECALHO];
+    traco_cabecalho(t, r, TRACO_PAUSA, agora_us);
+    traco_gravar(t, r, sizeof(r));
+    restore_interrupts(estado);
+}
+
+// =====================
+// Serializacao
+// =====================
+uint32_t traco_bytes(const traco_t *t) {
+    return TRACO_INICIO_BYTES + (t->cabeca - t->cauda);
+}
+
+uint32_t traco_serializar(const traco_t *t, uint32_t offset, uint8_t *dst, uint32_t n) {
+    uint8_t inicio[TRACO_INICIO_BYTES] = {
+        TRACO_INICIO, 0, 0, TRACO_VERSAO, t->inicio_niveis,
+        (uint8_t)t->inicio_us, (uint8_t)(t->inicio_us >> 8),
+        (uint8_t)(t->inicio_us >> 16), (uint8_t)(t->inicio_us >> 24),
+    };
+    traco_escrever_u16(&inicio[9], t->inicio_x);
+    traco_escrever_u16(&inicio[11], t->inicio_y);
+
+    uint32_t total = traco_bytes(t), k = 0;
+    for (; k < n && offset + k < total; k++) {
+        uint32_t i = offset + k;
+        dst[k] = i < TRACO_INICIO_BYTES ? inicio[i] : traco_byte(t, t->cauda + i - TRACO_INICIO_BYTES);
+    }
+    return k;
+}
+
+bool traco_carregar(traco_t *t, const uint8_t *src, uint32_t n) {
+    if (n < TRACO_INICIO_BYTES || src[0] != TRACO_INICIO || src[3] != TRACO_VERSAO ||
+        n - TRACO_INICIO_BYTES > t->capacidade)
+        return false;
+    uint32_t inicio_us = src[5] | src[6] << 8 | src[7] << 16 | (uint32_t)src[8] << 24;
+    traco_iniciar(t, inicio_us, traco_u16(&src[9]), traco_u16(&src[11]), src[4]);
+    memcpy(t->buf, &src[TRACO_INICIO_BYTES], n - TRACO_INICIO_BYTES);
+    t->cabeca = n - TRACO_INICIO_BYTES;
+    return true;
+}
+
+// =====================
+// Leitura
+// =====================
+void traco_cursor(const traco_t *t, traco_cursor_t *c) {
+    c->pos = t->cauda;
+    c->t_us = 0;
+}
+
+bool traco_ler(const traco_t *t, traco_cursor_t *c, traco_evento_t *ev) {
+    uint32_t disponivel = t->cabeca - c->pos;
+    if (disponivel < TRACO_CABECALHO)
+        return false;
+    uint32_t n = traco_tamanho(t, c->pos);
+    if (n == 0 || n > disponivel)
+        return false;
+    uint8_t r[TRACO_REGISTRO_MAX];
+    for (uint32_t k = 0; k < n; k++)
+        r[k] = traco_byte(t, c->pos + k);
+    c->pos += n;
+    c->t_us += traco_u16(&r[1]);
+
+    ev->tipo = r[0];
+    ev->t_us = c->t_us;
+    if (r[0] == TRACO_ADC) {
+        ev->x = traco_u16(&r[3]);
+        ev->y = traco_u16(&r[5]);
+    } else if (r[0] == TRACO_BORDA) {
+        ev->botao = r[3] & 0x7F;
+        ev->nivel = r[3] & 0x80;
+    } else if (r[0] == TRACO_HID) {
+        ev->instancia = r[3];
+        ev->n = r[4];
+        memcpy(ev->dados, &r[5], ev->n);
+    }
+    return true;
+}
+
+int traco_formatar(const traco_evento_t *ev, char *s, size_t n) {
+    unsigned long t = ev->t_us;
+    switch (ev->tipo) {
+    case TRACO_ADC:
+        return snprintf(s, n, "%lu adc %u %u\n", t, ev->x, ev->y);
+    case TRACO_BORDA:
+        return snprintf(s, n, "%lu borda %u %u\n", t, ev->botao, ev->nivel);
+    case TRACO_PAUSA:
+        return snprintf(s, n, "%lu pausa\n", t);
+    case TRACO_HID: {
+        int k = snprintf(s, n, "%lu hid %u", t, ev->instancia);
+        for (uint8_t i = 0; i < ev->n && k >= 0 && (size_t)k < n; i++)
+            k += snprintf(s + k, n - k, " %02x", ev->dados[i]);
+        if (k >= 0 && (size_t)k < n)
+            k += snprintf(s + k, n - k, "\n");
+        return k;
+    }
+    default:
+        return snprintf(s, n, "%lu ?\n", t);
+    }
+}
@@ -0,0 +1,107 @@
+// traco.h - Traco binario das entradas (ADC e botoes) e dos relatorios HID
+//
+// Grava uma sessao de uso num anel de bytes na RAM para reproduzi-la depois
+// pelo mesmo processamento, no dispositivo ou no build de host, e comparar
+// os relatorios HID resultantes byte a byte e tempo a tempo.
+//
+// Cada registro comeca com o tipo (1 byte) e o intervalo desde o registro
+// anterior em us (u16 LE); intervalos maiores viram registros PAUSA.
+//   INICIO  versao, niveis dos botoes (bit = indice), instante absoluto
+//           (u32), x e y (u16): estado das entradas antes do primeiro
+//           registro; so existe na serializacao (13 bytes)
+//   ADC     x e y como entraram no filtro do joystick (u16 cada, 7 bytes);
+//           amostras iguais a anterior nao sao gravadas
+//   BORDA   indice do botao (bits 0-6) e nivel do pino (bit 7) (4 bytes)
+//   PAUSA   so o intervalo (3 bytes)
+//   HID     instancia, tamanho e o relatorio, com o report ID se houver
+//           (5 + n bytes)
+// Cheio, o anel descarta os registros mais antigos e o estado deles passa
+// para o INICIO, entao a serializacao continua valida.
+//
+// Instantes fora de ordem (uma IRQ de borda entre a leitura do relogio e a
+// gravacao da amostra do ADC) sao gravados com intervalo 0.
+
+#ifndef TRACO_H
+#define TRACO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TRACO_VERSAO        1
+#define TRACO_HID_MAX       16
+#define TRACO_INICIO_BYTES  13
+
+typedef enum {
+    TRACO_INICIO,
+    TRACO_ADC,
+    TRACO_BORDA,
+    TRACO_PAUSA,
+    TRACO_HID,
+} traco_tipo_t;
+
+typedef struct {
+    uint8_t *buf;
+    uint32_t capacidade;        // bytes, potencia de 2
+    uint32_t cabeca, cauda;     // indices livres; cabeca - cauda = bytes gravados
+    uint32_t ultimo_us;         // instante absoluto do ultimo registro
+    uint32_t descartados;       // registros sobrescritos pelo anel
+
+    // Estado das entradas antes do primeiro registro retido (INICIO)
+    uint32_t inicio_us;
+    uint16_t inicio_x, inicio_y;
+    uint8_t inicio_niveis;
+
+    // Ultima amostra do ADC gravada, para nao repetir amostras iguais
+    uint16_t x, y;
+    bool adc_gravado;
+} traco_t;
+
+// Registro decodificado por traco_ler()
+typedef struct {
+    uint8_t tipo;               // traco_tipo_t
+    uint32_t t_us;              // desde o inicio do traco
+    uint16_t x, y;              // ADC
+    uint8_t botao;              // BORDA
+    bool nivel;
+    uint8_t instancia;          // HID
+    uint8_t n;
+    uint8_t dados[TRACO_HID_MAX];
+} traco_evento_t;
+
+typedef struct {
+    uint32_t pos;               // indice do proximo byte no anel
+    uint32_t t_us;              // instante do ultimo registro lido
+} traco_cursor_t;
+
+void traco_init(traco_t *t, uint8_t *buf, uint32_t capacidade);
+
+// Esvazia o traco e comeca a contar o tempo em agora_us, com as entradas
+// no estado dado (niveis: bit i = nivel do pino do botao i)
+void traco_iniciar(traco_t *t, uint32_t agora_us, uint16_t x, uint16_t y, uint8_t niveis);
+
+// Gravacao; seguras contra a IRQ de GPIO do mesmo nucleo
+void traco_adc(traco_t *t, uint32_t t_us, uint16_t x, uint16_t y);
+void traco_borda(traco_t *t, uint32_t t_us, uint8_t botao, bool nivel);
+void traco_hid(traco_t *t, uint32_t t_us, uint8_t instancia, const uint8_t *relatorio, uint16_t n);
+
+// Completa o traco com pausas ate agora_us, para que a reproducao dure o
+// mesmo que a gravacao
+void traco_fechar(traco_t *t, uint32_t agora_us);
+
+// Serializacao: o INICIO seguido dos registros do anel
+uint32_t traco_bytes(const traco_t *t);
+// Copia ate n bytes da serializacao a partir de offset; retorna quantos
+uint32_t traco_serializar(const traco_t *t, uint32_t offset, uint8_t *dst, uint32_t n);
+// Le uma serializacao; false se o INICIO for invalido ou nao couber
+bool traco_carregar(traco_t *t, const uint8_t *src, uint32_t n);
+
+// Leitura em ordem, do registro mais antigo ao mais novo
+void traco_cursor(const traco_t *t, traco_cursor_t *c);
+bool traco_ler(const traco_t *t, traco_cursor_t *c, traco_evento_t *ev);
+
+// Uma linha de texto por registro ("<t_us> <tipo> ..."), para comparar
+// reproducoes com diff; retorna o tamanho como snprintf
+int traco_formatar(const traco_evento_t *ev, char *s, size_t n);
+
+#endif // TRACO_H
@@ -0,0 +1,63 @@
+// tusb_config.h - Configuracao do TinyUSB para o HPR (dispositivo full speed)
+
+#ifndef TUSB_CONFIG_H
+#define TUSB_CONFIG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =====================
+// Porta e sistema
+// =====================
+#ifndef CFG_TUSB_MCU
+#error CFG_TUSB_MCU deve ser definido pelo build (o pico-sdk define OPT_MCU_RP2040)
+#endif
+
+#ifndef CFG_TUSB_OS
+#define CFG_TUSB_OS             OPT_OS_PICO
+#endif
+
+#define CFG_TUSB_RHPORT0_MODE   (OPT_MODE_DEVICE | OPT_MODE_FULL_SPEED)
+
+// =====================
+// Dispositivo
+// =====================
+#define CFG_TUD_ENDPOINT0_SIZE  64
+
+// Classes habilitadas
+#define CFG_TUD_HID             2       // mouse e teclado (usb_descriptors.h)
+#define CFG_TUD_CDC             1
+#define CFG_TUD_MSC             0
+#define CFG_TUD_AUDIO           1       // microfone (microfone_usb.c)
+#define CFG_TUD_MIDI            0
+#define CFG_TUD_VENDOR          0
+
+// Maior relatorio HID (mouse de 9 bytes; teclado de 8 + ID)
+#define CFG_TUD_HID_EP_BUFSIZE  16
+
+// Porta serial de controle (cdc_controle.c)
+#define CFG_TUD_CDC_EP_BUFSIZE  64
+#define CFG_TUD_CDC_RX_BUFSIZE  64
+#define CFG_TUD_CDC_TX_BUFSIZE  256
+
+// Microfone USB (microfone_usb.c): um canal de 16 bits a 16 kHz, pacotes de
+// 16 amostras com uma a mais para o casamento de taxa. O pacote e escrito
+// inteiro a cada quadro, entao a FIFO do TinyUSB tem o tamanho do endpoint;
+// o ritmo e do proprio modulo, sem o controle de fluxo do TinyUSB.
+#define CFG_TUD_AUDIO_FUNC_1_DESC_LEN           TUD_AUDIO_MIC_ONE_CH_DESC_LEN
+#define CFG_TUD_AUDIO_FUNC_1_N_AS_INT           1
+#define CFG_TUD_AUDIO_FUNC_1_CTRL_BUF_SZ        64
+#define CFG_TUD_AUDIO_ENABLE_EP_IN              1
+#define CFG_TUD_AUDIO_FUNC_1_N_BYTES_PER_SAMPLE_TX  2
+#define CFG_TUD_AUDIO_FUNC_1_N_CHANNELS_TX      1
+#define CFG_TUD_AUDIO_EP_SZ_IN                  ((16 + 1) * 2)
+#define CFG_TUD_AUDIO_FUNC_1_EP_IN_SZ_MAX       CFG_TUD_AUDIO_EP_SZ_IN
+#define CFG_TUD_AUDIO_FUNC_1_EP_IN_SW_BUF_SZ    CFG_TUD_AUDIO_EP_SZ_IN
+#define CFG_TUD_AUDIO_EP_IN_FLOW_CONTROL        0
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TUSB_CONFIG_H
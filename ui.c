@@ -0,0 +1,84 @@
+// ui.c - Camada de interface retida sobre o SSD1306
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "ssd1306.h"
+#include "quente.h"
+#include "ui.h"
+
+#define UI_CHAR_LARGURA     6       // 5 colunas do glifo + espaco
+#define UI_LINHA_ALTURA     8
+
+// Posicao de cada campo; y em multiplos de 8 mantem o desenho no caminho
+// alinhado a pagina do ssd1306_draw_char()
+typedef struct {
+    uint8_t x;
+    uint8_t y;
+    uint8_t largura;            // em caracteres
+} ui_posicao_t;
+
+static const ui_posicao_t QUENTE_DADOS("ui_layout") ui_layout[UI_N_CAMPOS] = {
+    [UI_STATUS]    = { 0, 0,  SSD1306_WIDTH / UI_CHAR_LARGURA },
+    [UI_MODO]      = { 0, 24, SSD1306_WIDTH / UI_CHAR_LARGURA },
+    [UI_JOYSTICK]  = { 0, 32, SSD1306_WIDTH / UI_CHAR_LARGURA },
+    [UI_MICROFONE] = { 0, 40, SSD1306_WIDTH / UI_CHAR_LARGURA },
+    [UI_USB]       = { 0, 48, SSD1306_WIDTH / UI_CHAR_LARGURA },
+};
+
+static char ui_textos[UI_N_CAMPOS][UI_TEXTO_MAX];
+static uint32_t ui_sujos;               // um bit por campo
+static bool ui_pendente = false;        // quadro desenhado ainda nao enviado
+static uint32_t ui_ultimo_envio_us;
+static ui_stats_t ui_stats;
+
+_Static_assert(UI_N_CAMPOS <= 32, "mascara de campos sujos");
+
+void ui_init(void) {
+    memset(ui_textos, 0, sizeof(ui_textos));
+    ui_sujos = 0;
+    ui_pendente = false;
+    ui_ultimo_envio_us = time_us_32() - UI_QUADRO_MIN_US;
+    ssd1306_clear();
+}
+
+void ui_definir(ui_campo_t campo, const char *texto) {
+    if (campo >= UI_N_CAMPOS)
+        return;
+    if (strncmp(ui_textos[campo], texto, UI_TEXTO_MAX - 1) == 0)
+        return;
+    strncpy(ui_textos[campo], texto, UI_TEXTO_MAX - 1);
+    ui_textos[campo][UI_TEXTO_MAX - 1] = '\0';
+    ui_sujos |= 1u << campo;
+}
+
+void QUENTE(ui_tarefa)(void) {
+    if (!ui_sujos && !ui_pendente)
+        return;
+    uint32_t agora = time_us_32();
+    if (agora - ui_ultimo_envio_us < UI_QUADRO_MIN_US)
+        return;
+
+    // Desenha no buffer de tras, mesmo com o quadro anterior em transito
+    for (int i = 0; ui_sujos; i++) {
+        if (!(ui_sujos & (1u << i)))
+            continue;
+        const ui_posicao_t *p = &ui_layout[i];
+        ssd1306_clear_area(p->x, p->y, p->largura * UI_CHAR_LARGURA, UI_LINHA_ALTURA);
+        ssd1306_render_string(ui_textos[i], p->x, p->y);
+        ui_sujos &= ~(1u << i);
+        ui_stats.campos_desenhados++;
+        ui_pendente = true;
+    }
+
+    if (ssd1306_update()) {
+        ui_pendente = false;
+        ui_ultimo_envio_us = agora;
+        ui_stats.quadros++;
+    } else {
+        ui_stats.adiados++;
+    }
+}
+
+void ui_get_stats(ui_stats_t *stats) {
+    *stats = ui_stats;
+}
@@ -0,0 +1,46 @@
+// ui.h - Camada de interface retida sobre o SSD1306
+//
+// A tela e dividida em campos nomeados, cada um numa faixa fixa do display.
+// Quem produz o estado so chama ui_definir() com o texto novo; nada e
+// desenhado nessa hora. ui_tarefa() redesenha apenas os campos cujo texto
+// mudou e envia tudo num unico ssd1306_update(), no maximo uma vez a cada
+// UI_QUADRO_MIN_US. O custo do display fica proporcional as mudancas e
+// nenhuma parte dele roda no caminho de entrada.
+
+#ifndef UI_H
+#define UI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UI_TEXTO_MAX        32      // bytes por campo (UTF-8), com o terminador
+#define UI_QUADRO_MIN_US    40000   // 25 quadros/s no maximo
+
+typedef enum {
+    UI_STATUS,                  // mensagem principal (linha de cima)
+    UI_MODO,                    // cursor / rolagem
+    UI_JOYSTICK,                // atividade do joystick
+    UI_MICROFONE,               // estado do VAD
+    UI_USB,                     // conexao USB
+    UI_N_CAMPOS
+} ui_campo_t;
+
+typedef struct {
+    uint32_t quadros;           // ssd1306_update() disparados
+    uint32_t campos_desenhados;
+    uint32_t adiados;           // quadro pronto esperando o envio anterior
+} ui_stats_t;
+
+// Apaga a tela; os campos comecam vazios
+void ui_init(void);
+
+// Guarda o texto do campo; so marca para redesenho se ele mudou
+void ui_definir(ui_campo_t campo, const char *texto);
+
+// Redesenha os campos alterados e envia o quadro, respeitando o limite de
+// taxa. Chamar periodicamente do nucleo dono do display.
+void ui_tarefa(void);
+
+void ui_get_stats(ui_stats_t *stats);
+
+#endif // UI_H
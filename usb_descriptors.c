@@ -0,0 +1,197 @@
+// usb_descriptors.c - Descritores USB do HPR (dispositivo, configuracao,
+// relatorios HID e strings)
+
+#include "pico/unique_id.h"
+#include "tusb.h"
+#include "usb_descriptors.h"
+
+// VID de testes do TinyUSB; trocar por um VID/PID proprio antes de distribuir
+#define USB_VID             0xCafe
+#define USB_PID             0x4006    // composto: mouse + teclado + CDC + audio
+#define USB_BCD             0x0200
+
+#define EPNUM_HID_MOUSE     0x81
+#define EPNUM_HID_TECLADO   0x82
+#define EPNUM_CDC_NOTIF     0x83
+#define EPNUM_CDC_OUT       0x04
+#define EPNUM_CDC_IN        0x84
+#define EPNUM_AUDIO_IN      0x85
+
+#define HID_INTERVALO_MS    1       // 1 kHz em full speed
+#define CDC_NOTIF_TAMANHO   8
+#define CDC_EP_TAMANHO      64
+
+// =====================
+// Dispositivo
+// =====================
+static const tusb_desc_device_t desc_dispositivo = {
+    .bLength = sizeof(tusb_desc_device_t),
+    .bDescriptorType = TUSB_DESC_DEVICE,
+    .bcdUSB = USB_BCD,
+    // As funcoes CDC e de audio usam IAD (Interface Association Descriptor)
+    .bDeviceClass = TUSB_CLASS_MISC,
+    .bDeviceSubClass = MISC_SUBCLASS_COMMON,
+    .bDeviceProtocol = MISC_PROTOCOL_IAD,
+    .bMaxPacketSize0 = CFG_TUD_ENDPOINT0_SIZE,
+    .idVendor = USB_VID,
+    .idProduct = USB_PID,
+    .bcdDevice = 0x0100,
+    .iManufacturer = 0x01,
+    .iProduct = 0x02,
+    .iSerialNumber = 0x03,
+    .bNumConfigurations = 0x01
+};
+
+const uint8_t *tud_descriptor_device_cb(void) {
+    return (const uint8_t *)&desc_dispositivo;
+}
+
+// =====================
+// Relatorio HID do mouse (formato em hid_mouse.h)
+// =====================
+// Cada roda fica numa colecao logica propria com o seu Resolution
+// Multiplier, como pede a especificacao para que o host associe um ao outro.
+#define HID_RODA_ALTA_RESOLUCAO(...)                                        \
+    HID_COLLECTION(HID_COLLECTION_LOGICAL),                                 \
+        HID_USAGE_PAGE(HID_USAGE_PAGE_DESKTOP),                             \
+        HID_USAGE(0x48), /* Resolution Multiplier */                        \
+        HID_LOGICAL_MIN(0), HID_LOGICAL_MAX(1),                             \
+        HID_PHYSICAL_MIN(1), HID_PHYSICAL_MAX(120),                         \
+        HID_REPORT_SIZE(2), HID_REPORT_COUNT(1),                            \
+        HID_FEATURE(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),                \
+        HID_PHYSICAL_MIN(0), HID_PHYSICAL_MAX(0),                           \
+        __VA_ARGS__,                                                        \
+        HID_LOGICAL_MIN_N(-32767, 2), HID_LOGICAL_MAX_N(32767, 2),          \
+        HID_REPORT_SIZE(16), HID_REPORT_COUNT(1),                           \
+        HID_INPUT(HID_DATA | HID_VARIABLE | HID_RELATIVE),                  \
+    HID_COLLECTION_END
+
+static const uint8_t desc_relatorio_mouse[] = {
+    HID_USAGE_PAGE(HID_USAGE_PAGE_DESKTOP),
+    HID_USAGE(HID_USAGE_DESKTOP_MOUSE),
+    HID_COLLECTION(HID_COLLECTION_APPLICATION),
+        HID_USAGE(HID_USAGE_DESKTOP_POINTER),
+        HID_COLLECTION(HID_COLLECTION_PHYSICAL),
+            // 5 botoes + 3 bits de enchimento
+            HID_USAGE_PAGE(HID_USAGE_PAGE_BUTTON),
+            HID_USAGE_MIN(1), HID_USAGE_MAX(5),
+            HID_LOGICAL_MIN(0), HID_LOGICAL_MAX(1),
+            HID_REPORT_COUNT(5), HID_REPORT_SIZE(1),
+            HID_INPUT(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),
+            HID_REPORT_COUNT(1), HID_REPORT_SIZE(3),
+            HID_INPUT(HID_CONSTANT),
+
+            // X e Y relativos de 16 bits
+            HID_USAGE_PAGE(HID_USAGE_PAGE_DESKTOP),
+            HID_USAGE(HID_USAGE_DESKTOP_X),
+            HID_USAGE(HID_USAGE_DESKTOP_Y),
+            HID_LOGICAL_MIN_N(-32767, 2), HID_LOGICAL_MAX_N(32767, 2),
+            HID_REPORT_SIZE(16), HID_REPORT_COUNT(2),
+            HID_INPUT(HID_DATA | HID_VARIABLE | HID_RELATIVE),
+
+            // Roda vertical e horizontal de alta resolucao
+            HID_RODA_ALTA_RESOLUCAO(HID_USAGE(HID_USAGE_DESKTOP_WHEEL)),
+            HID_RODA_ALTA_RESOLUCAO(HID_USAGE_PAGE(HID_USAGE_PAGE_CONSUMER),
+                                    HID_USAGE_N(HID_USAGE_CONSUMER_AC_PAN, 2)),
+
+            // Completa o byte do relatorio de feature
+            HID_REPORT_SIZE(4), HID_REPORT_COUNT(1),
+            HID_FEATURE(HID_CONSTANT),
+        HID_COLLECTION_END,
+    HID_COLLECTION_END
+};
+
+// =====================
+// Relatorio HID do teclado e do controle de consumo (hid_teclado.h)
+// =====================
+// Relatorios padrao do TinyUSB, separados por ID na mesma interface
+static const uint8_t desc_relatorio_teclado[] = {
+    TUD_HID_REPORT_DESC_KEYBOARD(HID_REPORT_ID(USB_RELATORIO_TECLADO)),
+    TUD_HID_REPORT_DESC_CONSUMER(HID_REPORT_ID(USB_RELATORIO_CONSUMO)),
+};
+
+const uint8_t *tud_hid_descriptor_report_cb(uint8_t instance) {
+    return instance == USB_HID_TECLADO ? desc_relatorio_teclado : desc_relatorio_mouse;
+}
+
+// =====================
+// Configuracao
+// =====================
+// A ordem das interfaces HID define as instancias de usb_descriptors.h
+enum {
+    ITF_NUM_HID_MOUSE,
+    ITF_NUM_HID_TECLADO,
+    ITF_NUM_CDC,
+    ITF_NUM_CDC_DADOS,
+    ITF_NUM_AUDIO_CONTROLE,
+    ITF_NUM_AUDIO_FLUXO,
+    ITF_NUM_TOTAL
+};
+
+_Static_assert(ITF_NUM_HID_MOUSE == USB_HID_MOUSE && ITF_NUM_HID_TECLADO == USB_HID_TECLADO,
+               "instancias HID fora da ordem das interfaces");
+_Static_assert(ITF_NUM_AUDIO_FLUXO == USB_ITF_AUDIO_STREAMING,
+               "interface de streaming de audio fora de usb_descriptors.h");
+
+#define CONFIG_TOTAL_LEN    (TUD_CONFIG_DESC_LEN + 2 * TUD_HID_DESC_LEN + TUD_CDC_DESC_LEN + \
+                             TUD_AUDIO_MIC_ONE_CH_DESC_LEN)
+
+static const uint8_t desc_configuracao[] = {
+    TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN,
+                          TUSB_DESC_CONFIG_ATTR_REMOTE_WAKEUP, 100),
+    // Protocolo "none" nas duas interfaces HID: o relatorio proprio do mouse
+    // e os IDs do teclado nao sao compativeis com o protocolo de boot
+    TUD_HID_DESCRIPTOR(ITF_NUM_HID_MOUSE, 0, HID_ITF_PROTOCOL_NONE, sizeof(desc_relatorio_mouse),
+                       EPNUM_HID_MOUSE, CFG_TUD_HID_EP_BUFSIZE, HID_INTERVALO_MS),
+    TUD_HID_DESCRIPTOR(ITF_NUM_HID_TECLADO, 0, HID_ITF_PROTOCOL_NONE, sizeof(desc_relatorio_teclado),
+                       EPNUM_HID_TECLADO, CFG_TUD_HID_EP_BUFSIZE, HID_INTERVALO_MS),
+    TUD_CDC_DESCRIPTOR(ITF_NUM_CDC, 4, EPNUM_CDC_NOTIF, CDC_NOTIF_TAMANHO,
+                       EPNUM_CDC_OUT, EPNUM_CDC_IN, CDC_EP_TAMANHO),
+    // Microfone: PCM de 16 bits, endpoint isocrono assincrono (microfone_usb.h)
+    TUD_AUDIO_MIC_ONE_CH_DESCRIPTOR(ITF_NUM_AUDIO_CONTROLE, 5, 2, 16,
+                                    EPNUM_AUDIO_IN, CFG_TUD_AUDIO_EP_SZ_IN),
+};
+
+const uint8_t *tud_descriptor_configuration_cb(uint8_t index) {
+    (void)index;
+    return desc_configuracao;
+}
+
+// =====================
+// Strings
+// =====================
+static const char *desc_strings[] = {
+    NULL,                   // 0: idioma (tratado a parte)
+    "BitDogLab",            // 1: fabricante
+    "Hiperperiferico HPR",  // 2: produto
+    NULL,                   // 3: numero de serie (id unico da flash)
+    "HPR controle",         // 4: interface CDC
+    "HPR microfone",        // 5: funcao de audio
+};
+
+static uint16_t desc_string_buf[32];
+
+const uint16_t *tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+    (void)langid;
+    char serial[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+    const char *str;
+    uint8_t n;
+
+    if (index == 0) {
+        desc_string_buf[1] = 0x0409;  // ingles (EUA)
+        n = 1;
+    } else {
+        if (index >= TU_ARRAY_SIZE(desc_strings))
+            return NULL;
+        if (index == 3) {
+            pico_get_unique_board_id_string(serial, sizeof(serial));
+            str = serial;
+        } else {
+            str = desc_strings[index];
+        }
+        for (n = 0; str[n] && n < TU_ARRAY_SIZE(desc_string_buf) - 1; n++)
+            desc_string_buf[1 + n] = str[n];
+    }
+    desc_string_buf[0] = (uint16_t)((TUSB_DESC_STRING << 8) | (2 * n + 2));
+    return desc_string_buf;
+}
@@ -0,0 +1,23 @@
+// usb_descriptors.h - Interfaces do dispositivo USB composto do HPR
+//
+// O TinyUSB numera as instancias HID na ordem das interfaces da
+// configuracao (usb_descriptors.c); cada uma tem endpoint proprio, entao
+// um relatorio pendente numa nao atrasa a outra.
+//   instancia 0  mouse (relatorio sem ID, formato em hid_mouse.h)
+//   instancia 1  teclado (ID 1) + controle de consumo (ID 2), hid_teclado.h
+// Alem delas ha uma interface CDC (porta serial) de controle e telemetria e
+// uma funcao de audio com o microfone (microfone_usb.h), cuja interface de
+// streaming abre e fecha o fluxo pela alternativa escolhida pelo host.
+
+#ifndef USB_DESCRIPTORS_H
+#define USB_DESCRIPTORS_H
+
+#define USB_HID_MOUSE               0
+#define USB_HID_TECLADO             1
+
+#define USB_RELATORIO_TECLADO       1
+#define USB_RELATORIO_CONSUMO       2
+
+#define USB_ITF_AUDIO_STREAMING     5
+
+#endif // USB_DESCRIPTORS_H
@@ -0,0 +1,112 @@
+// vad.c - Deteccao de atividade de voz no fluxo do microfone
+
+#include "vad.h"
+
+// Coeficientes dos passa-baixas de 1a ordem a 16 kHz, em Q15:
+// alfa = 1 - exp(-2*pi*fc/fs)
+#define VAD_ALFA_3400HZ     24146
+#define VAD_ALFA_300HZ      3642
+
+#define VAD_DC_SHIFT        10      // constante de tempo do DC: 1024 amostras (64 ms)
+#define VAD_QUADROS_TREINO  16      // 320 ms aprendendo o piso de ruido
+
+void vad_init(vad_t *v) {
+    v->quadros_ataque = 3;      // 60 ms
+    v->quadros_espera = 15;     // 300 ms
+    v->fator_ruido = 4;         // +6 dB sobre o piso
+    v->energia_min = 100;       // ~10 LSB RMS na banda de voz
+
+    v->dc = 2048 << 4;
+    v->lp_300[0] = 0;
+    v->lp_300[1] = 0;
+    v->lp_3400 = 0;
+    v->hp_anterior = 0;
+    v->soma_banda = 0;
+    v->soma_alta = 0;
+    v->n = 0;
+    v->quadros_treino = VAD_QUADROS_TREINO;
+    v->piso_ruido = 0;
+    v->energia_banda = 0;
+    v->cont_voz = 0;
+    v->cont_silencio = 0;
+    v->ativo = false;
+}
+
+static void vad_fim_quadro(vad_t *v) {
+    uint32_t energia_banda = v->soma_banda / VAD_QUADRO_AMOSTRAS;
+    v->energia_banda = energia_banda;
+
+    if (v->quadros_treino) {
+        // Media dos primeiros quadros como piso inicial
+        uint32_t n = VAD_QUADROS_TREINO - v->quadros_treino;
+        v->piso_ruido = (v->piso_ruido * n + energia_banda) / (n + 1);
+        v->quadros_treino--;
+    } else {
+        // Voz: acima do piso de ruido, acima do minimo absoluto e com mais
+        // energia na banda de voz do que na derivada do sinal. A derivada
+        // (guardada com metade da escala) realca as altas frequencias: para
+        // ruido branco ela tem ~4x a energia da banda, para fala vozeada,
+        // concentrada abaixo de 1 kHz, bem menos que 1x.
+        bool voz = energia_banda > v->fator_ruido * v->piso_ruido &&
+                   energia_banda > v->energia_min &&
+                   v->soma_banda / 4 > v->soma_alta;
+
+        if (voz) {
+            v->cont_silencio = 0;
+            if (v->cont_voz < v->quadros_ataque)
+                v->cont_voz++;
+            if (v->cont_voz >= v->quadros_ataque)
+                v->ativo = true;
+            // Subida muito lenta mesmo durante voz, para nao travar ativo
+            // se o ruido de fundo aumentar de vez
+            v->piso_ruido += (energia_banda - v->piso_ruido) >> 10;
+        } else {
+            v->cont_voz = 0;
+            if (v->cont_silencio < v->quadros_espera)
+                v->cont_silencio++;
+            if (v->cont_silencio >= v->quadros_espera)
+                v->ativo = false;
+
+            // O piso desce rapido e sobe devagar
+            if (energia_banda < v->piso_ruido)
+                v->piso_ruido -= (v->piso_ruido - energia_banda) >> 2;
+            else
+                v->piso_ruido += (energia_banda - v->piso_ruido) >> 6;
+        }
+    }
+    if (v->piso_ruido == 0)
+        v->piso_ruido = 1;
+
+    v->soma_banda = 0;
+    v->soma_alta = 0;
+    v->n = 0;
+}
+
+bool vad_processar(vad_t *v, const uint16_t *amostras, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        int32_t x = (int32_t)amostras[i] << 4;
+
+        // Remocao do DC
+        v->dc += (x - v->dc) >> VAD_DC_SHIFT;
+        int32_t ac = x - v->dc;
+
+        // Passa-altas de 2a ordem em 300 Hz: dois estagios x - passa-baixas(x)
+        v->lp_300[0] += ((ac - v->lp_300[0]) * VAD_ALFA_300HZ) >> 15;
+        int32_t hp = ac - v->lp_300[0];
+        v->lp_300[1] += ((hp - v->lp_300[1]) * VAD_ALFA_300HZ) >> 15;
+        hp -= v->lp_300[1];
+
+        // Banda de voz ate 3400 Hz e derivada (primeira diferenca)
+        v->lp_3400 += ((hp - v->lp_3400) * VAD_ALFA_3400HZ) >> 15;
+        int32_t banda = v->lp_3400 >> 4;
+        int32_t alta = (hp - v->hp_anterior) >> 5;
+        v->hp_anterior = hp;
+
+        // |amostra| <= 2048: 320 quadrados de ate 2^22 cabem em 32 bits
+        v->soma_banda += (uint32_t)(banda * banda);
+        v->soma_alta += (uint32_t)(alta * alta);
+        if (++v->n >= VAD_QUADRO_AMOSTRAS)
+            vad_fim_quadro(v);
+    }
+    return v->ativo;
+}
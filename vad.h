@@ -0,0 +1,62 @@
+// vad.h - Deteccao de atividade de voz no fluxo do microfone
+//
+// Processa o fluxo continuo de amostras do ADC (12 bits, 16 kHz) usando
+// apenas aritmetica inteira, ja que o Cortex-M0+ nao tem FPU:
+//   1. remocao do nivel DC (media movel exponencial);
+//   2. passa-altas de 2a ordem em 300 Hz (corta zumbido da rede), seguido
+//      de um passa-baixas em 3400 Hz (banda de voz) e de uma primeira
+//      diferenca (realce de agudos);
+//   3. energia por quadro de 20 ms da banda de voz e da diferenca;
+//   4. piso de ruido adaptativo, aprendido nos primeiros quadros e depois
+//      atualizado nos quadros sem voz;
+//   5. decisao com histerese: ataque e espera (hangover) em quadros.
+// A diferenca separa voz de chiado: em ruido de banda larga ela domina a
+// energia, na fala vozeada nao.
+// A latencia de ativacao e limitada a (1 + quadros_ataque) quadros.
+
+#ifndef VAD_H
+#define VAD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define VAD_TAXA_HZ         16000
+#define VAD_QUADRO_AMOSTRAS (VAD_TAXA_HZ / 50)     // 20 ms
+
+typedef struct {
+    // Parametros
+    uint8_t quadros_ataque;     // quadros de voz seguidos para ativar
+    uint8_t quadros_espera;     // quadros sem voz seguidos para desativar
+    uint8_t fator_ruido;        // voz: energia na banda > fator * piso de ruido
+    uint32_t energia_min;       // energia media minima na banda para ser voz
+
+    // Estado dos filtros (Q4)
+    int32_t dc;
+    int32_t lp_300[2];          // passa-baixas dos dois estagios do passa-altas
+    int32_t lp_3400;
+    int32_t hp_anterior;
+
+    // Acumuladores do quadro atual
+    uint32_t soma_banda;
+    uint32_t soma_alta;         // energia da primeira diferenca (meia escala)
+    uint16_t n;
+    uint8_t quadros_treino;     // quadros restantes de aprendizado do piso
+
+    // Decisao
+    uint32_t piso_ruido;        // energia media na banda sem voz
+    uint32_t energia_banda;     // energia media na banda do ultimo quadro
+    uint8_t cont_voz;
+    uint8_t cont_silencio;
+    bool ativo;
+} vad_t;
+
+void vad_init(vad_t *v);
+
+// Alimenta amostras cruas do ADC; retorna o estado (debounced) apos elas
+bool vad_processar(vad_t *v, const uint16_t *amostras, uint32_t n);
+
+static inline bool vad_ativo(const vad_t *v) {
+    return v->ativo;
+}
+
+#endif // VAD_H